@@ -7,6 +7,8 @@
  * that correspond to a tactical problem. This is done through
  * instantiating a new planning system node.
  */
+#include "squirrel_planning_execution/LocationGraph.h"
+
 namespace KCL_rosplan {
 
 	
@@ -15,8 +17,8 @@ namespace KCL_rosplan {
 	private:
 		
 		/**
-		 * Data structure of a location, for each location we store the name, whether it is clear and all the 
-		 * locations it is connected to.
+		 * Data structure of a location, for each location we store the name and whether it is clear. The locations
+		 * it is connected to are stored in a @ref{LocationGraph}, by the index of the location.
 		 */
 		struct Location
 		{
@@ -26,14 +28,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			Location(const std::string& name, const std::vector<const Location*>& connected_locations, bool is_clear)
-				: name_(name), connected_locations_(connected_locations), is_clear_(is_clear)
-			{
-				
-			}
-			
-			std::string name_;
-			std::vector<const Location*> connected_locations_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			std::vector<const Location*> near_locations_;
 			bool is_clear_;
 		};
@@ -49,7 +44,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			const Location* location_;
 		};
 
@@ -73,7 +68,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string state_name_;
+			const std::string& state_name_;   // Interned in the arena of createPDDL.
 			std::map<const Object*, unsigned int> classifiable_at_attempt_;
 		};
 
@@ -101,12 +96,12 @@ namespace KCL_rosplan {
 				states_.push_back(&state);
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			std::vector<const State*> states_;
 			std::vector<const KnowledgeBase*> children_;
 		};
 		
-		static void generateProblemFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_base, const Location& robot_location, const std::vector<Location*>& locations, const std::vector<Object*>& objects, unsigned int max_classification_attemps);
+		static void generateProblemFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_base, const Location& robot_location, const std::vector<Location*>& locations, const LocationGraph& connectivity, const std::vector<Object*>& objects, unsigned int max_classification_attemps);
 		static void generateDomainFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_bases, const Location& robot_location, const std::vector<Location*>& locations, const std::vector<Object*>& objects, unsigned int max_classification_attemps);
 
 	public:
@@ -121,8 +116,11 @@ namespace KCL_rosplan {
 		 * @param object_location_predicates A mapping from the predicates of each object to the predicate of the waypoint where it is located.
 		 * @param near_waypoint_mapping Mapping of waypoints to waypoint that are near each other, allowing grasping, dropping, and pushing operations.
 		 * @param max_classification_attemps The maximum number of classification attemps we allow per object before giving up.
+		 * @param connections The roadmap edges (from, to) by the predicates of the waypoints, they may pass waypoints 
+		 * that are not in the problem. Waypoints that are on none of the edges are not connected. If there are none 
+		 * every waypoint is connected to every other waypoint.
 		 */
-		static void createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_location_predicates, const std::map<std::string, std::vector<std::string> >& near_waypoint_mapping, unsigned int max_classification_attemps);
+		static void createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_location_predicates, const std::map<std::string, std::vector<std::string> >& near_waypoint_mapping, unsigned int max_classification_attemps, const std::vector<std::pair<std::string, std::string> >& connections = std::vector<std::pair<std::string, std::string> >());
 	};
 }
 #endif
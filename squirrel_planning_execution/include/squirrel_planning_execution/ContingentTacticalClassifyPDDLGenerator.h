@@ -14,6 +14,8 @@
  * If all possible classification actions have been performed there is a special action that terminates the 
  * failed branch and finishes the plan.
  */
+#include "squirrel_planning_execution/LocationGraph.h"
+
 namespace KCL_rosplan {
 
 	
@@ -22,8 +24,8 @@ namespace KCL_rosplan {
 	private:
 		
 		/**
-		 * Data structure of a location, for each location we store the name, whether it is clear and all the 
-		 * locations it is connected to.
+		 * Data structure of a location, for each location we store the name and whether it is clear. The locations
+		 * it is connected to are stored in a @ref{LocationGraph}, by the index of the location.
 		 */
 		struct Location
 		{
@@ -33,14 +35,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			Location(const std::string& name, const std::vector<const Location*>& connected_locations, bool is_clear)
-				: name_(name), connected_locations_(connected_locations), is_clear_(is_clear)
-			{
-				
-			}
-			
-			std::string name_;
-			std::vector<const Location*> connected_locations_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			bool is_clear_;
 		};
 
@@ -62,7 +57,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			const Location* location_;
 			std::vector<const Location*> observable_locations_;
 		};
@@ -87,7 +82,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string state_name_;
+			const std::string& state_name_;   // Interned in the arena of createPDDL.
 			std::map<const Object*, const Location*> classifiable_from_;
 		};
 
@@ -115,7 +110,7 @@ namespace KCL_rosplan {
 				states_.push_back(&state);
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			std::vector<const State*> states_;
 			std::vector<const KnowledgeBase*> children_;
 		};
@@ -127,9 +122,10 @@ namespace KCL_rosplan {
 		 * @param knowledge_bases All the knowledge bases the planning problem is factorised in.
 		 * @param robot_location The initial location of the robot.
 		 * @param locations All the locations that exist in the domain.
+		 * @param connectivity The connections between the @ref{locations}.
 		 * @param objects All the objects that exist in the domain that must be classified.
 		 */
-		static void generateProblemFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_bases, const Location& robot_location, const std::vector<Location*>& locations, const std::vector<Object*>& objects);
+		static void generateProblemFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_bases, const Location& robot_location, const std::vector<Location*>& locations, const LocationGraph& connectivity, const std::vector<Object*>& objects);
 		
 		/**
 		 * Generate the domain file given the set of objects, locations, etc.
@@ -154,8 +150,11 @@ namespace KCL_rosplan {
 		 * @param location_predicates The predicates of all waypoints in the domain (excluding the location of the robot and object!).
 		 * @param object_predicate The predicate name of the object.
 		 * @param object_location_predicate The predicate of the waypoint where the object is.
+		 * @param connections The roadmap edges (from, to) by the predicates of the waypoints, they may pass waypoints 
+		 * that are not in the problem. Waypoints that are on none of the edges are not connected. If there are none 
+		 * every waypoint is connected to every other waypoint.
 		 */
-		static void createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::vector<std::string>& location_predicates, const std::string& object_predicate, const std::string& object_location_predicate);
+		static void createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::vector<std::string>& location_predicates, const std::string& object_predicate, const std::string& object_location_predicate, const std::vector<std::pair<std::string, std::string> >& connections = std::vector<std::pair<std::string, std::string> >());
 	};
 }
 #endif
@@ -29,7 +29,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 		};
 		
 		/**
@@ -50,7 +50,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			bool is_blocked_;
 			std::vector<const Location*> connected_locations_;
 			std::vector<const Location*> near_locations_;
@@ -68,7 +68,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			const Location* location_;
 			const Object* object_below_;
 			const Object* object_on_top_;
@@ -82,7 +82,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			const Location* location_;
 			std::vector<const Type*> types_that_fit_;
 			std::vector<const Object*> objects_inside_;
@@ -103,7 +103,7 @@ namespace KCL_rosplan {
 				
 			}
 			
-			std::string state_name_;
+			const std::string& state_name_;   // Interned in the arena of createPDDL.
 			//std::map<const Object*, const Location*> object_location_mapping_;
 			std::map<const Object*, const Object*> stackable_mapping_;
 			std::map<const Object*, const Type*> type_mapping_;
@@ -135,7 +135,7 @@ namespace KCL_rosplan {
 				states_.push_back(&state);
 			}
 			
-			std::string name_;
+			const std::string& name_;   // Interned in the arena of createPDDL.
 			std::vector<const State*> states_;
 			std::vector<const KnowledgeBase*> children_;
 		};
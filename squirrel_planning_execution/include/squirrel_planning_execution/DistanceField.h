@@ -0,0 +1,85 @@
+#ifndef KCL_ROSPLAN_DISTANCEFIELD_H
+#define KCL_ROSPLAN_DISTANCEFIELD_H
+
+#include <vector>
+#include <nav_msgs/OccupancyGrid.h>
+#include <geometry_msgs/Point.h>
+
+namespace KCL_rosplan {
+
+	/**
+	 * The Euclidean distance transform of an occupancy grid. For every cell it stores the distance to the 
+	 * nearest occupied cell, so checking the clearance around a point is a single lookup. The transform is 
+	 * computed with the separable linear time algorithm of Felzenszwalb and Huttenlocher: a 1D lower 
+	 * envelope of parabolas is computed over every column and then over every row.
+	 */
+	class DistanceField {
+	public:
+		/**
+		 * Constructor, the distance field is empty until @ref{compute} is called.
+		 */
+		DistanceField();
+		
+		/**
+		 * Compute the distance field of an occupancy grid.
+		 * @param grid The occupancy grid.
+		 * @param occupancy_threshold Cells with a value above this threshold are obstacles. Unknown cells (-1) 
+		 * are never obstacles.
+		 */
+		void compute(const nav_msgs::OccupancyGrid& grid, int occupancy_threshold);
+		
+		/**
+		 * @return True if the distance field has been computed, false otherwise.
+		 */
+		bool isInitialised() const { return !squared_distances_.empty(); }
+		
+		/**
+		 * @return The meta data of the occupancy grid this distance field was computed for.
+		 */
+		const nav_msgs::MapMetaData& getInfo() const { return info_; }
+		
+		/**
+		 * Get the distance between the centre of a cell and the centre of the nearest obstacle.
+		 * @param x The x coordinate of the cell.
+		 * @param y The y coordinate of the cell.
+		 * @return The distance in metres, or -1 if the cell is outside the grid. If the grid contains no 
+		 * obstacles std::numeric_limits<float>::max() is returned.
+		 */
+		float getDistance(int x, int y) const;
+		
+		/**
+		 * Get the distance between the cell that contains @ref{point} and the nearest obstacle.
+		 * @param point A point in the frame of the occupancy grid.
+		 * @return The distance in metres, or -1 if the point is outside the grid.
+		 */
+		float getDistance(const geometry_msgs::Point& point) const;
+		
+		/**
+		 * Check if there is an obstacle within @ref{min_distance} of @ref{point}.
+		 * @param point A point in the frame of the occupancy grid.
+		 * @param min_distance The radius of the circle that must be free.
+		 * @return True if there is an obstacle within @ref{min_distance} or the point is outside the grid, 
+		 * false otherwise.
+		 */
+		bool isBlocked(const geometry_msgs::Point& point, float min_distance) const;
+		
+	private:
+		
+		/**
+		 * Compute the 1D squared distance transform of a sampled function.
+		 * @param f The sampled function, @ref{n} values that are @ref{stride} apart.
+		 * @param n The number of samples.
+		 * @param stride The distance between two samples in @ref{f}.
+		 * @param d The squared distance of each sample, @ref{n} values that are @ref{stride} apart.
+		 * @param v Scratch space for the locations of the parabolas, at least @ref{n} elements.
+		 * @param z Scratch space for the boundaries between parabolas, at least @ref{n} + 1 elements.
+		 * @param buffer Scratch space for a copy of @ref{f}, at least @ref{n} elements.
+		 */
+		static void transform(float* f, int n, int stride, std::vector<int>& v, std::vector<float>& z, std::vector<float>& buffer);
+		
+		nav_msgs::MapMetaData info_;
+		std::vector<float> squared_distances_;   // Squared distance to the nearest obstacle, in cells.
+	};
+};
+
+#endif
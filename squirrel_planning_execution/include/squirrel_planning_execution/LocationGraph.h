@@ -0,0 +1,90 @@
+#ifndef KCL_ROSPLAN_LOCATIONGRAPH_H
+#define KCL_ROSPLAN_LOCATIONGRAPH_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace KCL_rosplan {
+
+	/**
+	 * The connectivity between the locations of a PDDL generator model, the locations are identified by their
+	 * index. The graph is either complete, then nothing is stored per location, or it holds the edges of a
+	 * roadmap in compressed sparse row form: the targets of all edges sorted by their source, and for every
+	 * location the offset of its first edge.
+	 *
+	 * Both are walked the same way, e.g.:
+	 *   for (unsigned int i = graph.begin(from); i != graph.end(from); ++i)
+	 *     if (graph.getTarget(from, i) != from) ...
+	 * A complete graph includes the edge from a location to itself, sparse graphs never do.
+	 */
+	class LocationGraph {
+	public:
+		/**
+		 * Constructor, a complete graph with no locations.
+		 */
+		LocationGraph();
+
+		/**
+		 * Connect every location to every other location.
+		 * @param nr_locations The number of locations.
+		 */
+		void setComplete(unsigned int nr_locations);
+
+		/**
+		 * Connect the locations with a set of edges, duplicate edges and edges from a location to itself are
+		 * ignored.
+		 * @param nr_locations The number of locations.
+		 * @param edges The directed edges (from, to).
+		 */
+		void setEdges(unsigned int nr_locations, const std::vector<std::pair<unsigned int, unsigned int> >& edges);
+
+		/**
+		 * Connect locations by their names along a roadmap, a location that shares its name with others gets the 
+		 * edges of all of them. Two locations are connected if the roadmap has a path between them that passes 
+		 * no other location, the waypoints of the roadmap that are not locations are left out of the graph. A 
+		 * location that is on none of the edges is not connected.
+		 * @param names The name of every location.
+		 * @param connections The directed edges (from, to) of the roadmap by name, if there are none the graph is complete.
+		 */
+		void setEdges(const std::vector<std::string>& names, const std::vector<std::pair<std::string, std::string> >& connections);
+
+		/**
+		 * @return True if every location is connected to every other location.
+		 */
+		bool isComplete() const { return complete_; }
+
+		/**
+		 * @return The number of locations.
+		 */
+		unsigned int getNrLocations() const { return nr_locations_; }
+
+		/**
+		 * @return The position of the first edge of @ref{from}.
+		 */
+		unsigned int begin(unsigned int from) const { return complete_ ? 0 : offsets_[from]; }
+
+		/**
+		 * @return The position after the last edge of @ref{from}.
+		 */
+		unsigned int end(unsigned int from) const { return complete_ ? nr_locations_ : offsets_[from + 1]; }
+
+		/**
+		 * @return The location that the edge at @ref{position} of @ref{from} leads to.
+		 */
+		unsigned int getTarget(unsigned int /* from */, unsigned int position) const { return complete_ ? position : targets_[position]; }
+
+		/**
+		 * @return True if there is an edge from @ref{from} to @ref{to}.
+		 */
+		bool isConnected(unsigned int from, unsigned int to) const;
+
+	private:
+		bool complete_;
+		unsigned int nr_locations_;
+		std::vector<unsigned int> offsets_;   // nr_locations_ + 1 entries, empty if the graph is complete.
+		std::vector<unsigned int> targets_;   // The targets of the edges, sorted per source.
+	};
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef KCL_ROSPLAN_MODELARENA_H
+#define KCL_ROSPLAN_MODELARENA_H
+
+#include <new>
+#include <utility>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace KCL_rosplan {
+
+	/**
+	 * A monotonic arena for the model that a PDDL generator builds during a single call. Objects are placed in
+	 * large blocks of memory one after the other and are never freed individually; when the arena is destroyed
+	 * every object is destructed, in the reverse order of creation, and all blocks are released at once.
+	 *
+	 * The arena also interns names: every distinct name is stored once and the objects of the model refer to
+	 * that copy, so a name must be interned before it is handed to an object that keeps a reference to it.
+	 */
+	class ModelArena {
+	public:
+		/**
+		 * Constructor, no memory is allocated until the first object is created.
+		 * @param block_size The size in bytes of the blocks, larger objects get a block of their own.
+		 */
+		ModelArena(std::size_t block_size = 1 << 14);
+
+		/**
+		 * Destructs all objects and releases all memory.
+		 */
+		~ModelArena();
+
+		/**
+		 * Destructs all objects, forgets all names and releases all memory, the arena can be used again afterwards.
+		 */
+		void release();
+
+		/**
+		 * @return The copy of @ref{name} that is stored in the arena, it stays valid until @ref{release}.
+		 */
+		const std::string& intern(const std::string& name);
+
+		/**
+		 * Create an object in the arena, it is destructed when the arena is released.
+		 * @return The new object.
+		 */
+		template<class T>
+		T* create() { return track(new (allocate(sizeof(T))) T()); }
+
+		template<class T, class A1>
+		T* create(const A1& a1) { return track(new (allocate(sizeof(T))) T(a1)); }
+
+		template<class T, class A1, class A2>
+		T* create(const A1& a1, const A2& a2) { return track(new (allocate(sizeof(T))) T(a1, a2)); }
+
+		template<class T, class A1, class A2, class A3>
+		T* create(const A1& a1, const A2& a2, const A3& a3) { return track(new (allocate(sizeof(T))) T(a1, a2, a3)); }
+
+		template<class T, class A1, class A2, class A3, class A4>
+		T* create(const A1& a1, const A2& a2, const A3& a3, const A4& a4) { return track(new (allocate(sizeof(T))) T(a1, a2, a3, a4)); }
+
+		template<class T, class A1, class A2, class A3, class A4, class A5>
+		T* create(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5) { return track(new (allocate(sizeof(T))) T(a1, a2, a3, a4, a5)); }
+
+		/**
+		 * @return The number of objects in the arena.
+		 */
+		std::size_t getNrObjects() const { return finalisers_.size(); }
+
+		/**
+		 * @return The number of bytes of the blocks that are allocated.
+		 */
+		std::size_t getMemoryUsage() const { return memory_usage_; }
+
+	private:
+
+		// Not copyable, the objects are owned by exactly one arena.
+		ModelArena(const ModelArena&);
+		ModelArena& operator=(const ModelArena&);
+
+		/**
+		 * Reserve memory in the current block, or in a new block if it does not fit.
+		 * @param size The number of bytes.
+		 * @return The memory, aligned for any of the types of the model.
+		 */
+		void* allocate(std::size_t size);
+
+		template<class T>
+		static void destroy(void* object) { static_cast<T*>(object)->~T(); }
+
+		template<class T>
+		T* track(T* object) { finalisers_.push_back(std::make_pair(&destroy<T>, static_cast<void*>(object))); return object; }
+
+		std::size_t block_size_;
+		std::vector<char*> blocks_;
+		char* next_;                // The first free byte of the current block.
+		std::size_t remaining_;     // The number of free bytes in the current block.
+		std::size_t memory_usage_;
+		std::vector<std::pair<void (*)(void*), void*> > finalisers_;
+		std::set<std::string> names_;
+	};
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef KCL_ROSPLAN_PDDLWRITER_H
+#define KCL_ROSPLAN_PDDLWRITER_H
+
+#include <ostream>
+#include <string>
+
+namespace KCL_rosplan {
+
+	/**
+	 * Builds a PDDL domain or problem file in memory and writes it to disk in one go. The PDDL generators
+	 * stream their output into this writer the same way they would into a std::ofstream, but nothing is
+	 * written or flushed until @ref{writeToFile} is called. A std::endl only appends a newline.
+	 */
+	class PDDLWriter {
+	public:
+		/**
+		 * Constructor.
+		 * @param capacity The number of bytes reserved up front, the buffer grows as needed.
+		 */
+		PDDLWriter(std::size_t capacity = 1 << 16);
+
+		PDDLWriter& operator<<(const std::string& text) { buffer_.append(text); return *this; }
+		PDDLWriter& operator<<(const char* text) { buffer_.append(text); return *this; }
+		PDDLWriter& operator<<(char c) { buffer_.push_back(c); return *this; }
+		PDDLWriter& operator<<(int value);
+		PDDLWriter& operator<<(unsigned int value);
+		PDDLWriter& operator<<(long value);
+		PDDLWriter& operator<<(unsigned long value);
+		PDDLWriter& operator<<(double value);
+
+		/**
+		 * Stream manipulators, std::endl appends a newline and the others are ignored.
+		 */
+		PDDLWriter& operator<<(std::ostream& (*manipulator)(std::ostream&));
+
+		/**
+		 * Write a fact on its own line, e.g. "\t\t(robot_at kenny wp0)".
+		 * @param depth The number of tabs in front of the fact.
+		 * @param predicate The name of the predicate.
+		 * @param a The first argument, followed by the second and third argument in the overloads below.
+		 */
+		PDDLWriter& fact(unsigned int depth, const std::string& predicate, const std::string& a);
+		PDDLWriter& fact(unsigned int depth, const std::string& predicate, const std::string& a, const std::string& b);
+		PDDLWriter& fact(unsigned int depth, const std::string& predicate, const std::string& a, const std::string& b, const std::string& c);
+
+		/**
+		 * Start an action, "(:action @ref{name}" on its own line.
+		 */
+		PDDLWriter& beginAction(const std::string& name);
+
+		/**
+		 * Write the parameters of an action, "\t:parameters (@ref{parameters})" on its own line.
+		 */
+		PDDLWriter& parameters(const std::string& parameters);
+
+		/**
+		 * @return Everything that has been written so far.
+		 */
+		const std::string& str() const { return buffer_; }
+
+		/**
+		 * Write everything to a file, replacing its contents.
+		 * @param file_name The path and file name.
+		 * @return True if the file was written, false otherwise.
+		 */
+		bool writeToFile(const std::string& file_name) const;
+
+	private:
+
+		/**
+		 * Append @ref{depth} tabs.
+		 */
+		void indent(unsigned int depth) { buffer_.append(depth, '\t'); }
+
+		std::string buffer_;
+	};
+};
+
+#endif
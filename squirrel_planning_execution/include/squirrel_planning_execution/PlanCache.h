@@ -0,0 +1,130 @@
+#ifndef KCL_ROSPLAN_PLANCACHE_H
+#define KCL_ROSPLAN_PLANCACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace KCL_rosplan {
+
+	/**
+	 * An on-disk cache of the PDDL domain and problem files that the generators create and of the plan that the
+	 * planner found for them. An entry is addressed by the hash of the inputs of the generator, so a sub-problem
+	 * that has been solved before is served from the cache instead of being generated and planned again.
+	 *
+	 * Every entry is a directory @ref{cache_path}/<hash>/ that holds the inputs, domain.pddl, problem.pddl and
+	 * plan.pddl. An entry is only complete once its plan has been committed, incomplete entries are never
+	 * served. The number of complete entries is bounded, the least recently used entry is evicted first; the
+	 * modification time of the directories keeps that order across restarts.
+	 */
+	class PlanCache {
+	public:
+		/**
+		 * The canonical form of the inputs of a generator. Every value is written with its length and every
+		 * container with its size, so different inputs never have the same canonical form. The maps are ordered
+		 * by their keys, so the order in which they were filled does not matter.
+		 */
+		class Inputs {
+		public:
+			/**
+			 * @param generator The name of the generator, problems of different generators never share an entry.
+			 */
+			Inputs(const std::string& generator);
+
+			Inputs& add(const std::string& value);
+			Inputs& add(unsigned int value);
+			Inputs& add(const std::vector<std::string>& values);
+			Inputs& add(const std::map<std::string, std::string>& mapping);
+			Inputs& add(const std::map<std::string, std::vector<std::string> >& mapping);
+			Inputs& add(const std::vector<std::pair<std::string, std::string> >& pairs);
+
+			/**
+			 * @return The canonical form of the inputs.
+			 */
+			const std::string& str() const { return canonical_; }
+
+			/**
+			 * @return The 64 bit FNV-1a hash of the canonical form, as 16 hexadecimal digits.
+			 */
+			std::string getHash() const;
+
+		private:
+			std::string canonical_;
+		};
+
+		/**
+		 * Constructor, the cache is disabled until it is configured.
+		 */
+		PlanCache();
+
+		/**
+		 * Use the entries in @ref{cache_path}, it is created if it does not exist. Incomplete entries are removed
+		 * and the least recently used entries are evicted until at most @ref{max_entries} are left.
+		 * @param cache_path The directory of the cache.
+		 * @param max_entries The maximum number of entries, 0 disables the cache.
+		 * @return True if the cache is enabled.
+		 */
+		bool configure(const std::string& cache_path, unsigned int max_entries);
+
+		/**
+		 * @return True if the cache is configured and can hold at least one entry.
+		 */
+		bool isEnabled() const { return max_entries_ > 0; }
+
+		/**
+		 * Look up a complete entry for @ref{inputs}, if there is one its domain and problem files are copied to
+		 * @ref{domain_path} and @ref{problem_path} and it becomes the most recently used entry.
+		 * @return True on a hit.
+		 */
+		bool restore(const Inputs& inputs, const std::string& domain_path, const std::string& problem_path);
+
+		/**
+		 * Start a new entry for @ref{inputs} with the domain and problem files that have just been generated, any
+		 * earlier entry for these inputs is replaced. The entry is complete once its plan is committed.
+		 * @return True if the files were copied into the cache.
+		 */
+		bool store(const Inputs& inputs, const std::string& domain_path, const std::string& problem_path);
+
+		/**
+		 * Complete the entry of @ref{hash} with the output of the planner that was written to
+		 * @ref{getPendingPlanPath}.
+		 * @return True if the plan was added, false if the planner did not write any output.
+		 */
+		bool commitPlan(const std::string& hash);
+
+		/**
+		 * @return The plan of a complete entry.
+		 */
+		std::string getPlanPath(const std::string& hash) const;
+
+		/**
+		 * @return The file the planner writes its output to before the plan is committed.
+		 */
+		std::string getPendingPlanPath(const std::string& hash) const;
+
+		unsigned int getHits() const { return hits_; }
+		unsigned int getMisses() const { return misses_; }
+		unsigned int getNrEntries() const { return lru_.size(); }
+
+	private:
+		/**
+		 * Remove the least recently used entries until there are at most @ref{max_entries_}.
+		 */
+		void evict();
+
+		std::string getEntryPath(const std::string& hash) const;
+
+		std::string cache_path_;
+		unsigned int max_entries_;
+		unsigned int hits_;
+		unsigned int misses_;
+
+		// The hashes of the complete entries, the most recently used first.
+		std::list<std::string> lru_;
+		std::map<std::string, std::list<std::string>::iterator> entries_;
+	};
+};
+
+#endif
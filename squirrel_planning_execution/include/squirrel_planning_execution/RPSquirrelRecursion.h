@@ -5,6 +5,7 @@
 #include <boost/foreach.hpp>
 #include "mongodb_store/message_store.h"
 #include "geometry_msgs/PoseStamped.h"
+#include <tf/transform_datatypes.h>
 #include "std_srvs/Empty.h"
 #include "diagnostic_msgs/KeyValue.h"
 #include <actionlib/client/simple_action_client.h>
@@ -26,6 +27,7 @@
 
 #include "squirrel_waypoint_msgs/ExamineWaypoint.h"
 #include "squirrel_object_perception_msgs/SceneObject.h"
+#include "squirrel_planning_execution/PlanCache.h"
 
 #ifndef KCL_recursion
 #define KCL_recursion
@@ -39,6 +41,7 @@
 namespace KCL_rosplan {
 
 	class ViewConeGenerator;
+	class TourPlanner;
 	
 	class RPSquirrelRecursion
 	{
@@ -69,6 +72,22 @@ namespace KCL_rosplan {
 		// View point generator.
 		ViewConeGenerator* view_cone_generator;
 		
+		// Orders the view poses by the distance the robot has to drive between them.
+		TourPlanner* tour_planner;
+		
+		// The travel costs between the robot and the view poses, and the order they are visited in.
+		ros::Publisher exploration_travel_costs_pub;
+		ros::Publisher exploration_tour_pub;
+		
+		// The domains, problems and plans of the sub-problems that have been solved before, and its hits and misses.
+		PlanCache plan_cache;
+		ros::Publisher plan_cache_statistics_pub;
+		
+		// The cache entry of the problem made by the last call to createDomain (empty if it is not cached), and 
+		// whether its plan was found in the cache.
+		std::string plan_cache_hash;
+		bool plan_cache_hit;
+		
 		// Generate the initial state for the highest level of abstraction.
 		void generateInitialState();
 		
@@ -79,15 +98,75 @@ namespace KCL_rosplan {
 		 */
 		bool createDomain(const std::string& action_name);
 		
+		/**
+		 * Look up the domain and problem of @ref{inputs} in the plan cache and, on a hit, copy them to 
+		 * @ref{domain_path} and @ref{problem_path}. On a miss the caller generates them and calls @ref{storeInPlanCache}.
+		 * @return True if the domain, problem and plan were found in the cache.
+		 */
+		bool restoreFromPlanCache(const PlanCache::Inputs& inputs, const std::string& domain_path, const std::string& problem_path);
+		
+		/**
+		 * Add the domain and problem that have just been generated for @ref{inputs} to the plan cache, the plan 
+		 * is added once the planner has found it.
+		 */
+		void storeInPlanCache(const PlanCache::Inputs& inputs, const std::string& domain_path, const std::string& problem_path);
+		
+		/**
+		 * Publish the hits, misses and number of entries of the plan cache on /kcl_rosplan/plan_cache_statistics.
+		 */
+		void publishPlanCacheStatistics();
+		
+		/**
+		 * Fetch the roadmap edges between the waypoints from the 'connected' facts in the knowledge base, and connect 
+		 * each of @ref{locations} that is not on the roadmap to it, in both directions: to the waypoint given by 
+		 * @ref{attached_locations}, otherwise to the roadmap waypoint nearest to it.
+		 * @param locations The waypoints of a problem that the robot drives to.
+		 * @param positions The positions of the @ref{locations} that are not in the scene database.
+		 * @param attached_locations Waypoints that are connected to another waypoint only, e.g. the waypoint they are near.
+		 * @param connections The edges (from, to), sorted. Empty if there is no roadmap or a location could not be 
+		 * placed on it, then every location is connected to every other location.
+		 * @return True if the facts were received.
+		 */
+		bool getRoadmapConnections(const std::vector<std::string>& locations, const std::map<std::string, geometry_msgs::Point>& positions, const std::map<std::string, std::string>& attached_locations, std::vector<std::pair<std::string, std::string> >& connections);
+		
 		/**
 		 * In the case that we are running a simulation we setup the knowledge base.
 		 */
 		void setupSimulation();
 		
+		/**
+		 * Find a pose @ref{distance} metres from @ref{target} that faces the target and is at least 
+		 * @ref{approach_clearance} away from any obstacle in the occupancy grid. If no such pose is found 
+		 * the pose with the largest clearance is returned.
+		 * @param target The position to approach.
+		 * @param distance The distance between the pose and the target.
+		 * @return The approach pose.
+		 */
+		geometry_msgs::Pose findApproachPose(const geometry_msgs::Point& target, float distance) const;
+		
+		/**
+		 * Order the view poses of an exploration so the robot drives the shortest distance through the occupancy 
+		 * grid, starting from its current position. The travel costs and the order are published on 
+		 * /kcl_rosplan/exploration_travel_costs and /kcl_rosplan/exploration_tour, where index 0 is the robot 
+		 * and index i + 1 is view pose i.
+		 * @param view_poses The view poses, in the order they were generated.
+		 * @param tour The indices of the view poses in the order they are visited.
+		 */
+		void orderViewPoses(const std::vector<geometry_msgs::Pose>& view_poses, std::vector<unsigned int>& tour);
+		
 		bool initial_problem_generated;
 		
 		// Determine whether this is a simulation or not.
 		bool simulated;
+		
+		// The minimal distance between the poses used for grasping and pushing and any obstacle.
+		double approach_clearance;
+		
+		// The maximum wall-clock time (in seconds) spent on creating view cones, 0 means no limit.
+		double view_cone_time_budget;
+		
+		// The rooms that are explored, polygons in the frame of the occupancy grid. Empty if none were configured.
+		std::vector<std::vector<tf::Vector3> > view_cone_regions;
 
 	public:
 
@@ -13,7 +13,12 @@
 #include "squirrel_planning_knowledge_msgs/TaskPoseService.h"
 #include "rosplan_knowledge_msgs/CreatePRM.h"
 #include "rosplan_knowledge_msgs/AddWaypoint.h"
+#include "squirrel_planning_execution/DistanceField.h"
+#include "squirrel_planning_execution/WaypointIndex.h"
+#include "squirrel_planning_execution/FindNearestWaypoints.h"
 #include <tf/transform_datatypes.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <sstream>
 #include <string>
 #include <ctime>
@@ -51,6 +56,10 @@ namespace KCL_rosplan {
 		std::string static_map_service;
 		bool use_static_map;
 		double occupancy_threshold;
+		double waypoint_clearance;
+		double footprint_radius;
+		double robot_clearance;
+		double resample_radius;
 
 		// Scene database
 		mongodb_store::MessageStoreProxy message_store;
@@ -60,21 +69,84 @@ namespace KCL_rosplan {
 		ros::ServiceClient get_instance_client;
 
 		// map
-		nav_msgs::OccupancyGrid cost_map;
+		nav_msgs::OccupancyGridConstPtr cost_map;
+		boost::mutex cost_map_mutex;
 		ros::ServiceClient map_client;
+		DistanceField distance_field;
 
 		// Roadmap
 		std::map<std::string, Waypoint*> waypoints;
 		std::map<std::string, std::string> db_name_map;
-		
+		WaypointIndex waypoint_index;
+		double connection_radius;
+		int max_neighbours;
+		int nr_threads;
+
+		/**
+		 * Sample waypoints from the free space of the distance field until @ref{req.nr_waypoints} are added or
+		 * @ref{req.total_attempts} samples are drawn. A sample is cast at most @ref{req.casting_distance} from a
+		 * random waypoint that is already in the roadmap, it must keep @ref{robot_clearance} from obstacles and
+		 * @ref{req.min_distance} from the other waypoints.
+		 * @param req The request that holds the parameters of the roadmap.
+		 * @return The number of waypoints that are added.
+		 */
+		unsigned int sampleWaypoints(const rosplan_knowledge_msgs::CreatePRM::Request &req);
+
+		/**
+		 * Find a pose near a waypoint that keeps @ref{robot_clearance} from obstacles. The rings around the waypoint
+		 * are searched outwards, one cell apart, up to @ref{resample_radius}. On the first ring that has free poses
+		 * the one whose distance to @ref{target} is closest to that of the waypoint is chosen, so the robot can
+		 * still reach the object.
+		 * @param waypoint The waypoint that is blocked.
+		 * @param target The position the waypoint was generated for.
+		 * @param free The pose that is found.
+		 * @return True if a free pose is found, false otherwise.
+		 */
+		bool resampleWaypoint(const geometry_msgs::Point& waypoint, const geometry_msgs::Point& target, geometry_msgs::Point& free) const;
+
+		/**
+		 * Check if the robot can drive in a straight line between two cells, keeping @ref{robot_clearance}
+		 * from the obstacles in the distance field. The line is traced through the cells of the grid.
+		 */
+		bool isConnected(int from_x, int from_y, int to_x, int to_y) const;
+
+		/**
+		 * Check the candidate edges assigned to a single thread, that is every @ref{nr_threads}th edge
+		 * starting from @ref{thread_id}.
+		 * @param edges The candidate edges.
+		 * @param connected For every candidate edge whether it is free, only the entries of this thread are written.
+		 * @param thread_id The index of this thread.
+		 * @param nr_threads The total number of threads.
+		 */
+		void checkEdges(const std::vector<std::pair<Waypoint*, Waypoint*> >& edges, std::vector<char>& connected, unsigned int thread_id, unsigned int nr_threads) const;
+
+		/**
+		 * Fill in the neighbours of every waypoint: the nearest @ref{max_neighbours} waypoints within
+		 * @ref{connecting_distance} that it is connected to. The edges are undirected.
+		 * @param connecting_distance The maximum length of an edge, if 0 @ref{connection_radius} is used.
+		 * @return The number of edges.
+		 */
+		unsigned int connectWaypoints(double connecting_distance);
+
 		// visualisation
 		std::string fixed_frame;
 		ros::Publisher waypoints_pub;
 		void publishWaypointMarkerArray(ros::NodeHandle nh);
 		void clearMarkerArrays(ros::NodeHandle nh);
 
-		// waypoint request services
-		ros::ServiceClient manipulation_client;
+		// waypoint request services, one persistent connection for each request that can be in flight
+		std::string manipulation_service_topic;
+		std::vector<ros::ServiceClient> manipulation_clients;
+
+		/**
+		 * Request the manipulation waypoints of objects until none are left, run by each of the concurrent workers.
+		 * @param worker The index of the worker, it uses the manipulation client with the same index.
+		 * @param objects The names of the objects and their poses.
+		 * @param next_object The index of the next object to request, shared by the workers.
+		 * @param next_object_mutex Guards @ref{next_object}.
+		 * @param accepted_points For every object the waypoints that are clear of obstacles, with their index in the response.
+		 */
+		void requestManipulationWaypoints(unsigned int worker, const std::vector<std::pair<std::string, geometry_msgs::PoseStamped> >& objects, unsigned int& next_object, boost::mutex& next_object_mutex, std::vector<std::vector<std::pair<int, geometry_msgs::Point> > >& accepted_points);
 
 	public:
 
@@ -84,6 +156,9 @@ namespace KCL_rosplan {
 		/* service to (re)generate waypoints */
 		bool generateRoadmap(rosplan_knowledge_msgs::CreatePRM::Request &req, rosplan_knowledge_msgs::CreatePRM::Response &res);
 		void costMapCallback( const nav_msgs::OccupancyGridConstPtr& msg );
+
+		/* service to find the waypoints nearest to a point */
+		bool findNearestWaypoints(squirrel_planning_execution::FindNearestWaypoints::Request &req, squirrel_planning_execution::FindNearestWaypoints::Response &res);
 	};
 }
 #endif
@@ -0,0 +1,66 @@
+#ifndef KCL_ROSPLAN_REGIONMASK_H
+#define KCL_ROSPLAN_REGIONMASK_H
+
+#include <vector>
+#include <nav_msgs/OccupancyGrid.h>
+#include <tf/transform_datatypes.h>
+
+namespace KCL_rosplan {
+
+	/**
+	 * The cells of an occupancy grid whose centre lies inside one of a set of polygons, for example the rooms of
+	 * a segmented map. The polygons are rasterised once, after which checking a cell is a single lookup. Only
+	 * the bounding rectangle of the polygons is stored.
+	 */
+	class RegionMask {
+	public:
+		/**
+		 * Constructor, the mask is empty until @ref{compute} is called. An empty mask contains every cell.
+		 */
+		RegionMask();
+
+		/**
+		 * Rasterise a set of polygons. Each polygon is a list of corners in the frame of the occupancy grid, the
+		 * last corner connects to the first one. Polygons do not need to be convex, a cell is inside a polygon
+		 * if a ray from its centre crosses the edges an odd number of times.
+		 * @param info The meta data of the occupancy grid.
+		 * @param polygons The polygons, if there are none the mask contains every cell.
+		 */
+		void compute(const nav_msgs::MapMetaData& info, const std::vector<std::vector<tf::Vector3> >& polygons);
+
+		/**
+		 * @return True if the mask restricts the cells, false if it contains every cell.
+		 */
+		bool isRestricted() const { return restricted_; }
+
+		/**
+		 * @return True if cell (x, y) lies inside one of the polygons, or if the mask is not restricted.
+		 */
+		bool contains(int x, int y) const
+		{
+			if (!restricted_) {
+				return true;
+			}
+			if (x < min_x_ || x > max_x_ || y < min_y_ || y > max_y_) {
+				return false;
+			}
+			return cells_[(x - min_x_) + (y - min_y_) * (max_x_ - min_x_ + 1)];
+		}
+
+		/**
+		 * Get the bounding rectangle of the cells inside the polygons. If no cell is inside, the rectangle is
+		 * empty (min > max).
+		 */
+		int getMinX() const { return min_x_; }
+		int getMinY() const { return min_y_; }
+		int getMaxX() const { return max_x_; }
+		int getMaxY() const { return max_y_; }
+
+	private:
+		bool restricted_;
+		int min_x_, min_y_, max_x_, max_y_;
+		std::vector<bool> cells_;   // The cells of the bounding rectangle, row by row.
+	};
+};
+
+#endif
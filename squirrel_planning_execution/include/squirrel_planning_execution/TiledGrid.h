@@ -0,0 +1,162 @@
+#ifndef KCL_ROSPLAN_TILEDGRID_H
+#define KCL_ROSPLAN_TILEDGRID_H
+
+#include <vector>
+#include <stdint.h>
+#include <nav_msgs/OccupancyGrid.h>
+
+namespace KCL_rosplan {
+
+	/**
+	 * A summary of an occupancy grid in square tiles of TILE_SIZE x TILE_SIZE cells. Every tile is either
+	 * uniformly free, occupied or unknown, or mixed. Only mixed tiles store which of their cells are free, so
+	 * the memory scales with the area where free space meets obstacles and unknown space.
+	 */
+	class TiledGrid {
+	public:
+		static const int TILE_SHIFT = 6;
+		static const int TILE_SIZE = 1 << TILE_SHIFT;
+
+		enum TileState
+		{
+			FREE,
+			OCCUPIED,
+			UNKNOWN,
+			MIXED
+		};
+
+		/**
+		 * Constructor, the tiled grid is empty until @ref{compute} is called.
+		 */
+		TiledGrid();
+
+		/**
+		 * Summarise an occupancy grid.
+		 * @param grid The occupancy grid.
+		 * @param occupancy_threshold Cells with a value above this threshold are occupied, cells with the
+		 * value -1 are unknown and all other cells are free.
+		 */
+		void compute(const nav_msgs::OccupancyGrid& grid, int occupancy_threshold);
+
+		/**
+		 * @return True if the tiled grid has been computed, false otherwise.
+		 */
+		bool isInitialised() const { return !states_.empty(); }
+
+		/**
+		 * @return The occupancy threshold the tiled grid was computed with.
+		 */
+		int getOccupancyThreshold() const { return occupancy_threshold_; }
+
+		int getWidth() const { return width_; }
+		int getHeight() const { return height_; }
+		int getWidthInTiles() const { return width_in_tiles_; }
+		int getHeightInTiles() const { return height_in_tiles_; }
+
+		/**
+		 * @return The state of the tile at (tile_x, tile_y).
+		 */
+		TileState getTileState(int tile_x, int tile_y) const { return (TileState)states_[tile_x + tile_y * width_in_tiles_]; }
+
+		/**
+		 * @return The number of free cells in the tile at (tile_x, tile_y).
+		 */
+		unsigned int getNrFreeCells(int tile_x, int tile_y) const { return nr_free_cells_[tile_x + tile_y * width_in_tiles_]; }
+
+		/**
+		 * @return The number of free cells in the occupancy grid.
+		 */
+		unsigned int getNrFreeCells() const { return total_nr_free_cells_; }
+
+		/**
+		 * @return The number of mixed tiles.
+		 */
+		unsigned int getNrMixedTiles() const { return blocked_masks_.size() / TILE_SIZE; }
+
+		/**
+		 * Get the cells of a mixed tile that are not free.
+		 * @return TILE_SIZE rows of the tile, bit x of row y is set if cell (x, y) of the tile is not free or
+		 * lies outside the grid. NULL if the tile is not mixed.
+		 */
+		const uint64_t* getBlockedMask(int tile_x, int tile_y) const;
+
+		/**
+		 * Check if all the cells in a rectangle are free. Cells outside the grid are ignored.
+		 * @return True if every tile that overlaps with the rectangle is free, false otherwise.
+		 */
+		bool isAreaFree(int min_x, int min_y, int max_x, int max_y) const;
+
+	private:
+		int occupancy_threshold_;
+		int width_, height_;
+		int width_in_tiles_, height_in_tiles_;
+		std::vector<unsigned char> states_;          // The TileState of every tile.
+		std::vector<unsigned int> nr_free_cells_;    // The number of free cells of every tile.
+		std::vector<int> mask_indices_;              // The index of the blocked mask of every tile, -1 if it is not mixed.
+		std::vector<uint64_t> blocked_masks_;        // TILE_SIZE rows for every mixed tile.
+		unsigned int total_nr_free_cells_;
+	};
+
+	/**
+	 * Which cells of an occupancy grid have been processed, in the tiles of a @ref{TiledGrid}. Cells that are
+	 * not free start out as processed. Tiles where all cells or no cells are processed do not store any cells,
+	 * a tile only gets a bitmap when it is mixed or one of its free cells is marked.
+	 */
+	class TiledCoverage {
+	public:
+		/**
+		 * Constructor, only cells that are free in @ref{tiled_grid} are unprocessed.
+		 * @param tiled_grid The summary of the occupancy grid, it is not kept.
+		 */
+		TiledCoverage(const TiledGrid& tiled_grid);
+
+		/**
+		 * @return True if cell (x, y) has been processed, false otherwise. The cell must lie in the grid.
+		 */
+		bool isProcessed(int x, int y) const
+		{
+			int tile = (x >> TiledGrid::TILE_SHIFT) + (y >> TiledGrid::TILE_SHIFT) * width_in_tiles_;
+			int index = bitmap_indices_[tile];
+			if (index < 0) {
+				return nr_unprocessed_cells_[tile] == 0;
+			}
+			return (bitmaps_[index + (y & (TiledGrid::TILE_SIZE - 1))] >> (x & (TiledGrid::TILE_SIZE - 1))) & 1;
+		}
+
+		/**
+		 * Mark cell (x, y) as processed. The cell must lie in the grid.
+		 * @return True if the cell was not processed before, false otherwise.
+		 */
+		bool setProcessed(int x, int y);
+
+		/**
+		 * Mark all the cells of the tile at (tile_x, tile_y) as processed.
+		 */
+		void setTileProcessed(int tile_x, int tile_y);
+
+		/**
+		 * @return The number of cells that have not been processed.
+		 */
+		unsigned int getNrUnprocessedCells() const;
+
+		/**
+		 * Check if all the cells in a rectangle have been processed. Cells outside the grid are ignored.
+		 * @return True if no tile that overlaps with the rectangle has unprocessed cells, false otherwise.
+		 */
+		bool isAreaProcessed(int min_x, int min_y, int max_x, int max_y) const;
+
+		/**
+		 * @return The number of bytes used to store the processed cells.
+		 */
+		std::size_t getMemoryUsage() const;
+
+	private:
+		int width_, height_;
+		int width_in_tiles_, height_in_tiles_;
+		std::vector<int> bitmap_indices_;                // The index of the first row of the bitmap of every tile, -1 if it has none.
+		std::vector<unsigned int> nr_unprocessed_cells_; // The number of unprocessed cells of every tile.
+		std::vector<uint64_t> bitmaps_;                  // TILE_SIZE rows for every tile with a bitmap, a set bit is a processed cell.
+	};
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef KCL_ROSPLAN_TOURPLANNER_H
+#define KCL_ROSPLAN_TOURPLANNER_H
+
+#include <vector>
+#include <nav_msgs/OccupancyGrid.h>
+#include <geometry_msgs/Point.h>
+
+namespace KCL_rosplan {
+
+	/**
+	 * Orders a set of waypoints, for example the view poses of an exploration, so the robot drives the shortest
+	 * distance visiting all of them. The travel cost between every pair of waypoints is the length of the
+	 * shortest 8-connected path through the free cells of an occupancy grid, found with one Dijkstra wavefront
+	 * per waypoint. The order is a nearest-neighbour tour improved with 2-opt and Or-opt moves.
+	 */
+	class TourPlanner {
+	public:
+		/**
+		 * The travel cost in metres between waypoints that are not connected by free space.
+		 */
+		static const float UNREACHABLE;
+
+		/**
+		 * Constructor, there are no travel costs until @ref{computeTravelCosts} is called.
+		 */
+		TourPlanner();
+
+		/**
+		 * Set the number of threads that compute the wavefronts.
+		 * @param nr_threads The number of threads, 0 uses one thread per available core.
+		 */
+		void setNumberOfThreads(unsigned int nr_threads);
+
+		/**
+		 * Compute the travel costs between every pair of waypoints. The cells of the waypoints themselves are
+		 * always passable, so a waypoint on an obstacle can still be left and reached.
+		 * @param grid The occupancy grid.
+		 * @param occupancy_threshold Cells with a value above this threshold or with the value -1 are not passable.
+		 * @param waypoints The waypoints in the frame of the occupancy grid.
+		 */
+		void computeTravelCosts(const nav_msgs::OccupancyGrid& grid, int occupancy_threshold, const std::vector<geometry_msgs::Point>& waypoints);
+
+		/**
+		 * @return The number of waypoints the travel costs were computed for.
+		 */
+		unsigned int getNrWaypoints() const { return nr_waypoints_; }
+
+		/**
+		 * @return The travel cost in metres from waypoint @ref{from} to waypoint @ref{to}, @ref{UNREACHABLE} if
+		 * there is no path.
+		 */
+		float getTravelCost(unsigned int from, unsigned int to) const { return travel_costs_[from * nr_waypoints_ + to]; }
+
+		/**
+		 * @return The travel costs of every pair of waypoints, row by row (from, to).
+		 */
+		const std::vector<float>& getTravelCosts() const { return travel_costs_; }
+
+		/**
+		 * Find a short path that starts at a waypoint and visits every other waypoint once, it does not return
+		 * to the start.
+		 * @param start The waypoint to start from.
+		 * @param tour The waypoints in the order they are visited, starting with @ref{start}.
+		 * @return The travel cost of the tour.
+		 */
+		float findTour(unsigned int start, std::vector<unsigned int>& tour) const;
+
+	private:
+
+		/**
+		 * Compute the wavefronts of the waypoints assigned to a single thread, that is every
+		 * @ref{nr_threads}th waypoint starting from @ref{thread_id}.
+		 * @param info The meta data of the occupancy grid.
+		 * @param passable For every cell whether it can be driven through.
+		 * @param waypoint_cells The index of the cell of every waypoint, -1 if it lies outside the grid.
+		 * @param thread_id The index of this thread.
+		 * @param nr_threads The total number of threads.
+		 */
+		void computeWavefronts(const nav_msgs::MapMetaData& info, const std::vector<unsigned char>& passable, const std::vector<int>& waypoint_cells, unsigned int thread_id, unsigned int nr_threads);
+
+		/**
+		 * @return The travel cost between two waypoints regardless of the direction, the average of both ways.
+		 */
+		float getCost(unsigned int a, unsigned int b) const { return 0.5f * (getTravelCost(a, b) + getTravelCost(b, a)); }
+
+		/**
+		 * Improve a tour by reversing a part of it, until no reversal makes it shorter.
+		 * @return True if the tour was changed.
+		 */
+		bool improveTwoOpt(std::vector<unsigned int>& tour) const;
+
+		/**
+		 * Improve a tour by moving a sequence of up to three waypoints, possibly reversed, to another place in
+		 * the tour, until no move makes it shorter.
+		 * @return True if the tour was changed.
+		 */
+		bool improveOrOpt(std::vector<unsigned int>& tour) const;
+
+		unsigned int nr_threads_;
+		unsigned int nr_waypoints_;
+		std::vector<float> travel_costs_;
+	};
+};
+
+#endif
@@ -10,11 +10,114 @@
 #include <nav_msgs/OccupancyGrid.h>
 #include <occupancy_grid_utils/ray_tracer.h>
 #include <occupancy_grid_utils/coordinate_conversions.h>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "squirrel_planning_execution/DistanceField.h"
+#include "squirrel_planning_execution/RegionMask.h"
+#include "squirrel_planning_execution/TiledGrid.h"
 
 namespace KCL_rosplan {
 
 	class ViewConeGenerator {
 	public:
+		/**
+		 * The strategies that can be used to select the view cones.
+		 */
+		enum SelectionStrategy
+		{
+			RANDOM_RESTART, // For every view cone sample @ref{sample_size} new candidates and pick the best one.
+			LAZY_GREEDY     // Sample a pool of candidates once and greedily pick the ones that add the most unobserved cells.
+		};
+		
+		/**
+		 * The ways the positions of the view cones can be sampled. A cell is admissible if it is free, lies 
+		 * within the bounding box and is at least the safe distance away from any obstacle.
+		 */
+		enum SamplingStrategy
+		{
+			REJECTION_SAMPLING,   // Draw any cell of the grid and reject it if it is not admissible.
+			ADMISSIBLE_UNIFORM,   // Draw uniformly from the admissible cells.
+			ADMISSIBLE_STRATIFIED // Divide the admissible cells into spatially compact strata, one per sample, and draw one cell from each.
+		};
+		
+		/**
+		 * The progress of a call to @ref{createViewCones}, reported after every view cone that is selected.
+		 */
+		struct ViewConeProgress
+		{
+			ViewConeProgress()
+				: nr_view_cones_(0), nr_covered_cells_(0), nr_free_cells_(0), deadline_reached_(false), finished_(false)
+			{
+				
+			}
+			
+			/**
+			 * @return The fraction of the free cells that is covered by the selected view cones.
+			 */
+			float getCoverage() const { return nr_free_cells_ == 0 ? 0.0f : (float)nr_covered_cells_ / nr_free_cells_; }
+			
+			unsigned int nr_view_cones_;    // The number of view cones selected so far.
+			unsigned int nr_covered_cells_; // The number of free cells observed by those view cones.
+			unsigned int nr_free_cells_;    // The number of free cells in the occupancy grid.
+			ros::WallTime start_time_;
+			ros::WallDuration elapsed_time_;
+			bool deadline_reached_;         // True if the search stopped because the time budget ran out.
+			bool finished_;                 // True for the last report of a call.
+		};
+		
+		typedef boost::function<void (const ViewConeProgress&)> ProgressCallback;
+		
+		/**
+		 * Statistics of the samples drawn during the last call to @ref{createViewCones}.
+		 */
+		struct SamplingStatistics
+		{
+			SamplingStatistics()
+				: nr_admissible_cells_(0), nr_samples_(0), nr_accepted_samples_(0)
+			{
+				
+			}
+			
+			unsigned int nr_admissible_cells_; // 0 when REJECTION_SAMPLING is used.
+			unsigned int nr_samples_;
+			unsigned int nr_accepted_samples_;
+		};
+		
+		/**
+		 * The wall-clock time spent in each phase of the last call to @ref{createViewCones}.
+		 */
+		struct PhaseTimings
+		{
+			ros::WallDuration initialisation_;   // Finding the free cells.
+			ros::WallDuration stencils_;         // Rasterising the view cones of the yaw bins.
+			ros::WallDuration admissible_cells_; // Finding the cells view cones can be sampled from.
+			ros::WallDuration selection_;        // Sampling and selecting the view cones.
+			ros::WallDuration visualisation_;
+			ros::WallDuration total_;
+		};
+		
+		/**
+		 * The view cone parameters of a single sensor, several of them can be generated in one call to 
+		 * @ref{createViewCones}.
+		 */
+		struct ViewConeProfile
+		{
+			ViewConeProfile(float fov, float view_distance, unsigned int max_view_cones, unsigned int sample_size, float safe_distance)
+				: fov_(fov), view_distance_(view_distance), max_view_cones_(max_view_cones), sample_size_(sample_size), safe_distance_(safe_distance)
+			{
+				
+			}
+			
+			float fov_;                       // Field of view.
+			float view_distance_;             // The maximum viewing distance (straight in front).
+			unsigned int max_view_cones_;     // The maximum number of view cones that are generated.
+			unsigned int sample_size_;        // How many view cones are sampled at each iteration.
+			float safe_distance_;             // The minimal distance between a waypoint and any obstacle.
+			std::vector<std::vector<tf::Vector3> > regions_; // The polygons to cover, empty to cover the entire grid.
+		};
+		
 		/**
 		 * Constructor.
 		 * @param node_handle A ROS node handle.
@@ -23,8 +126,15 @@ namespace KCL_rosplan {
 		ViewConeGenerator(ros::NodeHandle& node_handle, const std::string& topic_name);
 		
 		/**
-		 * Callback function of the occupancy grid subscriber. It saves the latest received occupancy 
-		 * grid message. This is used for collision detection.
+		 * Constructor for use without a ROS master, nothing is subscribed to or published. The occupancy grid 
+		 * has to be given to @ref{storeNavigationGrid}.
+		 */
+		ViewConeGenerator();
+		
+		/**
+		 * Callback function of the occupancy grid subscriber. The message is not copied, it is swapped in 
+		 * together with its distance transform as the latest snapshot. Computations that are in progress keep 
+		 * using the snapshot they started with.
 		 * @param msg A pointer to the occupancy grid.
 		 */
 		void storeNavigationGrid(const nav_msgs::OccupancyGrid::ConstPtr& msg);
@@ -32,7 +142,7 @@ namespace KCL_rosplan {
 		/**
 		 * Create a set of viewcones that covers the entire navigation grid.
 		 * @param poses The poses that are found are added to this list.
-		 * @param bounding_box The bounding box where all the view cones must be generated within.
+		 * @param bounding_box The polygon where all the view cones must be generated within, if empty the entire grid is covered.
 		 * @param max_view_cones The maximum number of view cones that are generated.
 		 * @param occupancy_threshold The threshold at which a point in the grid is considered occupied. The
 		 * accepted range is [0,100].
@@ -43,12 +153,493 @@ namespace KCL_rosplan {
 		 */
 		void createViewCones(std::vector<geometry_msgs::Pose>& poses, const std::vector<tf::Vector3>& bounding_box, unsigned int max_view_cones, int occupancy_threshold, float fov, float view_distance, unsigned int sample_size, float safe_distance);
 		
+		/**
+		 * Create a set of viewcones that covers the entire navigation grid within a time budget. When the budget 
+		 * runs out the view cones that have been selected so far are returned. The progress is reported after 
+		 * every view cone through @ref{progress_callback} and on the /diagnostics topic.
+		 * @param poses The poses that are found are added to this list.
+		 * @param bounding_box The polygon where all the view cones must be generated within, if empty the entire grid is covered.
+		 * @param max_view_cones The maximum number of view cones that are generated.
+		 * @param occupancy_threshold The threshold at which a point in the grid is considered occupied. The
+		 * accepted range is [0,100].
+		 * @param fov Field of view.
+		 * @param view_distance The maximum viewing distance (straight in front).
+		 * @param sample_size How many view cones should be generated at each iteration.
+		 * @param safe_distance Waypoints cannot be generated @ref{safe_distance} away from any obstacles in the occupancy grid.
+		 * @param time_budget The maximum wall-clock time to spend, 0 means no limit.
+		 * @param progress_callback Called after every view cone that is selected and once at the end, may be empty.
+		 * @return The progress at the end of the call.
+		 */
+		ViewConeProgress createViewCones(std::vector<geometry_msgs::Pose>& poses, const std::vector<tf::Vector3>& bounding_box, unsigned int max_view_cones, int occupancy_threshold, float fov, float view_distance, unsigned int sample_size, float safe_distance, const ros::WallDuration& time_budget, const ProgressCallback& progress_callback = ProgressCallback());
+		
+		/**
+		 * Create a set of viewcones that covers the free cells inside a set of regions, for example the rooms of
+		 * a segmented map, within a time budget. The regions are rasterised once per call. Only cells inside a
+		 * region are admissible view points and count towards the coverage.
+		 * @param poses The poses that are found are added to this list.
+		 * @param regions Polygons in the frame of the occupancy grid, they do not need to be convex. If there are
+		 * none, the entire navigation grid is covered.
+		 * @param max_view_cones The maximum number of view cones that are generated.
+		 * @param occupancy_threshold The threshold at which a point in the grid is considered occupied. The
+		 * accepted range is [0,100].
+		 * @param fov Field of view.
+		 * @param view_distance The maximum viewing distance (straight in front).
+		 * @param sample_size How many view cones should be generated at each iteration.
+		 * @param safe_distance Waypoints cannot be generated @ref{safe_distance} away from any obstacles in the occupancy grid.
+		 * @param time_budget The maximum wall-clock time to spend, 0 means no limit.
+		 * @param progress_callback Called after every view cone that is selected and once at the end, may be empty.
+		 * @return The progress at the end of the call.
+		 */
+		ViewConeProgress createViewCones(std::vector<geometry_msgs::Pose>& poses, const std::vector<std::vector<tf::Vector3> >& regions, unsigned int max_view_cones, int occupancy_threshold, float fov, float view_distance, unsigned int sample_size, float safe_distance, const ros::WallDuration& time_budget, const ProgressCallback& progress_callback = ProgressCallback());
+		
+		/**
+		 * Create a set of view cones for each of several profiles, for example one for every camera of the robot. 
+		 * The profiles are generated concurrently from the same snapshot of the occupancy grid and share the work 
+		 * that does not depend on the field of view: the tiles of the grid, the region masks and admissible cells 
+		 * of profiles with the same regions and safe distance, and the yaw bin stencils of profiles with the same 
+		 * field of view and view distance. The threads set with @ref{setNumberOfThreads} are divided over the 
+		 * profiles. Every profile gets the same poses as a separate call without incremental replanning, the 
+		 * view cones are neither reused by nor kept for incremental replanning and they are not visualised.
+		 * @param poses One list of poses for every profile, the poses that are found are added to them.
+		 * @param profiles The parameters of the view cones of every profile.
+		 * @param occupancy_threshold The threshold at which a point in the grid is considered occupied. The
+		 * accepted range is [0,100].
+		 * @param time_budget The maximum wall-clock time to spend on all the profiles, 0 means no limit.
+		 * @return The progress of every profile at the end of the call.
+		 */
+		std::vector<ViewConeProgress> createViewCones(std::vector<std::vector<geometry_msgs::Pose> >& poses, const std::vector<ViewConeProfile>& profiles, int occupancy_threshold, const ros::WallDuration& time_budget);
+		
 		/**
 		 * @return True if a occupancy grid has been received and the instance is ready to do work, false otherwise.
 		 */
-		bool hasReceivedOccupancyGrid() const { return has_received_occupancy_grid_; }
+		bool hasReceivedOccupancyGrid() const;
+		
+		/**
+		 * Set the number of threads that are used to evaluate the sampled view cones.
+		 * @param nr_threads The number of threads, 0 uses one thread per available core.
+		 */
+		void setNumberOfThreads(unsigned int nr_threads);
+		
+		/**
+		 * Set the seed used to sample view cones. Given the same seed and occupancy grid the same poses are 
+		 * generated, regardless of the number of threads.
+		 * @param seed The seed.
+		 */
+		void setSeed(unsigned int seed);
+		
+		/**
+		 * Set the strategy that is used to select the view cones, the default is RANDOM_RESTART.
+		 * @param strategy The selection strategy.
+		 */
+		void setSelectionStrategy(SelectionStrategy strategy);
+		
+		/**
+		 * Set the number of candidates that are sampled when the LAZY_GREEDY strategy is used.
+		 * @param pool_size The number of candidates, 0 uses 10 times the sample size that is passed to 
+		 * @ref{createViewCones}.
+		 */
+		void setCandidatePoolSize(unsigned int pool_size);
+		
+		/**
+		 * Set how the positions of the view cones are sampled, the default is ADMISSIBLE_STRATIFIED.
+		 * @param sampling The sampling strategy.
+		 */
+		void setSamplingStrategy(SamplingStrategy sampling);
+		
+		/**
+		 * Restrict the yaw of the view cones to a number of evenly spaced bins. The footprint of a view cone 
+		 * only depends on its yaw, so for each bin it is rasterised once per call to @ref{createViewCones} and 
+		 * then translated to every sampled position.
+		 * @param nr_yaw_bins The number of bins, 0 samples a continuous yaw (the default).
+		 * @param try_all_yaw_bins If true every bin is evaluated at every sampled position and the best one is 
+		 * kept, otherwise a single random bin is evaluated. The visibility from a position does not depend on 
+		 * the yaw, so it is only computed once per position.
+		 */
+		void setYawBins(unsigned int nr_yaw_bins, bool try_all_yaw_bins);
+		
+		/**
+		 * Keep the view cones of the previous call to @ref{createViewCones}. If the next call has the same 
+		 * parameters, the new occupancy grid is compared with the previous one tile by tile. Only the view cones 
+		 * whose surroundings changed are discarded, and new view cones are only sampled near the changed tiles. 
+		 * If nothing changed the previous poses are returned. A call that runs out of time is not kept, and if 
+		 * the previous call found fewer than the maximum number of view cones the missing ones are sampled from 
+		 * the whole grid. Enabled by default.
+		 * @param incremental True to reuse the previous view cones, false to always start from scratch.
+		 */
+		void setIncrementalReplanning(bool incremental);
+		
+		/**
+		 * @return The statistics of the samples drawn during the last call to @ref{createViewCones}.
+		 */
+		const SamplingStatistics& getSamplingStatistics() const { return sampling_statistics_; }
+		
+		/**
+		 * @return The time spent in each phase of the last call to @ref{createViewCones}.
+		 */
+		const PhaseTimings& getPhaseTimings() const { return phase_timings_; }
+		
+		/**
+		 * @return The distance transform of the last received occupancy grid, any cell with a value above 0 is 
+		 * an obstacle. It is empty if no occupancy grid has been received yet.
+		 */
+		boost::shared_ptr<const DistanceField> getDistanceField() const;
+		
+		/**
+		 * @return The last received occupancy grid, it is empty if no occupancy grid has been received yet.
+		 */
+		nav_msgs::OccupancyGrid::ConstPtr getOccupancyGrid() const;
+
+		/**
+		 * Find the cells inside a view cone the same way the sampled view cones are rasterised, so the
+		 * rasteriser can be checked without sampling.
+		 * @param info The meta data of the occupancy grid.
+		 * @param view_cell The cell that is viewed from, the view point lies at its centre.
+		 * @param yaw The direction of the view cone.
+		 * @param fov Field of view.
+		 * @param view_distance The maximum viewing distance (straight in front).
+		 * @param cells The cells inside the view cone are added to this list, @ref{view_cell} included.
+		 */
+		void getViewConeCells(const nav_msgs::MapMetaData& info, const occupancy_grid_utils::Cell& view_cell, float yaw, float fov, float view_distance, std::vector<occupancy_grid_utils::Cell>& cells) const;
 	private:
 		
+		/**
+		 * Start with an empty snapshot, so there is always a snapshot to return.
+		 */
+		void initialiseSnapshot();
+		
+		/**
+		 * Get the tiled summary of an occupancy grid. It is only recomputed if the grid or the threshold 
+		 * changed since the last call.
+		 * @param grid The occupancy grid.
+		 * @param occupancy_threshold The threshold at which a cell in the grid is considered occupied.
+		 * @return The tiled summary.
+		 */
+		boost::shared_ptr<const TiledGrid> getTiledGrid(const nav_msgs::OccupancyGrid::ConstPtr& grid, int occupancy_threshold);
+		
+		/**
+		 * An occupancy grid and its distance transform. A snapshot is never modified after it has been 
+		 * published, so readers can use it without holding a lock.
+		 */
+		struct GridSnapshot
+		{
+			nav_msgs::OccupancyGrid::ConstPtr grid_;
+			boost::shared_ptr<const DistanceField> distance_field_;
+		};
+		typedef boost::shared_ptr<const GridSnapshot> GridSnapshotConstPtr;
+		
+		/**
+		 * The cells covered by a view cone with a given yaw, as offsets from the cell of the view point. The 
+		 * view point is assumed to lie at the centre of its cell.
+		 */
+		struct ViewConeStencil
+		{
+			float yaw_;
+			int min_dx_, max_dx_, min_dy_, max_dy_;       // The bounding box of the offsets, including (0, 0).
+			std::vector<std::pair<int, int> > offsets_;   // The cell of the view point itself is not included.
+		};
+		
+		/**
+		 * The parameters of a call to @ref{createViewCones} that are needed to evaluate a single view cone.
+		 */
+		struct ViewConeSettings
+		{
+			ViewConeSettings(const GridSnapshot& snapshot, const TiledGrid& tiled_grid, const RegionMask& region_mask, const std::vector<occupancy_grid_utils::Cell>& admissible_cells, SamplingStrategy sampling, const std::vector<ViewConeStencil>& stencils, bool try_all_yaw_bins, int occupancy_threshold, float fov, float view_distance, float safe_distance, unsigned int nr_threads)
+				: grid_(*snapshot.grid_), distance_field_(*snapshot.distance_field_), tiled_grid_(tiled_grid), region_mask_(region_mask), admissible_cells_(admissible_cells), sampling_(sampling), stencils_(stencils), try_all_yaw_bins_(try_all_yaw_bins), occupancy_threshold_(occupancy_threshold), fov_(fov), view_distance_(view_distance), safe_distance_(safe_distance), nr_threads_(nr_threads)
+			{
+				
+			}
+			
+			/**
+			 * @return True if a deadline is set and it has passed, false otherwise.
+			 */
+			bool isDeadlineReached() const { return !deadline_.isZero() && ros::WallTime::now() >= deadline_; }
+			
+			const nav_msgs::OccupancyGrid& grid_;
+			const DistanceField& distance_field_;
+			const TiledGrid& tiled_grid_;                     // Computed with @ref{occupancy_threshold_}.
+			const RegionMask& region_mask_;                   // The cells that may be viewed from and covered.
+			const std::vector<occupancy_grid_utils::Cell>& admissible_cells_; // Sorted in Morton (Z-)order.
+			SamplingStrategy sampling_;
+			const std::vector<ViewConeStencil>& stencils_;     // One for every yaw bin, empty if the yaw is continuous.
+			bool try_all_yaw_bins_;
+			int occupancy_threshold_;
+			float fov_;
+			float view_distance_;
+			float safe_distance_;
+			unsigned int nr_threads_;                         // The number of threads that evaluate the samples.
+			ros::WallTime deadline_;                          // Zero if there is no deadline.
+		};
+		
+		/**
+		 * A sampled view cone and the cells that are visible from it that have not been processed yet. If the 
+		 * sample was rejected the list of visible cells is empty.
+		 */
+		struct ViewConeCandidate
+		{
+			ViewConeCandidate()
+				: accepted_(false)
+			{
+				
+			}
+			
+			bool accepted_;
+			geometry_msgs::Pose pose_;
+			occupancy_grid_utils::Cell view_cell_;
+			std::vector<occupancy_grid_utils::Cell> visible_cells_;
+		};
+		
+		/**
+		 * The view cones selected by a call to @ref{createViewCones} and the parameters it was called with, so 
+		 * the next call can keep the view cones whose surroundings did not change.
+		 */
+		struct ViewConePlan
+		{
+			nav_msgs::OccupancyGrid::ConstPtr grid_;
+			std::vector<std::vector<tf::Vector3> > regions_;
+			unsigned int max_view_cones_;
+			int occupancy_threshold_;
+			float fov_;
+			float view_distance_;
+			unsigned int sample_size_;
+			float safe_distance_;
+			SelectionStrategy strategy_;
+			unsigned int pool_size_;
+			SamplingStrategy sampling_;
+			unsigned int nr_yaw_bins_;
+			bool try_all_yaw_bins_;
+			std::vector<ViewConeCandidate> view_cones_;   // The cells that each view cone added to the coverage.
+		};
+		
+		/**
+		 * An entry in the priority queue of the LAZY_GREEDY strategy. The gain is the number of unobserved cells 
+		 * a candidate added when it was last evaluated, which is an upper bound of its current gain.
+		 */
+		struct LazyGreedyEntry
+		{
+			LazyGreedyEntry(unsigned int gain, unsigned int candidate, unsigned int evaluated_at)
+				: gain_(gain), candidate_(candidate), evaluated_at_(evaluated_at)
+			{
+				
+			}
+			
+			/**
+			 * Order the entries by their gain, ties are broken by the lowest candidate index.
+			 */
+			bool operator<(const LazyGreedyEntry& other) const
+			{
+				return gain_ < other.gain_ || (gain_ == other.gain_ && candidate_ > other.candidate_);
+			}
+			
+			unsigned int gain_;
+			unsigned int candidate_;
+			unsigned int evaluated_at_; // The number of view cones that were selected when the gain was computed.
+		};
+		
+		/**
+		 * @return The latest snapshot of the occupancy grid.
+		 */
+		GridSnapshotConstPtr getSnapshot() const;
+		
+		/**
+		 * @return The number of threads to use, resolving 0 to the number of available cores.
+		 */
+		unsigned int getNumberOfThreads() const;
+		
+		/**
+		 * Check if a view cone can be placed at a cell.
+		 * @param settings The parameters of the view cones.
+		 * @param cell The cell to check.
+		 * @return True if the cell is free, lies within the bounding box and is at least the safe distance away 
+		 * from any obstacle, false otherwise.
+		 */
+		bool isAdmissible(const ViewConeSettings& settings, const occupancy_grid_utils::Cell& cell) const;
+		
+		/**
+		 * Find all the admissible cells of the grid and sort them in Morton (Z-)order, so that every contiguous 
+		 * range of cells covers a compact area.
+		 * @param settings The parameters of the view cones.
+		 * @param region For every tile whether to search it, if empty the whole grid is searched.
+		 * @param admissible_cells The admissible cells are added to this list.
+		 */
+		void findAdmissibleCells(const ViewConeSettings& settings, const std::vector<bool>& region, std::vector<occupancy_grid_utils::Cell>& admissible_cells) const;
+		
+		/**
+		 * Mark the free cells that lie outside a region mask as processed, so they do not count as covered.
+		 * @param tiled_grid The tiles of the occupancy grid.
+		 * @param region_mask The cells to cover.
+		 * @param processed_cells The cells that have been processed.
+		 */
+		void restrictToRegion(const TiledGrid& tiled_grid, const RegionMask& region_mask, TiledCoverage& processed_cells) const;
+		
+		/**
+		 * Select the view cones of one profile of a batch with the configured selection strategy.
+		 * @param poses The poses that are found are added to this list.
+		 * @param profile The parameters of the view cones.
+		 * @param settings The parameters of the view cones that are needed to evaluate them.
+		 * @param processed_cells The cells that have already been observed or cannot be observed.
+		 * @param statistics The statistics of the samples that are drawn.
+		 * @param progress The progress of the profile.
+		 */
+		void selectProfileViewCones(std::vector<geometry_msgs::Pose>& poses, const ViewConeProfile& profile, const ViewConeSettings& settings, TiledCoverage& processed_cells, SamplingStatistics& statistics, ViewConeProgress& progress) const;
+		
+		/**
+		 * Check if the view cones of a previous call can be reused.
+		 * @param previous_plan The view cones and parameters of the previous call.
+		 * @param plan The parameters of this call.
+		 * @return True if the parameters are the same and the grids have the same size, resolution and origin. 
+		 * The time budget is not compared, only plans that finished before their deadline are kept.
+		 */
+		static bool isCompatible(const ViewConePlan& previous_plan, const ViewConePlan& plan);
+		
+		/**
+		 * Find the tiles that differ between two occupancy grids of the same size.
+		 * @param old_grid The previous occupancy grid.
+		 * @param new_grid The new occupancy grid.
+		 * @param tiled_grid The tiles of the new occupancy grid.
+		 * @param changed_tiles For every tile whether any of its cells changed.
+		 * @return The number of changed tiles.
+		 */
+		unsigned int findChangedTiles(const nav_msgs::OccupancyGrid& old_grid, const nav_msgs::OccupancyGrid& new_grid, const TiledGrid& tiled_grid, std::vector<bool>& changed_tiles) const;
+		
+		/**
+		 * @return The distance in cells from the view cell within which the occupancy grid affects a view cone: 
+		 * the cells it can see and the cells that determine whether its position is admissible.
+		 */
+		int getViewConeRadius(const nav_msgs::MapMetaData& info, float fov, float view_distance, float safe_distance) const;
+		
+		/**
+		 * Sample and evaluate the candidates for a single iteration, the samples are divided over the threads.
+		 * @param iteration The index that is used to seed the samples.
+		 * @param settings The parameters of the view cones.
+		 * @param processed_cells The cells that have already been observed or cannot be observed.
+		 * @param candidates The sampled view cones, one for every element.
+		 * @param statistics The number of samples and accepted samples are added to these statistics.
+		 */
+		void sampleCandidates(unsigned int iteration, const ViewConeSettings& settings, const TiledCoverage& processed_cells, std::vector<ViewConeCandidate>& candidates, SamplingStatistics& statistics) const;
+		
+		/**
+		 * Select view cones with the RANDOM_RESTART strategy: for every view cone @ref{sample_size} new 
+		 * candidates are sampled and evaluated, and the one that observes the most unobserved cells is picked.
+		 * @param poses The poses that are found are added to this list.
+		 * @param max_view_cones The maximum number of view cones that are generated.
+		 * @param sample_size How many view cones are sampled for every view cone.
+		 * @param settings The parameters of the view cones.
+		 * @param processed_cells The cells that have already been observed or cannot be observed, updated with 
+		 * the cells observed by the selected view cones.
+		 * @param statistics The statistics of the samples that are drawn.
+		 * @param progress The progress, reported after every view cone that is selected.
+		 * @param progress_callback The callback the progress is reported to, may be empty.
+		 * @param plan The selected view cones are added to this plan.
+		 */
+		void selectRandomRestart(std::vector<geometry_msgs::Pose>& poses, unsigned int max_view_cones, unsigned int sample_size, const ViewConeSettings& settings, TiledCoverage& processed_cells, SamplingStatistics& statistics, ViewConeProgress& progress, const ProgressCallback& progress_callback, ViewConePlan& plan) const;
+		
+		/**
+		 * Select view cones with the LAZY_GREEDY strategy: a pool of candidates is sampled and evaluated once, 
+		 * after which the candidate that adds the most unobserved cells is picked repeatedly. Because the gain 
+		 * of a candidate can only shrink as more cells are observed, only the candidate at the top of the 
+		 * priority queue is re-evaluated, and only if its gain is out of date (CELF). Re-evaluating a candidate 
+		 * only counts which of its visible cells are still unobserved, no rays are traced.
+		 * @param poses The poses that are found are added to this list.
+		 * @param max_view_cones The maximum number of view cones that are generated.
+		 * @param pool_size The number of candidates that are sampled.
+		 * @param settings The parameters of the view cones.
+		 * @param processed_cells The cells that have already been observed or cannot be observed, updated with 
+		 * the cells observed by the selected view cones.
+		 * @param statistics The statistics of the samples that are drawn.
+		 * @param progress The progress, reported after every view cone that is selected.
+		 * @param progress_callback The callback the progress is reported to, may be empty.
+		 * @param plan The selected view cones are added to this plan.
+		 */
+		void selectLazyGreedy(std::vector<geometry_msgs::Pose>& poses, unsigned int max_view_cones, unsigned int pool_size, const ViewConeSettings& settings, TiledCoverage& processed_cells, SamplingStatistics& statistics, ViewConeProgress& progress, const ProgressCallback& progress_callback, ViewConePlan& plan) const;
+		
+		/**
+		 * Mark the cells observed by a view cone as processed and log the pose.
+		 * @param grid The occupancy grid the view cone was sampled in.
+		 * @param candidate The selected view cone.
+		 * @param processed_cells The cells that have already been observed or cannot be observed.
+		 * @param progress The number of view cones and covered cells are updated.
+		 * @param plan The view cone is added to this plan.
+		 */
+		void markObserved(const nav_msgs::OccupancyGrid& grid, const ViewConeCandidate& candidate, TiledCoverage& processed_cells, ViewConeProgress& progress, ViewConePlan& plan) const;
+		
+		/**
+		 * Report the progress to the callback and publish it on the diagnostics topic.
+		 * @param progress The progress, its elapsed time is updated.
+		 * @param progress_callback The callback the progress is reported to, may be empty.
+		 */
+		void reportProgress(ViewConeProgress& progress, const ProgressCallback& progress_callback) const;
+		
+		/**
+		 * Sample and evaluate the view cones assigned to a single thread, that is every @ref{nr_threads}th 
+		 * candidate starting from @ref{thread_id}.
+		 * @param iteration The index of the view cone that is being generated.
+		 * @param thread_id The index of this thread.
+		 * @param nr_threads The total number of threads.
+		 * @param settings The parameters of the view cones.
+		 * @param processed_cells The cells that have already been observed or cannot be observed.
+		 * @param candidates The candidates, only the ones assigned to this thread are written to.
+		 */
+		void sampleViewCones(unsigned int iteration, unsigned int thread_id, unsigned int nr_threads, const ViewConeSettings& settings, const TiledCoverage& processed_cells, std::vector<ViewConeCandidate>& candidates) const;
+		
+		/**
+		 * Sample a single view cone and determine which unprocessed cells are visible from it. The random 
+		 * generator is seeded from @ref{iteration} and @ref{sample} so the result is deterministic.
+		 * @param iteration The index of the view cone that is being generated.
+		 * @param sample The index of the sample.
+		 * @param nr_samples The number of samples drawn in this iteration, used to stratify the samples.
+		 * @param settings The parameters of the view cones.
+		 * @param processed_cells The cells that have already been observed or cannot be observed.
+		 * @param candidate The sampled view cone is stored here.
+		 */
+		void sampleViewCone(unsigned int iteration, unsigned int sample, unsigned int nr_samples, const ViewConeSettings& settings, const TiledCoverage& processed_cells, ViewConeCandidate& candidate) const;
+		
+		/**
+		 * Calculate the far corners of the triangle that a view cone covers.
+		 * @param view_point The apex of the view cone.
+		 * @param yaw The direction of the view cone.
+		 * @param fov Field of view.
+		 * @param view_distance The maximum viewing distance (straight in front).
+		 * @param v1 The first far corner.
+		 * @param v2 The second far corner.
+		 */
+		void computeViewConeCorners(const tf::Vector3& view_point, float yaw, float fov, float view_distance, tf::Vector3& v1, tf::Vector3& v2) const;
+		
+		/**
+		 * Rasterise the view cone of every yaw bin once.
+		 * @param info The meta data of the occupancy grid.
+		 * @param fov Field of view.
+		 * @param view_distance The maximum viewing distance (straight in front).
+		 * @param nr_yaw_bins The number of evenly spaced yaw bins.
+		 * @param stencils The stencil of every yaw bin.
+		 */
+		void buildStencils(const nav_msgs::MapMetaData& info, float fov, float view_distance, unsigned int nr_yaw_bins, std::vector<ViewConeStencil>& stencils) const;
+		
+		/**
+		 * Determine which cells are visible from a view cell using the precomputed stencils.
+		 * @param settings The parameters of the view cones.
+		 * @param view_cell The cell that is being viewed from.
+		 * @param yaw_bin The yaw bin to evaluate, or -1 to evaluate all of them.
+		 * @param processed_cells Cells that have been processed are skipped.
+		 * @param visible_cells The cells that are not processed and are visible in the best yaw bin are added 
+		 * to this list.
+		 * @return The yaw bin whose cells were added, if several bins are equally good the first one.
+		 */
+		unsigned int evaluateStencils(const ViewConeSettings& settings, const occupancy_grid_utils::Cell& view_cell, int yaw_bin, const TiledCoverage& processed_cells, std::vector<occupancy_grid_utils::Cell>& visible_cells) const;
+		
+		/**
+		 * Compute the fraction of the line of sight to the view cell that is unobstructed for every cell in a 
+		 * rectangle, see @ref{findVisibleCells}.
+		 * If the rectangle only overlaps with free tiles nothing can block the view and the sweep is skipped.
+		 * @param settings The parameters of the view cones.
+		 * @param view_cell The cell that is being viewed from, it must lie inside the rectangle.
+		 * @param min_x The smallest x coordinate of the rectangle.
+		 * @param min_y The smallest y coordinate of the rectangle.
+		 * @param max_x The largest x coordinate of the rectangle.
+		 * @param max_y The largest y coordinate of the rectangle.
+		 * @param transparency The unobstructed fraction of every cell in the rectangle, row by row.
+		 */
+		void computeTransparency(const ViewConeSettings& settings, const occupancy_grid_utils::Cell& view_cell, int min_x, int min_y, int max_x, int max_y, std::vector<float>& transparency) const;
+		
 		/**
 		 * Publish the generated viewcones to RViz.
 		 * @param poses The found poses.
@@ -58,28 +649,51 @@ namespace KCL_rosplan {
 		void visualiseViewCones(const std::vector<geometry_msgs::Pose>& poses, float view_distance, float fov) const;
 		
 		/**
-		 * Check if two waypoints can be connected without colliding with any known scenery. The line is assumed
-		 * to have an effective width of 0.
-		 * @param w1 The first waypoint.
-		 * @param w2 The second waypoint.
-		 * @param occupancy_threshold The threshold at which a point in the grid is considered occupied. The
-		 * accepted range is [0,100].
-		 * @return True if the waypoints can be connected, false otherwise.
+		 * Find all the cells whose centre lies inside the triangle spanned by the view cone. The triangle is
+		 * scan converted row by row: for each row the span that overlaps with the triangle is computed and
+		 * only the cells in that span are tested against the edge functions. Each cell is emitted once.
+		 * @param info The meta data of the occupancy grid.
+		 * @param view_point The apex of the view cone.
+		 * @param v1 The first far corner of the view cone.
+		 * @param v2 The second far corner of the view cone.
+		 * @param view_cell The cell that contains @ref{view_point}, it is always part of the result.
+		 * @param cells The cells inside the view cone are added to this list.
 		 */
-		bool canConnect(const geometry_msgs::Point& w1, const geometry_msgs::Point& w2, int occupancy_threshold);
+		void rasteriseViewCone(const nav_msgs::MapMetaData& info, const tf::Vector3& view_point, const tf::Vector3& v1, const tf::Vector3& v2, const occupancy_grid_utils::Cell& view_cell, std::vector<occupancy_grid_utils::Cell>& cells) const;
 		
 		/**
-		* Check if the area around @ref{point} is free, the radiance of the circle is @ref{min_distance}.
-		* @param Point The centre of the circle to check.
-		* @param min_distance The radiance of the circle.
-		* @return True if this point is within @ref{min_distance} of an obstacle, false otherwise.
-		*/
-		bool isBlocked(const geometry_msgs::Point& point, float min_distance) const;
+		 * Determine which of the given cells are visible from the view cell. All the lines of sight are resolved 
+		 * in a single sweep outwards from the view cell: the line of sight of a cell crosses the ring of cells 
+		 * one step closer to the view cell between two neighbours, and the fraction of the line of sight that is 
+		 * unobstructed is interpolated between theirs. A cell is visible if at least half of its line of sight 
+		 * is unobstructed. Each cell is visited once, instead of once for every line of sight through it.
+		 * @param settings The parameters of the view cones.
+		 * @param view_cell The cell that is being viewed from.
+		 * @param cells The cells to check, they must all lie inside the grid.
+		 * @param processed_cells Cells that have been processed are skipped.
+		 * @param visible_cells The cells that are not processed and are visible are added to this list.
+		 */
+		void findVisibleCells(const ViewConeSettings& settings, const occupancy_grid_utils::Cell& view_cell, const std::vector<occupancy_grid_utils::Cell>& cells, const TiledCoverage& processed_cells, std::vector<occupancy_grid_utils::Cell>& visible_cells) const;
 		
 		ros::Publisher rivz_pub_;
+		ros::Publisher diagnostics_pub_;
 		ros::Subscriber navigation_grid_sub_;
-		nav_msgs::OccupancyGrid last_received_occupancy_grid_msgs_;
+		GridSnapshotConstPtr snapshot_;
+		mutable boost::mutex snapshot_mutex_;   // Only guards swapping and copying @ref{snapshot_}.
 		bool has_received_occupancy_grid_;
+		unsigned int nr_threads_;
+		unsigned int seed_;
+		SelectionStrategy strategy_;
+		unsigned int pool_size_;
+		SamplingStrategy sampling_;
+		SamplingStatistics sampling_statistics_;
+		PhaseTimings phase_timings_;
+		boost::shared_ptr<const TiledGrid> tiled_grid_;
+		nav_msgs::OccupancyGrid::ConstPtr tiled_grid_source_; // The occupancy grid @ref{tiled_grid_} summarises.
+		bool incremental_;
+		boost::shared_ptr<const ViewConePlan> previous_plan_;
+		unsigned int nr_yaw_bins_;
+		bool try_all_yaw_bins_;
 	};
 };
 
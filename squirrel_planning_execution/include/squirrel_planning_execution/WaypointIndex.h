@@ -0,0 +1,123 @@
+#ifndef KCL_ROSPLAN_WAYPOINTINDEX_H
+#define KCL_ROSPLAN_WAYPOINTINDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace KCL_rosplan {
+
+	/**
+	 * A uniform grid hash over the positions of named waypoints. Every waypoint is stored in the bucket of the
+	 * square cell that contains it, so waypoints can be added and removed one at a time and a nearest neighbour
+	 * query only visits the rings of cells around the query point until no closer waypoint can be found.
+	 */
+	class WaypointIndex {
+	public:
+		/**
+		 * A waypoint returned by a query.
+		 */
+		struct Neighbour {
+			Neighbour(const std::string& name, double x, double y, double distance)
+				: name_(name), x_(x), y_(y), distance_(distance) {}
+
+			bool operator<(const Neighbour& other) const { return distance_ < other.distance_; }
+
+			std::string name_;
+			double x_, y_;
+			double distance_;   // Distance to the query point in metres.
+		};
+
+		/**
+		 * Constructor.
+		 * @param cell_size The length of the sides of the cells in metres, about the distance between neighbouring
+		 * waypoints works best.
+		 */
+		WaypointIndex(double cell_size = 1.0);
+
+		/**
+		 * Remove all the waypoints and change the size of the cells.
+		 * @param cell_size The length of the sides of the cells in metres.
+		 */
+		void reset(double cell_size);
+
+		/**
+		 * Remove all the waypoints.
+		 */
+		void clear();
+
+		/**
+		 * Add a waypoint, or move it if a waypoint with the same name is already stored.
+		 * @param name The unique name of the waypoint.
+		 * @param x The x coordinate in metres.
+		 * @param y The y coordinate in metres.
+		 */
+		void insert(const std::string& name, double x, double y);
+
+		/**
+		 * Remove a waypoint.
+		 * @param name The name of the waypoint.
+		 * @return True if the waypoint was stored, false otherwise.
+		 */
+		bool remove(const std::string& name);
+
+		/**
+		 * @return The number of waypoints.
+		 */
+		unsigned int size() const { return cell_of_waypoint_.size(); }
+
+		/**
+		 * Find the waypoints nearest to a point.
+		 * @param x The x coordinate of the query point in metres.
+		 * @param y The y coordinate of the query point in metres.
+		 * @param k The maximum number of waypoints to find, 0 for no limit.
+		 * @param radius Only waypoints within this distance are found, 0 for no limit.
+		 * @param neighbours The waypoints that are found, ordered by their distance to the query point.
+		 */
+		void findNearest(double x, double y, unsigned int k, double radius, std::vector<Neighbour>& neighbours) const;
+
+	private:
+
+		/**
+		 * A waypoint stored in a bucket.
+		 */
+		struct Entry {
+			Entry(const std::string& name, double x, double y)
+				: name_(name), x_(x), y_(y) {}
+
+			std::string name_;
+			double x_, y_;
+		};
+
+		/**
+		 * @return The key of the cell at (@ref{cell_x}, @ref{cell_y}).
+		 */
+		static uint64_t getKey(int cell_x, int cell_y) { return ((uint64_t)(uint32_t)cell_x << 32) | (uint32_t)cell_y; }
+
+		/**
+		 * @return The coordinate of the cell that contains the coordinate @ref{v}.
+		 */
+		int getCell(double v) const;
+
+		/**
+		 * Add the waypoints of a cell to the candidates of a query.
+		 * @param cell_x The x coordinate of the cell.
+		 * @param cell_y The y coordinate of the cell.
+		 * @param x The x coordinate of the query point.
+		 * @param y The y coordinate of the query point.
+		 * @param radius Only waypoints within this distance are added, 0 for no limit.
+		 * @param neighbours The candidates.
+		 */
+		void addCandidates(int cell_x, int cell_y, double x, double y, double radius, std::vector<Neighbour>& neighbours) const;
+
+		double cell_size_;
+		std::map<uint64_t, std::vector<Entry> > buckets_;
+		std::map<std::string, uint64_t> cell_of_waypoint_;
+
+		// The cells that contain waypoints lie within these bounds, they are not shrunk when waypoints are removed.
+		int min_cell_x_, min_cell_y_, max_cell_x_, max_cell_y_;
+	};
+};
+
+#endif
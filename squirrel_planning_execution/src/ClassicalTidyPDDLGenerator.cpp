@@ -1,5 +1,4 @@
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -10,13 +9,13 @@
 #include <ros/ros.h>
 
 #include "squirrel_planning_execution/ClassicalTidyPDDLGenerator.h"
+#include "squirrel_planning_execution/PDDLWriter.h"
 
 namespace KCL_rosplan {
 
 void ClassicalTidyPDDLGenerator::generateProblemFile(const std::string& file_name, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_to_location_mapping, const std::map<std::string, std::vector<std::string > >& grasping_location_mapping, const std::map<std::string, std::vector<std::string > >& pushing_location_mapping, const std::map<std::string, std::string>& object_to_type_mapping, const std::map<std::string, std::string>& box_to_location_mapping, const std::map<std::string, std::string>& box_to_type_mapping, const std::map<std::string, std::vector<std::string> >& near_box_location_mapping)
 {
-	std::ofstream myfile;
-	myfile.open(file_name.c_str());
+	PDDLWriter myfile;
 	myfile << "(define (problem Keys-0)" << std::endl;
 	myfile << "(:domain find_key)" << std::endl;
 	myfile << "(:objects" << std::endl;
@@ -89,11 +88,11 @@ void ClassicalTidyPDDLGenerator::generateProblemFile(const std::string& file_nam
 	myfile << "(gripper_empty kenny)" << std::endl;
 	for (std::map<std::string, std::string>::const_iterator ci = object_to_location_mapping.begin(); ci != object_to_location_mapping.end(); ++ci)
 	{
-		myfile << "(object_at " << (*ci).first << " " << (*ci).second << ")" << std::endl;
+		myfile.fact(0, "object_at", (*ci).first, (*ci).second);
 	}
 	for (std::map<std::string, std::string>::const_iterator ci = box_to_location_mapping.begin(); ci != box_to_location_mapping.end(); ++ci)
 	{
-		myfile << "(box_at " << (*ci).first << " " << (*ci).second << ")" << std::endl;
+		myfile.fact(0, "box_at", (*ci).first, (*ci).second);
 	}
 	for (std::map<std::string, std::vector<std::string> >::const_iterator ci = grasping_location_mapping.begin(); ci != grasping_location_mapping.end(); ++ci)
 	{
@@ -101,7 +100,7 @@ void ClassicalTidyPDDLGenerator::generateProblemFile(const std::string& file_nam
 		const std::vector<std::string>& near_locations = (*ci).second;
 		for (std::vector<std::string>::const_iterator ci = near_locations.begin(); ci != near_locations.end(); ++ci)
 		{
-			myfile << "(near_for_grasping " << (*ci) << " " << near_loc << ")" << std::endl;
+			myfile.fact(0, "near_for_grasping", (*ci), near_loc);
 		}
 	}
 	for (std::map<std::string, std::vector<std::string> >::const_iterator ci = pushing_location_mapping.begin(); ci != pushing_location_mapping.end(); ++ci)
@@ -110,7 +109,7 @@ void ClassicalTidyPDDLGenerator::generateProblemFile(const std::string& file_nam
 		const std::vector<std::string>& near_locations = (*ci).second;
 		for (std::vector<std::string>::const_iterator ci = near_locations.begin(); ci != near_locations.end(); ++ci)
 		{
-			myfile << "(near_for_pushing " << (*ci) << " " << near_loc << ")" << std::endl;
+			myfile.fact(0, "near_for_pushing", (*ci), near_loc);
 		}
 	}
 	
@@ -120,13 +119,13 @@ void ClassicalTidyPDDLGenerator::generateProblemFile(const std::string& file_nam
 		const std::vector<std::string>& near_locations = (*ci).second;
 		for (std::vector<std::string>::const_iterator ci = near_locations.begin(); ci != near_locations.end(); ++ci)
 		{
-			myfile << "(near_for_grasping " << (*ci) << " " << near_loc << ")" << std::endl;
+			myfile.fact(0, "near_for_grasping", (*ci), near_loc);
 		}
 	}
 	
 	for (std::map<std::string, std::string>::const_iterator ci = box_to_type_mapping.begin(); ci != box_to_type_mapping.end(); ++ci)
 	{
-		myfile << "(can_fit_inside " << (*ci).second << " " << (*ci).first << ")" << std::endl;
+		myfile.fact(0, "can_fit_inside", (*ci).second, (*ci).first);
 		
 		myfile << "\t(can_push kenny " << (*ci).second << ")" << std::endl;
 		
@@ -135,24 +134,24 @@ void ClassicalTidyPDDLGenerator::generateProblemFile(const std::string& file_nam
 	
 	for (std::map<std::string, std::string>::const_iterator ci = object_to_type_mapping.begin(); ci != object_to_type_mapping.end(); ++ci)
 	{
-		myfile << "(is_of_type " << (*ci).first << " " << (*ci).second << ")" << std::endl;
+		myfile.fact(0, "is_of_type", (*ci).first, (*ci).second);
 	}
 	myfile << ")" << std::endl;
 	myfile << "(:goal (and" << std::endl;
 	for (std::map<std::string, std::string>::const_iterator ci = object_to_location_mapping.begin(); ci != object_to_location_mapping.end(); ++ci)
 	{
-		myfile << "(tidy " << (*ci).first << ")" << std::endl;
+		myfile.fact(0, "tidy", (*ci).first);
 	}
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
-	myfile.close();
+	if (!myfile.writeToFile(file_name))
+		ROS_ERROR("KCL: (ClassicalTidyPDDLGenerator) Could not write %s.", file_name.c_str());
 }
 
 void ClassicalTidyPDDLGenerator::generateDomainFile(const std::string& file_name, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_to_location_mapping, const std::map<std::string, std::vector<std::string > >& grasping_location_mapping, const std::map<std::string, std::vector<std::string > >& pushing_location_mapping, const std::map<std::string, std::string>& object_to_type_mapping, const std::map<std::string, std::string>& box_to_location_mapping, const std::map<std::string, std::string>& box_to_type_mapping, const std::map<std::string, std::vector<std::string> >& near_box_location_mapping)
 {
-	std::ofstream myfile;
-	myfile.open (file_name.c_str());
+	PDDLWriter myfile;
 	myfile << "(define (domain find_key)" << std::endl;
 	myfile << "(:requirements :typing :conditional-effects :negative-preconditions :disjunctive-preconditions)" << std::endl;
 	myfile << std::endl;
@@ -184,8 +183,8 @@ void ClassicalTidyPDDLGenerator::generateDomainFile(const std::string& file_name
 	/**
 	 * Put object in a box.
 	 */
-	myfile << "(:action put_object_in_box" << std::endl;
-	myfile << "\t:parameters (?v - robot ?wp ?near_wp - waypoint ?o1 - object ?b - box ?t - type)" << std::endl;
+	myfile.beginAction("put_object_in_box");
+	myfile.parameters("?v - robot ?wp ?near_wp - waypoint ?o1 - object ?b - box ?t - type");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(box_at ?b ?wp)" << std::endl;
 	myfile << "\t\t(robot_at ?v ?near_wp)" << std::endl;
@@ -210,8 +209,8 @@ void ClassicalTidyPDDLGenerator::generateDomainFile(const std::string& file_name
 	/**
 	 * PICK-UP OBJECT.
 	 */
-	myfile << "(:action pickup_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?wp ?near_wp - waypoint ?o - object ?t - type)" << std::endl;
+	myfile.beginAction("pickup_object");
+	myfile.parameters("?v - robot ?wp ?near_wp - waypoint ?o - object ?t - type");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(robot_at ?v ?near_wp)" << std::endl;
 	myfile << "\t\t(object_at ?o ?wp)" << std::endl;
@@ -237,8 +236,8 @@ void ClassicalTidyPDDLGenerator::generateDomainFile(const std::string& file_name
 	/**
 	 * PUT-DOWN OBJECT.
 	 */
-	myfile << "(:action putdown_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?wp ?near_wp - waypoint ?o - object)" << std::endl;
+	myfile.beginAction("putdown_object");
+	myfile.parameters("?v - robot ?wp ?near_wp - waypoint ?o - object");
 	myfile << "\t:precondition (and" << std::endl;
 
 	myfile << "\t\t(robot_at ?v ?near_wp)" << std::endl;
@@ -264,8 +263,8 @@ void ClassicalTidyPDDLGenerator::generateDomainFile(const std::string& file_name
 	/**
 	 * GOTO WAYPOINT.
 	 */
-	myfile << "(:action goto_waypoint" << std::endl;
-	myfile << "\t:parameters (?v - robot ?from ?to - waypoint)" << std::endl;
+	myfile.beginAction("goto_waypoint");
+	myfile.parameters("?v - robot ?from ?to - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 
 	myfile << "\t\t(robot_at ?v ?from)" << std::endl;
@@ -286,8 +285,8 @@ void ClassicalTidyPDDLGenerator::generateDomainFile(const std::string& file_name
 	/**
 	 * PUSH OBJECT.
 	 */
-	myfile << "(:action push_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?ob - object ?t - type ?from ?to ?near_wp - waypoint)" << std::endl;
+	myfile.beginAction("push_object");
+	myfile.parameters("?v - robot ?ob - object ?t - type ?from ?to ?near_wp - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(robot_at ?v ?near_wp)" << std::endl;
 	myfile << "\t\t(object_at ?ob ?from)" << std::endl;
@@ -308,8 +307,8 @@ void ClassicalTidyPDDLGenerator::generateDomainFile(const std::string& file_name
 	/**
 	 * TIDY OBJECT.
 	 */
-	myfile << "(:action tidy_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?o - object ?b - box ?t - type)" << std::endl;
+	myfile.beginAction("tidy_object");
+	myfile.parameters("?v - robot ?o - object ?b - box ?t - type");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(is_of_type ?o ?t)" << std::endl;
 	myfile << "\t\t(inside ?o ?b)" << std::endl;
@@ -330,7 +329,8 @@ void ClassicalTidyPDDLGenerator::generateDomainFile(const std::string& file_name
 	
 	
 	myfile << ")" << std::endl;
-	myfile.close();
+	if (!myfile.writeToFile(file_name))
+		ROS_ERROR("KCL: (ClassicalTidyPDDLGenerator) Could not write %s.", file_name.c_str());
 }
 
 void ClassicalTidyPDDLGenerator::createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_to_location_mapping, const std::map<std::string, std::vector<std::string > >& grasping_location_mapping, const std::map<std::string, std::vector<std::string > >& pushing_location_mapping, const std::map<std::string, std::string>& object_to_type_mapping, const std::map<std::string, std::string>& box_to_location_mapping, const std::map<std::string, std::string>& box_to_type_mapping, const std::map<std::string, std::vector<std::string> >& near_box_location_mapping)
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -10,10 +9,12 @@
 #include <ros/ros.h>
 
 #include "squirrel_planning_execution/ContingentStrategicClassifyPDDLGenerator.h"
+#include "squirrel_planning_execution/PDDLWriter.h"
+#include "squirrel_planning_execution/ModelArena.h"
 
 namespace KCL_rosplan {
 
-void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_base, const Location& robot_location, const std::vector<Location*>& locations, const std::vector<Object*>& objects, unsigned int max_classification_attemps)
+void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_base, const Location& robot_location, const std::vector<Location*>& locations, const LocationGraph& connectivity, const std::vector<Object*>& objects, unsigned int max_classification_attemps)
 {
 	std::vector<const State*> states;
 	for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_base.begin(); ci != knowledge_base.end(); ++ci)
@@ -26,8 +27,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::st
 		}
 	}
 	
-	std::ofstream myfile;
-	myfile.open(file_name.c_str());
+	PDDLWriter myfile;
 	myfile << "(define (problem squirrel)" << std::endl;
 	myfile << "(:domain classify_objects)" << std::endl;
 	myfile << std::endl;
@@ -43,7 +43,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::st
 		myfile << "\t(plus c" << i << " c" << (i + 1) << ")" << std::endl;
 	}
 	
-	myfile << "\t(current_kb " << current_knowledge_base.name_ << ")" << std::endl;
+	myfile.fact(1, "current_kb", current_knowledge_base.name_);
 	
 	const Location* clear_location = NULL;
 	for (std::vector<Location*>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci)
@@ -59,7 +59,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::st
 	{
 		const State* state = *ci;
 		//myfile << "\t(part-of " << state->state_name_ << " " << current_knowledge_base.name_ << ")" << std::endl;
-		myfile << "\t(m " << state->state_name_ << ")" << std::endl;
+		myfile.fact(1, "m", state->state_name_);
 		myfile << "\t(robot_at robot " << robot_location.name_ << " " << state->state_name_ << ")" << std::endl;
 		myfile << "\t(gripper_empty robot " << " " << state->state_name_ << ")" << std::endl;
 		
@@ -67,31 +67,31 @@ void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::st
 		for (std::vector<Object*>::const_iterator ci = objects.begin(); ci != objects.end(); ++ci)
 		{
 			const Object* object = *ci;
-			myfile << "\t(object_at " << object->name_ << " " << object->location_->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(1, "object_at", object->name_, object->location_->name_, state->state_name_);
 			//myfile << "\t(remaining_examination_attempts " << object->name_ << " c" << max_counter << " " << state->state_name_ << ")" << std::endl;
 		}
 	}
 	
-	for (std::vector<Location*>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci)
+	for (unsigned int from = 0; from < locations.size(); ++from)
 	{
-		const Location* location = *ci;
-		for (std::vector<const Location*>::const_iterator ci = location->connected_locations_.begin(); ci != location->connected_locations_.end(); ++ci)
+		const Location* location = locations[from];
+		for (unsigned int i = connectivity.begin(from); i != connectivity.end(from); ++i)
 		{
-			const Location* location2 = *ci;
+			const Location* location2 = locations[connectivity.getTarget(from, i)];
 			if (location == location2) continue;
-			myfile << "\t(connected " << location->name_ << " " << location2->name_ << ")" << std::endl;
+			myfile.fact(1, "connected", location->name_, location2->name_);
 		}
 		
 		for (std::vector<const Location*>::const_iterator ci = location->near_locations_.begin(); ci != location->near_locations_.end(); ++ci)
 		{
 			const Location* location2 = *ci;
 			if (location == location2) continue;
-			myfile << "\t(near " << location->name_ << " " << location2->name_ << ")" << std::endl;
+			myfile.fact(1, "near", location->name_, location2->name_);
 		}
 		
 		if (location->is_clear_)
 		{
-			myfile << "\t(clear_area " << location->name_ << ")" << std::endl;
+			myfile.fact(1, "clear_area", location->name_);
 		}
 	}
 	
@@ -102,7 +102,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::st
 		for (std::vector<const State*>::const_iterator ci = knowledge_base->states_.begin(); ci != knowledge_base->states_.end(); ++ci)
 		{
 			const State* state = *ci;
-			myfile << "\t(part-of " << state->state_name_ << " " << knowledge_base->name_ << ")" << std::endl;
+			myfile.fact(1, "part-of", state->state_name_, knowledge_base->name_);
 			
 			for (std::map<const Object*, unsigned int>::const_iterator ci = state->classifiable_at_attempt_.begin(); ci != state->classifiable_at_attempt_.end(); ++ci)
 			{
@@ -111,13 +111,13 @@ void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::st
 				
 				myfile << "\t(classifiable_on_attempt " << object->name_ << " c" << classiable_on_attempt << " " << state->state_name_ << ")" << std::endl;
 				myfile << "\t(current_counter " << object->name_ << " c0 " << state->state_name_ << ")" << std::endl;
-				myfile << "\t(contains " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(1, "contains", object->name_, state->state_name_);
 			}
 		}
 		
 		for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_base->children_.begin(); ci != knowledge_base->children_.end(); ++ci)
 		{
-			myfile << "\t(parent " << knowledge_base->name_ << " " << (*ci)->name_ << ")" << std::endl;
+			myfile.fact(1, "parent", knowledge_base->name_, (*ci)->name_);
 		}
 	}
 	myfile << ")" << std::endl;
@@ -127,13 +127,14 @@ void ContingentStrategicClassifyPDDLGenerator::generateProblemFile(const std::st
 		const Object* object = *ci;
 		for (std::vector<const State*>::const_iterator ci = current_knowledge_base.states_.begin(); ci != current_knowledge_base.states_.end(); ++ci)
 		{
-			myfile << "\t(classified " << object->name_ << " " << (*ci)->state_name_ << ")" << std::endl;
+			myfile.fact(1, "classified", object->name_, (*ci)->state_name_);
 		}
 	}
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
-	myfile.close();
+	if (!myfile.writeToFile(file_name))
+		ROS_ERROR("KCL: (ContingentStrategicClassifyPDDLGenerator) Could not write %s.", file_name.c_str());
 }
 
 void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_bases, const Location& robot_location, const std::vector<Location*>& locations, const std::vector<Object*>& objects, unsigned int max_classification_attemps)
@@ -149,8 +150,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 		}
 	}
 	
-	std::ofstream myfile;
-	myfile.open (file_name.c_str());
+	PDDLWriter myfile;
 	myfile << "(define (domain classify_objects)" << std::endl;
 	myfile << "(:requirements :typing :conditional-effects :negative-preconditions :disjunctive-preconditions)" << std::endl;
 	myfile << std::endl;
@@ -250,8 +250,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	/**
 	 * PICK-UP OBJECT.
 	 *
-	myfile << "(:action pickup_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?wp - waypoint ?o - object)" << std::endl;
+	myfile.beginAction("pickup_object");
+	myfile.parameters("?v - robot ?wp - waypoint ?o - object");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_bases.begin(); ci != knowledge_bases.end(); ++ci)
@@ -292,8 +292,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	**
 	 * PUT-DOWN OBJECT.
 	 *
-	myfile << "(:action putdown_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?wp - waypoint ?o - object)" << std::endl;
+	myfile.beginAction("putdown_object");
+	myfile.parameters("?v - robot ?wp - waypoint ?o - object");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_bases.begin(); ci != knowledge_bases.end(); ++ci)
@@ -331,8 +331,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	/**
 	 * GOTO WAYPOINT.
 	 */
-	myfile << "(:action goto_waypoint" << std::endl;
-	myfile << "\t:parameters (?v - robot ?from ?to - waypoint)" << std::endl;
+	myfile.beginAction("goto_waypoint");
+	myfile.parameters("?v - robot ?from ?to - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(connected ?from ?to)" << std::endl;
 	
@@ -370,8 +370,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	/**
 	 * PUSH OBJECT.
 	 */
-	myfile << "(:action push_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?ob - object ?from ?to ?near_from - waypoint)" << std::endl;
+	myfile.beginAction("push_object");
+	myfile.parameters("?v - robot ?ob - object ?from ?to ?near_from - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(connected ?from ?to)" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -414,8 +414,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	/**
 	 * CLEAR OBJECT
 	 */
-	myfile << "(:action clear_object" << std::endl;
-	myfile << "\t:parameters (?ob - object ?w - waypoint)" << std::endl;
+	myfile.beginAction("clear_object");
+	myfile.parameters("?ob - object ?w - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(clear_area ?w)" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -455,9 +455,9 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	 * Abstract classify action.
 	 */
 	myfile << ";; Attempt to classify the object." << std::endl;
-	myfile << "(:action observe-classifiable_on_attempt" << std::endl;
+	myfile.beginAction("observe-classifiable_on_attempt");
 
-	myfile << "\t:parameters (?o - object ?c - counter ?v - robot ?from - waypoint ?c2 - counter ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
+	myfile.parameters("?o - object ?c - counter ?v - robot ?from - waypoint ?c2 - counter ?l ?l2 - level ?kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(next ?l ?l2)" << std::endl;
@@ -511,8 +511,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	 * when this happens we stop our attempts to classify the object. Later on we might decide to learn about this object, for now 
 	 * we just stop.
 	 */
-	myfile << "(:action finalise_classification_success" << std::endl;
-	myfile << "\t:parameters (?ob - object ?c - counter ?w - waypoint)" << std::endl;
+	myfile.beginAction("finalise_classification_success");
+	myfile.parameters("?ob - object ?c - counter ?w - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (= ?c c" << max_classification_attemps << " ))" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -550,8 +550,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	 * when this happens we stop our attempts to classify the object. Later on we might decide to learn about this object, for now 
 	 * we just stop.
 	 */
-	myfile << "(:action finalise_classification_fail" << std::endl;
-	myfile << "\t:parameters (?ob - object ?w - waypoint)" << std::endl;
+	myfile.beginAction("finalise_classification_fail");
+	myfile.parameters("?ob - object ?w - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	
@@ -587,8 +587,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	 * POP action.
 	 */
 	myfile << ";; Exit the current branch." << std::endl;
-	myfile << "(:action pop" << std::endl;
-	myfile << "\t:parameters (?l ?l2 - level ?o - object)" << std::endl;
+	myfile.beginAction("pop");
+	myfile.parameters("?l ?l2 - level ?o - object");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(lev ?l)" << std::endl;
 	myfile << "\t\t(next ?l2 ?l)" << std::endl;
@@ -619,7 +619,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 		myfile << "\t\t)" << std::endl;
 		myfile << "\t\t(when (stack " << (*ci)->state_name_ << " ?l2)" << std::endl;
 		myfile << "\t\t\t(and " << std::endl;
-		myfile << "\t\t\t\t(m " << (*ci)->state_name_ << ")" << std::endl;
+		myfile.fact(4, "m", (*ci)->state_name_);
 		myfile << "\t\t\t\t(not (stack " << (*ci)->state_name_ << " ?l2))" << std::endl;
 		myfile << "\t\t\t)" << std::endl;
 		myfile << "\t\t)" << std::endl;
@@ -630,8 +630,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	myfile << std::endl;
 
 	myfile << ";; Resolve the axioms manually." << std::endl;
-	myfile << "(:action ramificate" << std::endl;
-	myfile << "\t:parameters ()" << std::endl;
+	myfile.beginAction("ramificate");
+	myfile.parameters("");
 	myfile << "\t:precondition (resolve-axioms)" << std::endl;
 	myfile << "\t:effect (and " << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -673,7 +673,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (or (cleared " << object->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-			myfile << "\t\t\t(Rcleared " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(3, "Rcleared", object->name_, state->state_name_);
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (and (not (cleared " << object->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -681,7 +681,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (or (classified " << object->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-			myfile << "\t\t\t(Rclassified " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(3, "Rclassified", object->name_, state->state_name_);
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (and (not (classified " << object->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -704,7 +704,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 				const Location* location = *ci;
 				
 				myfile << "\t\t(when (or (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Robject_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Robject_at", object->name_, location->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -728,8 +728,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	myfile << ")" << std::endl;
 	
 	myfile << ";; Move 'down' into the knowledge base." << std::endl;
-	myfile << "(:action assume_knowledge" << std::endl;
-	myfile << "\t:parameters (?old_kb ?new_kb - knowledgebase)" << std::endl;
+	myfile.beginAction("assume_knowledge");
+	myfile.parameters("?old_kb ?new_kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(current_kb ?old_kb)" << std::endl;
@@ -789,8 +789,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 				myfile << "\t\t\t(and " << std::endl;
 				myfile << "\t\t\t\t(not (Rcleared " << object->name_ << " " << state->state_name_ << "))" << std::endl;
 				myfile << "\t\t\t\t(not (cleared " << object->name_ << " " << state->state_name_ << "))" << std::endl;
-				myfile << "\t\t\t\t(Rcleared " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
-				myfile << "\t\t\t\t(cleared " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(4, "Rcleared", object->name_, state2->state_name_);
+				myfile.fact(4, "cleared", object->name_, state2->state_name_);
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
 				
@@ -798,8 +798,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 				myfile << "\t\t\t(and " << std::endl;
 				myfile << "\t\t\t\t(not (Rclassified " << object->name_ << " " << state->state_name_ << "))" << std::endl;
 				myfile << "\t\t\t\t(not (classified " << object->name_ << " " << state->state_name_ << "))" << std::endl;
-				myfile << "\t\t\t\t(Rclassified " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
-				myfile << "\t\t\t\t(classified " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(4, "Rclassified", object->name_, state2->state_name_);
+				myfile.fact(4, "classified", object->name_, state2->state_name_);
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
 				
@@ -836,8 +836,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Robject_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Robject_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Robject_at", object->name_, location->name_, state2->state_name_);
+					myfile.fact(4, "object_at", object->name_, location->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 				}
@@ -848,8 +848,8 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	myfile << ")" << std::endl;
 
 	myfile << ";; Move 'up' into the knowledge base." << std::endl;;
-	myfile << "(:action shed_knowledge" << std::endl;
-	myfile << "\t:parameters (?old_kb ?new_kb - knowledgebase)" << std::endl;
+	myfile.beginAction("shed_knowledge");
+	myfile.parameters("?old_kb ?new_kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(current_kb ?old_kb)" << std::endl;
@@ -894,7 +894,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 			// Make sure the state of the toilets are the same.
 			myfile << "\t\t\t(or " << std::endl;
 			myfile << "\t\t\t\t(not (part-of " << state->state_name_ << " ?old_kb))" << std::endl;
-			myfile << "\t\t\t\t(classified " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(4, "classified", object->name_, state->state_name_);
 			myfile << "\t\t\t\t(not (contains " << object->name_ << " " << state->state_name_ << "))" << std::endl;
 			myfile << "\t\t\t)" << std::endl;
 		}
@@ -997,7 +997,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t\t(classified " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(6, "classified", object->name_, state2->state_name_);
 				myfile << "\t\t\t\t\t)" << std::endl;
 				
 			}
@@ -1011,7 +1011,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t(not (classified " << object->name_ << " " << state2->state_name_ << "))" << std::endl;
 			}
-			myfile << "\t\t\t\t(classified " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(4, "classified", object->name_, state->state_name_);
 			myfile << "\t\t\t)" << std::endl;
 			myfile << "\t\t)" << std::endl;
 			
@@ -1024,7 +1024,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t\t(cleared " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(6, "cleared", object->name_, state2->state_name_);
 				myfile << "\t\t\t\t\t)" << std::endl;
 				
 			}
@@ -1038,7 +1038,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t(not (cleared " << object->name_ << " " << state2->state_name_ << "))" << std::endl;
 			}
-			myfile << "\t\t\t\t(cleared " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(4, "cleared", object->name_, state->state_name_);
 			myfile << "\t\t\t)" << std::endl;
 			myfile << "\t\t)" << std::endl;
 			
@@ -1126,7 +1126,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 					myfile << "\t\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t\t(or " << std::endl;
 					myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-					myfile << "\t\t\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(6, "object_at", object->name_, location->name_, state2->state_name_);
 					myfile << "\t\t\t\t\t)" << std::endl;
 					myfile << "\t\t\t\t)" << std::endl;
 				}
@@ -1141,7 +1141,7 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 					const State* state2 = *ci;
 					myfile << "\t\t\t\t(not (object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << "))" << std::endl;
 				}
-				myfile << "\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(4, "object_at", object->name_, location->name_, state->state_name_);
 				
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
@@ -1152,11 +1152,15 @@ void ContingentStrategicClassifyPDDLGenerator::generateDomainFile(const std::str
 	myfile << "\t)" << std::endl;
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
-	myfile.close();
+	if (!myfile.writeToFile(file_name))
+		ROS_ERROR("KCL: (ContingentStrategicClassifyPDDLGenerator) Could not write %s.", file_name.c_str());
 }
 
-void ContingentStrategicClassifyPDDLGenerator::createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_location_predicates, const std::map<std::string, std::vector<std::string> >& near_waypoint_mapping, unsigned int max_classification_attemps)
+void ContingentStrategicClassifyPDDLGenerator::createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_location_predicates, const std::map<std::string, std::vector<std::string> >& near_waypoint_mapping, unsigned int max_classification_attemps, const std::vector<std::pair<std::string, std::string> >& connections)
 {
+	// The model only lives for this call, it is released in one go when the arena goes out of scope.
+	ModelArena arena;
+	
 	std::vector<Location*> locations;
 	std::vector<Object*> objects;
 	std::map<std::string, Object*> predicate_to_object_mapping;
@@ -1167,8 +1171,8 @@ void ContingentStrategicClassifyPDDLGenerator::createPDDL(const std::string& pat
 		const std::string& object_predicate = (*ci).first;
 		const std::string& location_predicate = (*ci).second;
 		
-		Location* object_location = new Location(location_predicate, true);
-		Object* object = new Object(object_predicate, *object_location);
+		Location* object_location = arena.create<Location>(arena.intern(location_predicate), true);
+		Object* object = arena.create<Object>(arena.intern(object_predicate), *object_location);
 		
 		locations.push_back(object_location);
 		objects.push_back(object);
@@ -1183,34 +1187,31 @@ void ContingentStrategicClassifyPDDLGenerator::createPDDL(const std::string& pat
 			for (std::vector<std::string>::const_iterator ci = near_waypoints.begin(); ci != near_waypoints.end(); ++ci)
 			{
 				const std::string& near_location_predicate = *ci;
-				Location* near_location = new Location(near_location_predicate, false);
+				Location* near_location = arena.create<Location>(arena.intern(near_location_predicate), false);
 				locations.push_back(near_location);
 				near_location->near_locations_.push_back(object_location);
 			}
 		}
 	}
 	
-	Location* robot_location = new Location(robot_location_predicate, false);
+	Location* robot_location = arena.create<Location>(arena.intern(robot_location_predicate), false);
 	locations.push_back(robot_location);
 	
-	// Make all locations fully connected.
+	// Connect the locations along the roadmap, or all of them if there is no roadmap.
+	std::vector<std::string> location_names;
 	for (std::vector<Location*>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci)
 	{
-		Location* location = *ci;
-		for (std::vector<Location*>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci)
-		{
-			Location* other_location = *ci;
-			location->connected_locations_.push_back(other_location);
-			other_location->connected_locations_.push_back(location);
-		}
+		location_names.push_back((*ci)->name_);
 	}
+	LocationGraph connectivity;
+	connectivity.setEdges(location_names, connections);
 	std::stringstream ss;
 
 	std::vector<const KnowledgeBase*> knowledge_bases;
 	std::map<const Object*, unsigned int> empty_classifiable_when;
-	State basic_state("basic", empty_classifiable_when);
+	State basic_state(arena.intern("basic"), empty_classifiable_when);
 	
-	KnowledgeBase basis_kb("basis_kb");
+	KnowledgeBase basis_kb(arena.intern("basis_kb"));
 	basis_kb.addState(basic_state);
 	knowledge_bases.push_back(&basis_kb);
 	
@@ -1223,7 +1224,7 @@ void ContingentStrategicClassifyPDDLGenerator::createPDDL(const std::string& pat
 		ss.str(std::string());
 		ss << "kb_" << object->name_;
 		
-		KnowledgeBase* kb_location = new KnowledgeBase(ss.str());
+		KnowledgeBase* kb_location = arena.create<KnowledgeBase>(arena.intern(ss.str()));
 		basis_kb.addChild(*kb_location);
 		knowledge_bases.push_back(kb_location);
 		
@@ -1235,7 +1236,7 @@ void ContingentStrategicClassifyPDDLGenerator::createPDDL(const std::string& pat
 			
 			ss.str(std::string());
 			ss << "s" << state_id;
-			State* state_pickupable = new State(ss.str(), classifiable_counter);
+			State* state_pickupable = arena.create<State>(arena.intern(ss.str()), classifiable_counter);
 			kb_location->addState(*state_pickupable);
 			++state_id;
 		}
@@ -1248,7 +1249,7 @@ void ContingentStrategicClassifyPDDLGenerator::createPDDL(const std::string& pat
 	ss.str(std::string());
 	ss << path  << problem_file;
 	ROS_INFO("KCL: (ContingentStrategicClassifyPDDLGenerator) Generate problem... %s", ss.str().c_str());
-	generateProblemFile(ss.str(), basis_kb, knowledge_bases, *robot_location, locations, objects, max_classification_attemps);
+	generateProblemFile(ss.str(), basis_kb, knowledge_bases, *robot_location, locations, connectivity, objects, max_classification_attemps);
 }
 
 };
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -10,10 +9,12 @@
 #include <ros/ros.h>
 
 #include "squirrel_planning_execution/ContingentTacticalClassifyPDDLGenerator.h"
+#include "squirrel_planning_execution/PDDLWriter.h"
+#include "squirrel_planning_execution/ModelArena.h"
 
 namespace KCL_rosplan {
 
-void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_base, const Location& robot_location, const std::vector<Location*>& locations, const std::vector<Object*>& objects)
+void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_base, const Location& robot_location, const std::vector<Location*>& locations, const LocationGraph& connectivity, const std::vector<Object*>& objects)
 {
 	std::vector<const State*> states;
 	for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_base.begin(); ci != knowledge_base.end(); ++ci)
@@ -26,8 +27,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::str
 		}
 	}
 	
-	std::ofstream myfile;
-	myfile.open(file_name.c_str());
+	PDDLWriter myfile;
 	myfile << "(define (problem squirrel)" << std::endl;
 	myfile << "(:domain classify_objects)" << std::endl;
 	myfile << "(:objects" << std::endl;
@@ -44,13 +44,13 @@ void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::str
 	myfile << "\t(next l0 l1)" << std::endl;
 	myfile << "\t(next l1 l2)" << std::endl;
 	
-	myfile << "\t(current_kb " << current_knowledge_base.name_ << ")" << std::endl;
+	myfile.fact(1, "current_kb", current_knowledge_base.name_);
 	
 	for (std::vector<const State*>::const_iterator ci = current_knowledge_base.states_.begin(); ci != current_knowledge_base.states_.end(); ++ci)
 	{
 		const State* state = *ci;
-		myfile << "\t(part-of " << state->state_name_ << " " << current_knowledge_base.name_ << ")" << std::endl;
-		myfile << "\t(m " << state->state_name_ << ")" << std::endl;
+		myfile.fact(1, "part-of", state->state_name_, current_knowledge_base.name_);
+		myfile.fact(1, "m", state->state_name_);
 		myfile << "\t(robot_at robot " << robot_location.name_ << " " << state->state_name_ << ")" << std::endl;
 		//myfile << "\t(gripper_empty robot " << " " << state->state_name_ << ")" << std::endl;
 		
@@ -59,7 +59,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::str
 		{
 			const Object* object = *ci;
 			//myfile << "\t(cleared " << object->name_ << " " << state->state_name_ << ")" << std::endl;
-			myfile << "\t(object_at " << object->name_ << " " << object->location_->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(1, "object_at", object->name_, object->location_->name_, state->state_name_);
 			/*
 			for (std::vector<const Location*>::const_iterator ci = object->observable_locations_.begin(); ci != object->observable_locations_.end() - 1; ++ci)
 			{
@@ -70,19 +70,19 @@ void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::str
 		}
 	}
 	
-	for (std::vector<Location*>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci)
+	for (unsigned int from = 0; from < locations.size(); ++from)
 	{
-		const Location* location = *ci;
-		for (std::vector<const Location*>::const_iterator ci = location->connected_locations_.begin(); ci != location->connected_locations_.end(); ++ci)
+		const Location* location = locations[from];
+		for (unsigned int i = connectivity.begin(from); i != connectivity.end(from); ++i)
 		{
-			const Location* location2 = *ci;
+			const Location* location2 = locations[connectivity.getTarget(from, i)];
 			if (location == location2) continue;
-			myfile << "\t(connected " << location->name_ << " " << location2->name_ << ")" << std::endl;
+			myfile.fact(1, "connected", location->name_, location2->name_);
 		}
 		/*
 		if (location->is_clear_)
 		{
-			myfile << "\t(clear_area " << location->name_ << ")" << std::endl;
+			myfile.fact(1, "clear_area", location->name_);
 		}
 		*/
 	}
@@ -94,7 +94,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::str
 		for (std::vector<const State*>::const_iterator ci = knowledge_base->states_.begin(); ci != knowledge_base->states_.end(); ++ci)
 		{
 			const State* state = *ci;
-			myfile << "\t(part-of " << state->state_name_ << " " << knowledge_base->name_ << ")" << std::endl;
+			myfile.fact(1, "part-of", state->state_name_, knowledge_base->name_);
 			
 			for (std::map<const Object*, const Location*>::const_iterator ci = state->classifiable_from_.begin(); ci != state->classifiable_from_.end(); ++ci)
 			{
@@ -114,7 +114,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::str
 		
 		for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_base->children_.begin(); ci != knowledge_base->children_.end(); ++ci)
 		{
-			myfile << "\t(parent " << knowledge_base->name_ << " " << (*ci)->name_ << ")" << std::endl;
+			myfile.fact(1, "parent", knowledge_base->name_, (*ci)->name_);
 		}
 	}
 	myfile << ")" << std::endl;
@@ -124,13 +124,14 @@ void ContingentTacticalClassifyPDDLGenerator::generateProblemFile(const std::str
 		const Object* object = *ci;
 		for (std::vector<const State*>::const_iterator ci = current_knowledge_base.states_.begin(); ci != current_knowledge_base.states_.end(); ++ci)
 		{
-			myfile << "\t(classified " << object->name_ << " " << (*ci)->state_name_ << ")" << std::endl;
+			myfile.fact(1, "classified", object->name_, (*ci)->state_name_);
 		}
 	}
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
-	myfile.close();
+	if (!myfile.writeToFile(file_name))
+		ROS_ERROR("KCL: (ContingentTacticalClassifyPDDLGenerator) Could not write %s.", file_name.c_str());
 }
 
 void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_bases, const Location& robot_location, const std::vector<Location*>& locations, const std::vector<Object*>& objects)
@@ -146,8 +147,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 		}
 	}
 	
-	std::ofstream myfile;
-	myfile.open (file_name.c_str());
+	PDDLWriter myfile;
 	myfile << "(define (domain classify_objects)" << std::endl;
 	myfile << "(:requirements :typing :conditional-effects :negative-preconditions :disjunctive-preconditions)" << std::endl;
 	myfile << std::endl;
@@ -233,8 +233,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	/**
 	 * GOTO WAYPOINT.
 	 */
-	myfile << "(:action goto_waypoint" << std::endl;
-	myfile << "\t:parameters (?v - robot ?from ?to - waypoint)" << std::endl;
+	myfile.beginAction("goto_waypoint");
+	myfile.parameters("?v - robot ?from ?to - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(connected ?from ?to)" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -277,9 +277,9 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	 * Classify sension action.
 	 */
 	myfile << ";; Attempt to classify the object." << std::endl;
-	myfile << "(:action observe-classifiable_from" << std::endl;
+	myfile.beginAction("observe-classifiable_from");
 	
-	myfile << "\t:parameters (?from ?view - waypoint ?o - object ?v - robot  ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
+	myfile.parameters("?from ?view - waypoint ?o - object ?v - robot  ?l ?l2 - level ?kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(next ?l ?l2)" << std::endl;
@@ -323,8 +323,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	/**
 	 * Action that gets called when an object cannot be classified at all.
 	 */
-	myfile << "(:action finalise_classification_nowhere" << std::endl;
-	myfile << "\t:parameters (?ob - object)" << std::endl;
+	myfile.beginAction("finalise_classification_nowhere");
+	myfile.parameters("?ob - object");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_bases.begin(); ci != knowledge_bases.end(); ++ci)
@@ -361,7 +361,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	/**
 	 * Action that gets called to confirm the classification.
 	 */
-	myfile << "(:action finalise_classification" << std::endl;
+	myfile.beginAction("finalise_classification");
 	myfile << "\t:parameters (?ob - object ?from ?view - waypoint)" << std::endl;// ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -400,8 +400,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	 * POP action.
 	 */
 	myfile << ";; Exit the current branch." << std::endl;
-	myfile << "(:action pop" << std::endl;
-	myfile << "\t:parameters (?l ?l2 - level)" << std::endl;
+	myfile.beginAction("pop");
+	myfile.parameters("?l ?l2 - level");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(lev ?l)" << std::endl;
 	myfile << "\t\t(next ?l2 ?l)" << std::endl;
@@ -419,7 +419,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 		myfile << "\t\t)" << std::endl;
 		myfile << "\t\t(when (stack " << (*ci)->state_name_ << " ?l2)" << std::endl;
 		myfile << "\t\t\t(and " << std::endl;
-		myfile << "\t\t\t\t(m " << (*ci)->state_name_ << ")" << std::endl;
+		myfile.fact(4, "m", (*ci)->state_name_);
 		myfile << "\t\t\t\t(not (stack " << (*ci)->state_name_ << " ?l2))" << std::endl;
 		myfile << "\t\t\t)" << std::endl;
 		myfile << "\t\t)" << std::endl;
@@ -430,8 +430,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	myfile << std::endl;
 
 	myfile << ";; Resolve the axioms manually." << std::endl;
-	myfile << "(:action ramificate" << std::endl;
-	myfile << "\t:parameters ()" << std::endl;
+	myfile.beginAction("ramificate");
+	myfile.parameters("");
 	myfile << "\t:precondition (resolve-axioms)" << std::endl;
 	myfile << "\t:effect (and " << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -474,7 +474,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (or (cleared " << object->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-			myfile << "\t\t\t(Rcleared " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(3, "Rcleared", object->name_, state->state_name_);
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (and (not (cleared " << object->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -482,7 +482,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 			myfile << "\t\t)" << std::endl;
 			*/
 			myfile << "\t\t(when (or (classified " << object->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-			myfile << "\t\t\t(Rclassified " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(3, "Rclassified", object->name_, state->state_name_);
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (and (not (classified " << object->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -494,7 +494,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 				const Location* location = *ci;
 				
 				myfile << "\t\t(when (or (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Robject_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Robject_at", object->name_, location->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -527,8 +527,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	myfile << ")" << std::endl;
 	
 	myfile << ";; Move 'down' into the knowledge base." << std::endl;
-	myfile << "(:action assume_knowledge" << std::endl;
-	myfile << "\t:parameters (?old_kb ?new_kb - knowledgebase)" << std::endl;
+	myfile.beginAction("assume_knowledge");
+	myfile.parameters("?old_kb ?new_kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(current_kb ?old_kb)" << std::endl;
@@ -589,8 +589,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 				myfile << "\t\t\t(and " << std::endl;
 				myfile << "\t\t\t\t(not (Rcleared " << object->name_ << " " << state->state_name_ << "))" << std::endl;
 				myfile << "\t\t\t\t(not (cleared " << object->name_ << " " << state->state_name_ << "))" << std::endl;
-				myfile << "\t\t\t\t(Rcleared " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
-				myfile << "\t\t\t\t(cleared " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(4, "Rcleared", object->name_, state2->state_name_);
+				myfile.fact(4, "cleared", object->name_, state2->state_name_);
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
 				*/
@@ -598,8 +598,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 				myfile << "\t\t\t(and " << std::endl;
 				myfile << "\t\t\t\t(not (Rclassified " << object->name_ << " " << state->state_name_ << "))" << std::endl;
 				myfile << "\t\t\t\t(not (classified " << object->name_ << " " << state->state_name_ << "))" << std::endl;
-				myfile << "\t\t\t\t(Rclassified " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
-				myfile << "\t\t\t\t(classified " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(4, "Rclassified", object->name_, state2->state_name_);
+				myfile.fact(4, "classified", object->name_, state2->state_name_);
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
 			}
@@ -624,8 +624,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Robject_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Robject_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Robject_at", object->name_, location->name_, state2->state_name_);
+					myfile.fact(4, "object_at", object->name_, location->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 				}
@@ -636,8 +636,8 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	myfile << ")" << std::endl;
 
 	myfile << ";; Move 'up' into the knowledge base." << std::endl;;
-	myfile << "(:action shed_knowledge" << std::endl;
-	myfile << "\t:parameters (?old_kb ?new_kb - knowledgebase ?o - object)" << std::endl;
+	myfile.beginAction("shed_knowledge");
+	myfile.parameters("?old_kb ?new_kb - knowledgebase ?o - object");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(current_kb ?old_kb)" << std::endl;
@@ -698,7 +698,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 				const State* state = *ci;
 				myfile << "\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t(not (part-of " << (*ci)->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t(object_at " << object->name_ << " " <<  location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(5, "object_at", object->name_, location->name_, state->state_name_);
 				myfile << "\t\t\t\t)" << std::endl;
 			}
 			myfile << "\t\t\t)" << std::endl;
@@ -815,7 +815,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t\t(classified " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(6, "classified", object->name_, state2->state_name_);
 				myfile << "\t\t\t\t\t)" << std::endl;
 				
 			}
@@ -829,7 +829,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t(not (classified " << object->name_ << " " << state2->state_name_ << "))" << std::endl;
 			}
-			myfile << "\t\t\t\t(classified " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(4, "classified", object->name_, state->state_name_);
 			myfile << "\t\t\t)" << std::endl;
 			myfile << "\t\t)" << std::endl;
 			/*
@@ -842,7 +842,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t\t(cleared " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(6, "cleared", object->name_, state2->state_name_);
 				myfile << "\t\t\t\t\t)" << std::endl;
 				
 			}
@@ -856,7 +856,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t(not (cleared " << object->name_ << " " << state2->state_name_ << "))" << std::endl;
 			}
-			myfile << "\t\t\t\t(cleared " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(4, "cleared", object->name_, state->state_name_);
 			myfile << "\t\t\t)" << std::endl;
 			myfile << "\t\t)" << std::endl;
 			*/
@@ -915,7 +915,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 					myfile << "\t\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t\t(or " << std::endl;
 					myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-					myfile << "\t\t\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(6, "object_at", object->name_, location->name_, state2->state_name_);
 					myfile << "\t\t\t\t\t)" << std::endl;
 					myfile << "\t\t\t\t)" << std::endl;
 				}
@@ -930,7 +930,7 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 					const State* state2 = *ci;
 					myfile << "\t\t\t\t(not (object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << "))" << std::endl;
 				}
-				myfile << "\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(4, "object_at", object->name_, location->name_, state->state_name_);
 				
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
@@ -941,54 +941,52 @@ void ContingentTacticalClassifyPDDLGenerator::generateDomainFile(const std::stri
 	myfile << "\t)" << std::endl;
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
-	myfile.close();
+	if (!myfile.writeToFile(file_name))
+		ROS_ERROR("KCL: (ContingentTacticalClassifyPDDLGenerator) Could not write %s.", file_name.c_str());
 }
 
-void ContingentTacticalClassifyPDDLGenerator::createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::vector<std::string>& location_predicates, const std::string& object_predicate, const std::string& object_location_predicate)
+void ContingentTacticalClassifyPDDLGenerator::createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::vector<std::string>& location_predicates, const std::string& object_predicate, const std::string& object_location_predicate, const std::vector<std::pair<std::string, std::string> >& connections)
 {
+	// The model only lives for this call, it is released in one go when the arena goes out of scope.
+	ModelArena arena;
+	
 	// Now generate the waypoints / boxes / toys / etc.
 	std::vector<Location*> locations;
 	std::vector<Object*> objects;
 	
 	// Initialise the robot's location.
-	Location* robot_location = new Location(robot_location_predicate, false);
+	Location* robot_location = arena.create<Location>(arena.intern(robot_location_predicate), false);
 	locations.push_back(robot_location);
 	
 	// Initialise the object's location.
-	Location* location = new Location(object_location_predicate, false);
+	Location* location = arena.create<Location>(arena.intern(object_location_predicate), false);
 	locations.push_back(location);
-	Object* object = new Object(object_predicate, *location);
+	Object* object = arena.create<Object>(arena.intern(object_predicate), *location);
 	objects.push_back(object);
 	
 	// Add the observation waypoints from where we want to classify the object.
 	for (std::vector<std::string>::const_iterator ci = location_predicates.begin(); ci != location_predicates.end(); ++ci)
 	{
 		const std::string& location_predicate = *ci;
-		Location* location = new Location(location_predicate, true);
+		Location* location = arena.create<Location>(arena.intern(location_predicate), true);
 		locations.push_back(location);
 		object->observable_locations_.push_back(location);
 	}
 	
-	// Make all locations fully connected.
+	// Connect the locations along the roadmap, or all of them if there is no roadmap.
+	std::vector<std::string> location_names;
 	for (std::vector<Location*>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci)
 	{
-		Location* location = *ci;
-		for (std::vector<Location*>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci)
-		{
-			Location* other_location = *ci;
-			location->connected_locations_.push_back(other_location);
-			other_location->connected_locations_.push_back(location);
-			
-			//std::cout << location->name_ << " is connected to " << other_location->name_ << std::endl;
-		}
-		//std::cout << "Processed: " << location->name_ << std::endl;
+		location_names.push_back((*ci)->name_);
 	}
+	LocationGraph connectivity;
+	connectivity.setEdges(location_names, connections);
 	
 	std::vector<const KnowledgeBase*> knowledge_bases;
 	std::map<const Object*, const Location*> empty_stacked_objects_mapping;
-	State basic_state("basic", empty_stacked_objects_mapping);
+	State basic_state(arena.intern("basic"), empty_stacked_objects_mapping);
 	
-	KnowledgeBase basis_kb("basis_kb");
+	KnowledgeBase basis_kb(arena.intern("basis_kb"));
 	basis_kb.addState(basic_state);
 	knowledge_bases.push_back(&basis_kb);
 	
@@ -1002,7 +1000,7 @@ void ContingentTacticalClassifyPDDLGenerator::createPDDL(const std::string& path
 		ss.str(std::string());
 		ss << "kb_" << object->name_;
 		
-		KnowledgeBase* kb_location = new KnowledgeBase(ss.str());
+		KnowledgeBase* kb_location = arena.create<KnowledgeBase>(arena.intern(ss.str()));
 		basis_kb.addChild(*kb_location);
 		knowledge_bases.push_back(kb_location);
 		
@@ -1015,7 +1013,7 @@ void ContingentTacticalClassifyPDDLGenerator::createPDDL(const std::string& path
 			ss.str(std::string());
 			ss << "kb_" << object->name_;
 			
-			KnowledgeBase* kb_location = new KnowledgeBase(ss.str());
+			KnowledgeBase* kb_location = arena.create<KnowledgeBase>(arena.intern(ss.str()));
 			basis_kb.addChild(*kb_location);
 			knowledge_bases.push_back(kb_location);
 			
@@ -1030,7 +1028,7 @@ void ContingentTacticalClassifyPDDLGenerator::createPDDL(const std::string& path
 			
 				ss.str(std::string());
 				ss << "s" << state_id;
-				State* state_pickupable = new State(ss.str(), classifiable_from);
+				State* state_pickupable = arena.create<State>(arena.intern(ss.str()), classifiable_from);
 				kb_location->addState(*state_pickupable);
 				++state_id;
 			}
@@ -1044,7 +1042,7 @@ void ContingentTacticalClassifyPDDLGenerator::createPDDL(const std::string& path
 	ss.str(std::string());
 	ss << path  << problem_file;
 	ROS_INFO("KCL: (ContingentTacticalClassifyPDDLGenerator) Generate problem... %s", ss.str().c_str());
-	generateProblemFile(ss.str(), basis_kb, knowledge_bases, *robot_location,locations, objects);
+	generateProblemFile(ss.str(), basis_kb, knowledge_bases, *robot_location, locations, connectivity, objects);
 }
 
 };
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -10,6 +9,8 @@
 #include <ros/ros.h>
 
 #include "squirrel_planning_execution/ContingentTidyPDDLGenerator.h"
+#include "squirrel_planning_execution/PDDLWriter.h"
+#include "squirrel_planning_execution/ModelArena.h"
 
 namespace KCL_rosplan {
 
@@ -26,8 +27,7 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 		}
 	}
 	
-	std::ofstream myfile;
-	myfile.open(file_name.c_str());
+	PDDLWriter myfile;
 	myfile << "(define (problem Keys-0)" << std::endl;
 	myfile << "(:domain find_key)" << std::endl;
 	myfile << "(:objects" << std::endl;
@@ -43,14 +43,14 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 	
 	myfile << "\t(next l0 l1)" << std::endl;
 	
-	myfile << "\t(current_kb " << current_knowledge_base.name_ << ")" << std::endl;
+	myfile.fact(1, "current_kb", current_knowledge_base.name_);
 	
 	// Location of the robot.
 	for (std::vector<const State*>::const_iterator ci = current_knowledge_base.states_.begin(); ci != current_knowledge_base.states_.end(); ++ci)
 	{
 		const State* state = *ci;
-		myfile << "\t(part-of " << state->state_name_ << " " << current_knowledge_base.name_ << ")" << std::endl;
-		myfile << "\t(m " << state->state_name_ << ")" << std::endl;
+		myfile.fact(1, "part-of", state->state_name_, current_knowledge_base.name_);
+		myfile.fact(1, "m", state->state_name_);
 		myfile << "\t(robot_at robot " << robot_location.name_ << " " << state->state_name_ << ")" << std::endl;
 		myfile << "\t(gripper_empty robot " << " " << state->state_name_ << ")" << std::endl;
 		
@@ -59,7 +59,7 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 		{
 			const Object* object = *ci;
 			//myfile << "\t(clear " << object->name_ << " " << state->state_name_ << ")" << std::endl;
-			myfile << "\t(object_at " << object->name_ << " " << object->location_->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(1, "object_at", object->name_, object->location_->name_, state->state_name_);
 		}
 		
 		for (std::vector<const Location*>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci)
@@ -89,7 +89,7 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 			
 			if (!is_blocked)
 			{
-				myfile << "\t(is_not_occupied " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(1, "is_not_occupied", location->name_, state->state_name_);
 			}
 		}
 	}
@@ -98,7 +98,7 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 	for (std::vector<const Box*>::const_iterator ci = boxes.begin(); ci != boxes.end(); ++ci)
 	{
 		const Box* box = *ci;
-		myfile << "\t(box_at " << box->name_ << " " << box->location_->name_ << ")" << std::endl;
+		myfile.fact(1, "box_at", box->name_, box->location_->name_);
 		for (std::vector<const Type*>::const_iterator ci = box->types_that_fit_.begin(); ci != box->types_that_fit_.end(); ++ci)
 		{
 			const Type* type = *ci;
@@ -109,7 +109,7 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 				for (std::vector<const State*>::const_iterator ci = knowledge_base->states_.begin(); ci != knowledge_base->states_.end(); ++ci)
 				{
 					const State* state = *ci;
-					myfile << "\t(can_fit_inside " << type->name_ << " " << box->name_ << " " << state->state_name_ << ")" << std::endl;
+					myfile.fact(1, "can_fit_inside", type->name_, box->name_, state->state_name_);
 				}
 			}
 		}
@@ -125,7 +125,7 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 		{
 			const Location* location2 = *ci;
 			//if (location == location2) continue;
-			myfile << "\t(connected " << location->name_ << " " << location2->name_ << ")" << std::endl;
+			myfile.fact(1, "connected", location->name_, location2->name_);
 			
 			//std::cout << "\t is connected to " << location2->name_ << std::endl;
 			//myfile << "\t(connected " << location2->name_ << " " << location->name_ << ")" << std::endl;
@@ -140,17 +140,17 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 		for (std::vector<const State*>::const_iterator ci = knowledge_base->states_.begin(); ci != knowledge_base->states_.end(); ++ci)
 		{
 			const State* state = *ci;
-			myfile << "\t(part-of " << state->state_name_ << " " << knowledge_base->name_ << ")" << std::endl;
+			myfile.fact(1, "part-of", state->state_name_, knowledge_base->name_);
 			
 			/*
 			for (std::map<const Object*, const Object*>::const_iterator ci = state->stackable_mapping_.begin(); ci != state->stackable_mapping_.end(); ++ci)
 			{
-				myfile << "\t(on " << (*ci).first->name_ << " " << (*ci).second->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(1, "on", (*ci).first->name_, (*ci).second->name_, state->state_name_);
 			}
 			*/
 			for (std::map<const Object*, const Type*>::const_iterator ci = state->type_mapping_.begin(); ci != state->type_mapping_.end(); ++ci)
 			{
-				myfile << "\t(is_of_type " << (*ci).first->name_ << " " << (*ci).second->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(1, "is_of_type", (*ci).first->name_, (*ci).second->name_, state->state_name_);
 			}
 			
 			for (std::vector<const Type*>::const_iterator ci = state->pushable_objects_.begin(); ci != state->pushable_objects_.end(); ++ci)
@@ -166,7 +166,7 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 		
 		for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_base->children_.begin(); ci != knowledge_base->children_.end(); ++ci)
 		{
-			myfile << "\t(parent " << knowledge_base->name_ << " " << (*ci)->name_ << ")" << std::endl;
+			myfile.fact(1, "parent", knowledge_base->name_, (*ci)->name_);
 		}
 	}
 	myfile << ")" << std::endl;
@@ -176,13 +176,14 @@ void ContingentTidyPDDLGenerator::generateProblemFile(const std::string& file_na
 		const Object* object = *ci;
 		for (std::vector<const State*>::const_iterator ci = current_knowledge_base.states_.begin(); ci != current_knowledge_base.states_.end(); ++ci)
 		{
-			myfile << "\t(tidy " << object->name_ << " " << (*ci)->state_name_ << ")" << std::endl;
+			myfile.fact(1, "tidy", object->name_, (*ci)->state_name_);
 		}
 	}
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
-	myfile.close();
+	if (!myfile.writeToFile(file_name))
+		ROS_ERROR("KCL: (ContingentTidyPDDLGenerator) Could not write %s.", file_name.c_str());
 }
 
 void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_name, const KnowledgeBase& current_knowledge_base, const std::vector<const KnowledgeBase*>& knowledge_bases, const Location& robot_location, const std::vector<const Location*>& locations, const std::vector<const Object*>& objects, const std::vector<const Box*>& boxes, const std::vector<const Type*>& types)
@@ -198,8 +199,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 		}
 	}
 	
-	std::ofstream myfile;
-	myfile.open (file_name.c_str());
+	PDDLWriter myfile;
 	myfile << "(define (domain find_key)" << std::endl;
 	myfile << "(:requirements :typing :conditional-effects :negative-preconditions :disjunctive-preconditions)" << std::endl;
 	myfile << std::endl;
@@ -313,8 +313,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	/**
 	 * Put object in a box.
 	 */
-	myfile << "(:action put_object_in_box" << std::endl;
-	myfile << "\t:parameters (?v - robot ?wp ?wp2 - waypoint ?o1 - object ?b - box ?t - type)" << std::endl;
+	myfile.beginAction("put_object_in_box");
+	myfile.parameters("?v - robot ?wp ?wp2 - waypoint ?o1 - object ?b - box ?t - type");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(box_at ?b ?wp)" << std::endl;
@@ -356,8 +356,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	/**
 	 * PICK-UP OBJECT.
 	 */
-	myfile << "(:action pickup_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?wp ?wp2 - waypoint ?o - object ?t - type)" << std::endl;
+	myfile.beginAction("pickup_object");
+	myfile.parameters("?v - robot ?wp ?wp2 - waypoint ?o - object ?t - type");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(connected ?wp ?wp2)" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -402,8 +402,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	/**
 	 * PUT-DOWN OBJECT.
 	 */
-	myfile << "(:action putdown_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?wp ?wp2 - waypoint ?o - object)" << std::endl;
+	myfile.beginAction("putdown_object");
+	myfile.parameters("?v - robot ?wp ?wp2 - waypoint ?o - object");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(connected ?wp ?wp2)" << std::endl;
@@ -445,8 +445,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	/**
 	 * GOTO WAYPOINT.
 	 */
-	myfile << "(:action goto_waypoint" << std::endl;
-	myfile << "\t:parameters (?v - robot ?from ?to - waypoint)" << std::endl;
+	myfile.beginAction("goto_waypoint");
+	myfile.parameters("?v - robot ?from ?to - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(connected ?from ?to)" << std::endl;
@@ -487,8 +487,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	/**
 	 * PUSH OBJECT.
 	 *
-	myfile << "(:action push_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?ob - object ?t - type ?from ?to ?obw - waypoint)" << std::endl;
+	myfile.beginAction("push_object");
+	myfile.parameters("?v - robot ?ob - object ?t - type ?from ?to ?obw - waypoint");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_bases.begin(); ci != knowledge_bases.end(); ++ci)
@@ -532,8 +532,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	/**
 	 * TIDY OBJECT.
 	 */
-	myfile << "(:action tidy_object" << std::endl;
-	myfile << "\t:parameters (?v - robot ?o - object ?b - box ?t - type)" << std::endl;
+	myfile.beginAction("tidy_object");
+	myfile.parameters("?v - robot ?o - object ?b - box ?t - type");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	for (std::vector<const KnowledgeBase*>::const_iterator ci = knowledge_bases.begin(); ci != knowledge_bases.end(); ++ci)
@@ -574,9 +574,9 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	 * Sense the type of an object.
 	 */
 	myfile << ";; Sense the type of object." << std::endl;
-	myfile << "(:action observe-is_of_type" << std::endl;
+	myfile.beginAction("observe-is_of_type");
 
-	myfile << "\t:parameters (?o - object ?t - type ?v - robot ?wp ?wp2 - waypoint ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
+	myfile.parameters("?o - object ?t - type ?v - robot ?wp ?wp2 - waypoint ?l ?l2 - level ?kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(next ?l ?l2)" << std::endl;
@@ -624,9 +624,9 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	 * Recall a previously performed observation.
 	 */
 	myfile << ";; Sense the type of object." << std::endl;
-	myfile << "(:action recall-observe-is_of_type" << std::endl;
+	myfile.beginAction("recall-observe-is_of_type");
 
-	myfile << "\t:parameters (?o - object ?t - type ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
+	myfile.parameters("?o - object ?t - type ?l ?l2 - level ?kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(next ?l ?l2)" << std::endl;
@@ -661,9 +661,9 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	 * Sense whether a type of object can be pushed.
 	 *
 	myfile << ";; Sense the type of object." << std::endl;
-	myfile << "(:action test-push-affordability" << std::endl;
+	myfile.beginAction("test-push-affordability");
 
-	myfile << "\t:parameters (?t - type ?o - object ?v - robot ?wp - waypoint ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
+	myfile.parameters("?t - type ?o - object ?v - robot ?wp - waypoint ?l ?l2 - level ?kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(next ?l ?l2)" << std::endl;
@@ -709,9 +709,9 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	 * Sense whether a type of object can be picked up.
 	 *
 	myfile << ";; Sense the type of object." << std::endl;
-	myfile << "(:action test-pickup-affordability" << std::endl;
+	myfile.beginAction("test-pickup-affordability");
 
-	myfile << "\t:parameters (?t - type ?o - object ?v - robot ?wp - waypoint ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
+	myfile.parameters("?t - type ?o - object ?v - robot ?wp - waypoint ?l ?l2 - level ?kb - knowledgebase");
 
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -757,9 +757,9 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	 * Sense whether an object can be stacked on top of another object.
 	 *
 	myfile << ";; Sense the type of object." << std::endl;
-	myfile << "(:action observe-stackable-affordability" << std::endl;
+	myfile.beginAction("observe-stackable-affordability");
 
-	myfile << "\t:parameters (?o1 ?o2 - object ?v - robot ?wp - waypoint ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
+	myfile.parameters("?o1 ?o2 - object ?v - robot ?wp - waypoint ?l ?l2 - level ?kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(next ?l ?l2)" << std::endl;
@@ -805,9 +805,9 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	 * Sense whether an object is at a location.
 	 *
 	myfile << ";; Sense the location of an object." << std::endl;
-	myfile << "(:action observe-object-location" << std::endl;
+	myfile.beginAction("observe-object-location");
 
-	myfile << "\t:parameters (?o - object ?v - robot ?wp - waypoint ?l ?l2 - level ?kb - knowledgebase)" << std::endl;
+	myfile.parameters("?o - object ?v - robot ?wp - waypoint ?l ?l2 - level ?kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(next ?l ?l2)" << std::endl;
@@ -850,8 +850,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	 * POP action.
 	 */
 	myfile << ";; Exit the current branch." << std::endl;
-	myfile << "(:action pop" << std::endl;
-	myfile << "\t:parameters (?l ?l2 - level)" << std::endl;
+	myfile.beginAction("pop");
+	myfile.parameters("?l ?l2 - level");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(lev ?l)" << std::endl;
 	myfile << "\t\t(next ?l2 ?l)" << std::endl;
@@ -869,7 +869,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 		myfile << "\t\t)" << std::endl;
 		myfile << "\t\t(when (stack " << (*ci)->state_name_ << " ?l2)" << std::endl;
 		myfile << "\t\t\t(and " << std::endl;
-		myfile << "\t\t\t\t(m " << (*ci)->state_name_ << ")" << std::endl;
+		myfile.fact(4, "m", (*ci)->state_name_);
 		myfile << "\t\t\t\t(not (stack " << (*ci)->state_name_ << " ?l2))" << std::endl;
 		myfile << "\t\t\t)" << std::endl;
 		myfile << "\t\t)" << std::endl;
@@ -880,8 +880,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	myfile << std::endl;
 
 	myfile << ";; Resolve the axioms manually." << std::endl;
-	myfile << "(:action raminificate" << std::endl;
-	myfile << "\t:parameters ()" << std::endl;
+	myfile.beginAction("raminificate");
+	myfile.parameters("");
 	myfile << "\t:precondition (resolve-axioms)" << std::endl;
 	myfile << "\t:effect (and " << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
@@ -903,7 +903,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			const Location* location = *ci;
 			
 			myfile << "\t\t(when (or (is_not_occupied " << location->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-			myfile << "\t\t\t(Ris_not_occupied " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(3, "Ris_not_occupied", location->name_, state->state_name_);
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (and (not (is_not_occupied " << location->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -923,7 +923,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			myfile << "\t\t)" << std::endl;
 			/*
 			myfile << "\t\t(when (or (clear " << object->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-			myfile << "\t\t\t(Rclear " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(3, "Rclear", object->name_, state->state_name_);
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (and (not (clear " << object->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -931,7 +931,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			myfile << "\t\t)" << std::endl;
 			*/
 			myfile << "\t\t(when (or (tidy " << object->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-			myfile << "\t\t\t(Rtidy " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(3, "Rtidy", object->name_, state->state_name_);
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (and (not (tidy " << object->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -942,7 +942,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			{
 				const Object* other_object = *ci;
 				myfile << "\t\t(when (or (on " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Ron " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Ron", object->name_, other_object->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (on " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -950,7 +950,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (or (can_stack_on " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Rcan_stack_on " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Rcan_stack_on", object->name_, other_object->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (can_stack_on " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -963,7 +963,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				const Location* location = *ci;
 				/*
 				myfile << "\t\t(when (or (push_location " << object->name_ << " " << location->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Rpush_location " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Rpush_location", object->name_, location->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (push_location " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -971,7 +971,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				myfile << "\t\t)" << std::endl;
 				*/
 				myfile << "\t\t(when (or (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Robject_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Robject_at", object->name_, location->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -983,7 +983,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			{
 				const Box* box = *ci;
 				myfile << "\t\t(when (or (inside " << object->name_ << " " << box->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Rinside " << object->name_ << " " << box->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Rinside", object->name_, box->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (inside " << object->name_ << " " << box->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -995,7 +995,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			{
 				const Type* type = *ci;
 				myfile << "\t\t(when (or (is_of_type " << object->name_ << " " << type->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Ris_of_type " << object->name_ << " " << type->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Ris_of_type", object->name_, type->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (is_of_type " << object->name_ << " " << type->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -1016,7 +1016,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			myfile << "\t\t)" << std::endl;
 			/*
 			myfile << "\t\t(when (or (box_at " << location->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-			myfile << "\t\t\t(Rbox_at " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(3, "Rbox_at", location->name_, state->state_name_);
 			myfile << "\t\t)" << std::endl;
 			
 			myfile << "\t\t(when (and (not (box_at " << location->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -1049,7 +1049,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				const Box* box = *ci;
 								
 				myfile << "\t\t(when (or (can_fit_inside " << type->name_ << " " << box->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Rcan_fit_inside " << type->name_ << " " << box->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Rcan_fit_inside", type->name_, box->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (can_fit_inside " << type->name_ << " " << box->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -1061,7 +1061,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			{
 				const Location* location = *ci;
 				myfile << "\t\t(when (or (tidy_location " << type->name_ << " " << location->name_ << " " << state->state_name_ << ") (not (m " << state->state_name_ << ")))" << std::endl;
-				myfile << "\t\t\t(Rtidy_location " << type->name_ << " " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(3, "Rtidy_location", type->name_, location->name_, state->state_name_);
 				myfile << "\t\t)" << std::endl;
 				
 				myfile << "\t\t(when (and (not (tidy_location " << type->name_ << " " << location->name_ << " " << state->state_name_ << ")) (m " << state->state_name_ << "))" << std::endl;
@@ -1074,8 +1074,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	myfile << ")" << std::endl;
 	
 	myfile << ";; Move 'down' into the knowledge base." << std::endl;
-	myfile << "(:action assume_knowledge" << std::endl;
-	myfile << "\t:parameters (?old_kb ?new_kb - knowledgebase)" << std::endl;
+	myfile.beginAction("assume_knowledge");
+	myfile.parameters("?old_kb ?new_kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(current_kb ?old_kb)" << std::endl;
@@ -1135,8 +1135,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				myfile << "\t\t\t(and " << std::endl;
 				myfile << "\t\t\t\t(not (Rclear " << object->name_ << " " << state->state_name_ << "))" << std::endl;
 				myfile << "\t\t\t\t(not (clear " << object->name_ << " " << state->state_name_ << "))" << std::endl;
-				myfile << "\t\t\t\t(Rclear " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
-				myfile << "\t\t\t\t(clear " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(4, "Rclear", object->name_, state2->state_name_);
+				myfile.fact(4, "clear", object->name_, state2->state_name_);
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
 				*/
@@ -1144,8 +1144,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				myfile << "\t\t\t(and " << std::endl;
 				myfile << "\t\t\t\t(not (Rtidy " << object->name_ << " " << state->state_name_ << "))" << std::endl;
 				myfile << "\t\t\t\t(not (tidy " << object->name_ << " " << state->state_name_ << "))" << std::endl;
-				myfile << "\t\t\t\t(Rtidy " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
-				myfile << "\t\t\t\t(tidy " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(4, "Rtidy", object->name_, state2->state_name_);
+				myfile.fact(4, "tidy", object->name_, state2->state_name_);
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
 				/*
@@ -1156,8 +1156,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Ron " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (on " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Ron " << object->name_ << " " << other_object->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(on " << object->name_ << " " << other_object->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Ron", object->name_, other_object->name_, state2->state_name_);
+					myfile.fact(4, "on", object->name_, other_object->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 					
@@ -1165,8 +1165,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Rcan_stack_on " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (can_stack_on " << object->name_ << " " << other_object->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Rcan_stack_on " << object->name_ << " " << other_object->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(can_stack_on " << object->name_ << " " << other_object->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Rcan_stack_on", object->name_, other_object->name_, state2->state_name_);
+					myfile.fact(4, "can_stack_on", object->name_, other_object->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 				}
@@ -1178,8 +1178,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Rinside " << object->name_ << " " << box->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (inside " << object->name_ << " " << box->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Rinside " << object->name_ << " " << box->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(inside " << object->name_ << " " << box->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Rinside", object->name_, box->name_, state2->state_name_);
+					myfile.fact(4, "inside", object->name_, box->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 				}
@@ -1202,8 +1202,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				myfile << "\t\t\t(and " << std::endl;
 				myfile << "\t\t\t\t(not (Ris_not_occupied " << location->name_ << " " << state->state_name_ << "))" << std::endl;
 				myfile << "\t\t\t\t(not (is_not_occupied " << location->name_ << " " << state->state_name_ << "))" << std::endl;
-				myfile << "\t\t\t\t(Ris_not_occupied " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
-				myfile << "\t\t\t\t(is_not_occupied " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(4, "Ris_not_occupied", location->name_, state2->state_name_);
+				myfile.fact(4, "is_not_occupied", location->name_, state2->state_name_);
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
 				
@@ -1225,8 +1225,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Robject_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Robject_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Robject_at", object->name_, location->name_, state2->state_name_);
+					myfile.fact(4, "object_at", object->name_, location->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 					/*
@@ -1234,8 +1234,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Rpush_location " << object->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (push_location " << object->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Rpush_location " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(push_location " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Rpush_location", object->name_, location->name_, state2->state_name_);
+					myfile.fact(4, "push_location", object->name_, location->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 					*/
@@ -1271,8 +1271,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Rcan_fit_inside " << type->name_ << " " << box->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (can_fit_inside " << type->name_ << " " << box->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Rcan_fit_inside " << type->name_ << " " << box->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(can_fit_inside " << type->name_ << " " << box->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Rcan_fit_inside", type->name_, box->name_, state2->state_name_);
+					myfile.fact(4, "can_fit_inside", type->name_, box->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 				}
@@ -1284,8 +1284,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					myfile << "\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t(not (Rtidy_location " << type->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
 					myfile << "\t\t\t\t(not (tidy_location " << type->name_ << " " << location->name_ << " " << state->state_name_ << "))" << std::endl;
-					myfile << "\t\t\t\t(Rtidy_location " << type->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
-					myfile << "\t\t\t\t(tidy_location " << type->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(4, "Rtidy_location", type->name_, location->name_, state2->state_name_);
+					myfile.fact(4, "tidy_location", type->name_, location->name_, state2->state_name_);
 					myfile << "\t\t\t)" << std::endl;
 					myfile << "\t\t)" << std::endl;
 				}
@@ -1296,8 +1296,8 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	myfile << ")" << std::endl;
 
 	myfile << ";; Move 'up' into the knowledge base." << std::endl;;
-	myfile << "(:action shed_knowledge" << std::endl;
-	myfile << "\t:parameters (?old_kb ?new_kb - knowledgebase)" << std::endl;
+	myfile.beginAction("shed_knowledge");
+	myfile.parameters("?old_kb ?new_kb - knowledgebase");
 	myfile << "\t:precondition (and" << std::endl;
 	myfile << "\t\t(not (resolve-axioms))" << std::endl;
 	myfile << "\t\t(current_kb ?old_kb)" << std::endl;
@@ -1343,7 +1343,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			// Make sure the state of the toilets are the same.
 			myfile << "\t\t\t\t(or " << std::endl;
 			myfile << "\t\t\t\t\t(not (part-of " << (*ci)->state_name_ << " ?old_kb))" << std::endl;
-			myfile << "\t\t\t\t\t(is_not_occupied " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(5, "is_not_occupied", location->name_, state->state_name_);
 			myfile << "\t\t\t\t)" << std::endl;
 		}
 		myfile << "\t\t\t)" << std::endl;
@@ -1378,7 +1378,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				// Make sure the state of the toilets are the same.
 				myfile << "\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t(not (part-of " << (*ci)->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t(object_at " << object->name_ << " " <<  location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(5, "object_at", object->name_, location->name_, state->state_name_);
 				myfile << "\t\t\t\t)" << std::endl;
 			}
 			myfile << "\t\t\t)" << std::endl;
@@ -1403,7 +1403,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 			// Make sure the state of the toilets are the same.
 			myfile << "\t\t\t\t(or " << std::endl;
 			myfile << "\t\t\t\t\t(not (part-of " << (*ci)->state_name_ << " ?old_kb))" << std::endl;
-			myfile << "\t\t\t\t\t(tidy " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(5, "tidy", object->name_, state->state_name_);
 			myfile << "\t\t\t\t)" << std::endl;
 		}
 		myfile << "\t\t\t)" << std::endl;
@@ -1507,7 +1507,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t\t(tidy " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(6, "tidy", object->name_, state2->state_name_);
 				myfile << "\t\t\t\t\t)" << std::endl;
 				
 			}
@@ -1521,7 +1521,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t(not (tidy " << object->name_ << " " << state2->state_name_ << "))" << std::endl;
 			}
-			myfile << "\t\t\t\t(tidy " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(4, "tidy", object->name_, state->state_name_);
 			myfile << "\t\t\t)" << std::endl;
 			myfile << "\t\t)" << std::endl;
 			/*
@@ -1534,7 +1534,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t\t(clear " << object->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(6, "clear", object->name_, state2->state_name_);
 				myfile << "\t\t\t\t\t)" << std::endl;
 				
 			}
@@ -1548,7 +1548,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t(not (clear " << object->name_ << " " << state2->state_name_ << "))" << std::endl;
 			}
-			myfile << "\t\t\t\t(clear " << object->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(4, "clear", object->name_, state->state_name_);
 			myfile << "\t\t\t)" << std::endl;
 			myfile << "\t\t)" << std::endl;
 			*/
@@ -1571,7 +1571,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					const State* state2 = *ci;
 					myfile << "\t\t\t\t\t(or " << std::endl;
 					myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-					myfile << "\t\t\t\t\t\t(inside " << object->name_ << " " << box->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(6, "inside", object->name_, box->name_, state2->state_name_);
 					myfile << "\t\t\t\t\t)" << std::endl;
 					
 				}
@@ -1585,7 +1585,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					const State* state2 = *ci;
 					myfile << "\t\t\t\t(not (inside " << object->name_ << " " << box->name_ << " " << state2->state_name_ << "))" << std::endl;
 				}
-				myfile << "\t\t\t\t(inside " << object->name_ << " " << box->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(4, "inside", object->name_, box->name_, state->state_name_);
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
 			}
@@ -1639,7 +1639,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				myfile << "\t\t\t\t(and " << std::endl;
 				myfile << "\t\t\t\t\t(or " << std::endl;
 				myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-				myfile << "\t\t\t\t\t\t(is_not_occupied " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+				myfile.fact(6, "is_not_occupied", location->name_, state2->state_name_);
 				myfile << "\t\t\t\t\t)" << std::endl;
 				myfile << "\t\t\t\t)" << std::endl;
 			}
@@ -1654,7 +1654,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 				const State* state2 = *ci;
 				myfile << "\t\t\t\t(not (is_not_occupied " << location->name_ << " " << state2->state_name_ << "))" << std::endl;
 			}
-			myfile << "\t\t\t\t(is_not_occupied " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+			myfile.fact(4, "is_not_occupied", location->name_, state->state_name_);
 			
 			myfile << "\t\t\t)" << std::endl;
 			myfile << "\t\t)" << std::endl;
@@ -1674,7 +1674,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					myfile << "\t\t\t\t(and " << std::endl;
 					myfile << "\t\t\t\t\t(or " << std::endl;
 					myfile << "\t\t\t\t\t\t(not (part-of " << state2->state_name_ << " ?old_kb))" << std::endl;
-					myfile << "\t\t\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << ")" << std::endl;
+					myfile.fact(6, "object_at", object->name_, location->name_, state2->state_name_);
 					myfile << "\t\t\t\t\t)" << std::endl;
 					myfile << "\t\t\t\t)" << std::endl;
 				}
@@ -1689,7 +1689,7 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 					const State* state2 = *ci;
 					myfile << "\t\t\t\t(not (object_at " << object->name_ << " " << location->name_ << " " << state2->state_name_ << "))" << std::endl;
 				}
-				myfile << "\t\t\t\t(object_at " << object->name_ << " " << location->name_ << " " << state->state_name_ << ")" << std::endl;
+				myfile.fact(4, "object_at", object->name_, location->name_, state->state_name_);
 				
 				myfile << "\t\t\t)" << std::endl;
 				myfile << "\t\t)" << std::endl;
@@ -1700,11 +1700,15 @@ void ContingentTidyPDDLGenerator::generateDomainFile(const std::string& file_nam
 	myfile << "\t)" << std::endl;
 	myfile << ")" << std::endl;
 	myfile << ")" << std::endl;
-	myfile.close();
+	if (!myfile.writeToFile(file_name))
+		ROS_ERROR("KCL: (ContingentTidyPDDLGenerator) Could not write %s.", file_name.c_str());
 }
 
-void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_to_location_mapping, std::map<std::string, std::vector<std::string> >& near_waypoint_mappings, const std::map<std::string, std::string>& object_to_type_mapping, const std::map<std::string, std::string>& box_to_location_mapping, const std::map<std::string, std::string>& box_to_type_mapping)
+void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std::string& domain_file, const std::string& problem_file, const std::string& robot_location_predicate, const std::map<std::string, std::string>& object_to_location_mapping, std::map<std::string, std::vector<std::string> >& near_waypoint_mappings, const std::map<std::string, std::string>& object_to_type_mapping, const std::map<std::string, std::string>& box_to_location_mapping, const std::map<std::string, std::string>& box_to_type_mapping, const std::map<std::string, std::vector<std::string> >& /* near_box_location_mapping */)
 {
+	// The model only lives for this call, it is released in one go when the arena goes out of scope.
+	ModelArena arena;
+	
 	// Now generate the waypoints / boxes / toys / etc.
 	std::vector<const Location*> locations;
 	std::vector<const Box*> boxes;
@@ -1716,8 +1720,8 @@ void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std:
 		const std::string& object_predicate = (*ci).first;
 		const std::string& location_predicate = (*ci).second;
 		
-		Location* location = new Location(location_predicate, false);
-		Object* object = new Object(object_predicate, *location);
+		Location* location = arena.create<Location>(arena.intern(location_predicate), false);
+		Object* object = arena.create<Object>(arena.intern(object_predicate), *location);
 		locations.push_back(location);
 		objects.push_back(object);
 		
@@ -1728,7 +1732,7 @@ void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std:
 			for (std::vector<std::string>::const_iterator ci = near_locations.begin(); ci != near_locations.end(); ++ci)
 			{
 				const std::string& near_location_name = *ci;
-				Location* near_location = new Location(near_location_name, false);
+				Location* near_location = arena.create<Location>(arena.intern(near_location_name), false);
 				locations.push_back(near_location);
 				location->near_locations_.push_back(near_location);
 			}
@@ -1752,7 +1756,7 @@ void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std:
 		}
 		
 		if (box_type == NULL) {
-			box_type = new Type(box_type_predicate);
+			box_type = arena.create<Type>(arena.intern(box_type_predicate));
 			types.push_back(box_type);
 		}
 		std::vector<const Type*> box_types;
@@ -1760,15 +1764,15 @@ void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std:
 		
 		std::vector<const Object*> empty_object_list;
 		
-		Location* box_location = new Location(location_predicate, true);
-		Box* box = new Box(box_predicate, *box_location, box_types, empty_object_list);
+		Location* box_location = arena.create<Location>(arena.intern(location_predicate), true);
+		Box* box = arena.create<Box>(arena.intern(box_predicate), *box_location, box_types, empty_object_list);
 		
 		locations.push_back(box_location);
 		boxes.push_back(box);
 	}
 	
 	// Initialise the robot's location.
-	Location* robot_location = new Location(robot_location_predicate, false);
+	Location* robot_location = arena.create<Location>(arena.intern(robot_location_predicate), false);
 	locations.push_back(robot_location);
 
 	//std::cout << "(ContingentTidyPDDLGenerator) Creating all possible states..." << std::endl;
@@ -1779,9 +1783,9 @@ void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std:
 	std::map<const Object*, const Type*> empty_type_mapping;
 	std::vector<const Type*> empty_pushable_types;
 	std::vector<const Type*> empty_pickupable_types;
-	State basic_state("basic"/*, empty_object_location_mapping*/, empty_stacked_objects_mapping, empty_type_mapping, empty_pushable_types, empty_pickupable_types);
+	State basic_state(arena.intern("basic")/*, empty_object_location_mapping*/, empty_stacked_objects_mapping, empty_type_mapping, empty_pushable_types, empty_pickupable_types);
 	
-	KnowledgeBase basis_kb("basis_kb");
+	KnowledgeBase basis_kb(arena.intern("basis_kb"));
 	basis_kb.addState(basic_state);
 	knowledge_bases.push_back(&basis_kb);
 	
@@ -1795,7 +1799,7 @@ void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std:
 		ss.str(std::string());
 		ss << "kb_" << object->name_;
 		
-		KnowledgeBase* kb_location = new KnowledgeBase(ss.str());
+		KnowledgeBase* kb_location = arena.create<KnowledgeBase>(arena.intern(ss.str()));
 		basis_kb.addChild(*kb_location);
 		knowledge_bases.push_back(kb_location);
 		
@@ -1816,7 +1820,7 @@ void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std:
 				ss.str(std::string());
 				ss << "s" << state_id << "_pick";
 				pickupable_types.push_back(type);
-				State* state_pickupable = new State(ss.str()/*, object_location_mapping*/, stackable_mapping, type_mapping, pushable_types, pickupable_types);
+				State* state_pickupable = arena.create<State>(arena.intern(ss.str())/*, object_location_mapping*/, stackable_mapping, type_mapping, pushable_types, pickupable_types);
 				kb_location->addState(*state_pickupable);
 				pickupable_types.clear();
 				/*
@@ -1824,7 +1828,7 @@ void ContingentTidyPDDLGenerator::createPDDL(const std::string& path, const std:
 				ss << "s" << state_id << "_push";
 				pickupable_types.clear();
 				pushable_types.push_back(type);
-				State* state_pushable = new State(ss.str(), object_location_mapping, stackable_mapping, type_mapping, pushable_types, pickupable_types);
+				State* state_pushable = arena.create<State>(arena.intern(ss.str()), object_location_mapping, stackable_mapping, type_mapping, pushable_types, pickupable_types);
 				kb_location->addState(*state_pushable);
 				pushable_types.clear();
 				*/
@@ -0,0 +1,105 @@
+#include <squirrel_planning_execution/DistanceField.h>
+#include <occupancy_grid_utils/coordinate_conversions.h>
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+namespace KCL_rosplan {
+
+// Used for cells without any obstacle in their row or column, large enough to never be the minimum but small 
+// enough that adding squared offsets to it does not overflow.
+static const float INFINITE_DISTANCE = 1e20f;
+
+DistanceField::DistanceField()
+{
+	
+}
+
+void DistanceField::compute(const nav_msgs::OccupancyGrid& grid, int occupancy_threshold)
+{
+	info_ = grid.info;
+	int width = grid.info.width;
+	int height = grid.info.height;
+	
+	squared_distances_.resize(width * height);
+	for (int i = 0; i < width * height; ++i) {
+		squared_distances_[i] = grid.data[i] > occupancy_threshold ? 0.0f : INFINITE_DISTANCE;
+	}
+	
+	int max_dimension = std::max(width, height);
+	std::vector<int> v(max_dimension);
+	std::vector<float> z(max_dimension + 1);
+	std::vector<float> buffer(max_dimension);
+	
+	// Transform along the columns and then along the rows.
+	for (int x = 0; x < width; ++x) {
+		transform(&squared_distances_[x], height, width, v, z, buffer);
+	}
+	for (int y = 0; y < height; ++y) {
+		transform(&squared_distances_[y * width], width, 1, v, z, buffer);
+	}
+}
+
+void DistanceField::transform(float* f, int n, int stride, std::vector<int>& v, std::vector<float>& z, std::vector<float>& buffer)
+{
+	for (int q = 0; q < n; ++q) {
+		buffer[q] = f[q * stride];
+	}
+	
+	// Compute the lower envelope of the parabolas rooted at each sample.
+	int k = 0;
+	v[0] = 0;
+	z[0] = -std::numeric_limits<float>::max();
+	z[1] = std::numeric_limits<float>::max();
+	for (int q = 1; q < n; ++q) {
+		float s = ((buffer[q] + q * q) - (buffer[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+		while (s <= z[k]) {
+			--k;
+			s = ((buffer[q] + q * q) - (buffer[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = std::numeric_limits<float>::max();
+	}
+	
+	// Read the distances from the lower envelope.
+	k = 0;
+	for (int q = 0; q < n; ++q) {
+		while (z[k + 1] < q) {
+			++k;
+		}
+		f[q * stride] = (q - v[k]) * (q - v[k]) + buffer[v[k]];
+	}
+}
+
+float DistanceField::getDistance(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= (int)info_.width || y >= (int)info_.height) {
+		return -1.0f;
+	}
+	
+	float squared_distance = squared_distances_[x + y * info_.width];
+	if (squared_distance >= INFINITE_DISTANCE) {
+		return std::numeric_limits<float>::max();
+	}
+	return sqrt(squared_distance) * info_.resolution;
+}
+
+float DistanceField::getDistance(const geometry_msgs::Point& point) const
+{
+	if (!isInitialised()) {
+		return -1.0f;
+	}
+	occupancy_grid_utils::Cell cell = occupancy_grid_utils::pointCell(info_, point);
+	return getDistance(cell.x, cell.y);
+}
+
+bool DistanceField::isBlocked(const geometry_msgs::Point& point, float min_distance) const
+{
+	float distance = getDistance(point);
+	return distance < 0 || distance <= min_distance;
+}
+
+};
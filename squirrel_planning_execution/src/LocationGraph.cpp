@@ -0,0 +1,112 @@
+#include <squirrel_planning_execution/LocationGraph.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+
+namespace KCL_rosplan {
+
+LocationGraph::LocationGraph()
+	: complete_(true), nr_locations_(0)
+{
+
+}
+
+void LocationGraph::setComplete(unsigned int nr_locations)
+{
+	complete_ = true;
+	nr_locations_ = nr_locations;
+	offsets_.clear();
+	targets_.clear();
+}
+
+void LocationGraph::setEdges(unsigned int nr_locations, const std::vector<std::pair<unsigned int, unsigned int> >& edges)
+{
+	complete_ = false;
+	nr_locations_ = nr_locations;
+
+	std::vector<std::pair<unsigned int, unsigned int> > sorted_edges;
+	sorted_edges.reserve(edges.size());
+	for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator ci = edges.begin(); ci != edges.end(); ++ci) {
+		if ((*ci).first != (*ci).second && (*ci).first < nr_locations && (*ci).second < nr_locations) {
+			sorted_edges.push_back(*ci);
+		}
+	}
+	std::sort(sorted_edges.begin(), sorted_edges.end());
+	sorted_edges.erase(std::unique(sorted_edges.begin(), sorted_edges.end()), sorted_edges.end());
+
+	offsets_.assign(nr_locations + 1, 0);
+	targets_.resize(sorted_edges.size());
+	for (unsigned int i = 0; i < sorted_edges.size(); ++i) {
+		++offsets_[sorted_edges[i].first + 1];
+		targets_[i] = sorted_edges[i].second;
+	}
+	for (unsigned int i = 0; i < nr_locations; ++i) {
+		offsets_[i + 1] += offsets_[i];
+	}
+}
+
+void LocationGraph::setEdges(const std::vector<std::string>& names, const std::vector<std::pair<std::string, std::string> >& connections)
+{
+	if (connections.empty()) {
+		setComplete(names.size());
+		return;
+	}
+
+	std::map<std::string, std::vector<unsigned int> > indices;
+	for (unsigned int i = 0; i < names.size(); ++i) {
+		indices[names[i]].push_back(i);
+	}
+
+	std::map<std::string, std::vector<std::string> > roadmap;
+	for (std::vector<std::pair<std::string, std::string> >::const_iterator ci = connections.begin(); ci != connections.end(); ++ci) {
+		roadmap[(*ci).first].push_back((*ci).second);
+	}
+
+	// Search the roadmap from every location, through the waypoints that are not locations, and connect it to 
+	// the locations that are found.
+	std::vector<std::pair<unsigned int, unsigned int> > edges;
+	for (std::map<std::string, std::vector<unsigned int> >::const_iterator from = indices.begin(); from != indices.end(); ++from) {
+		std::set<std::string> visited;
+		visited.insert((*from).first);
+		std::deque<std::string> open_list;
+		open_list.push_back((*from).first);
+		while (!open_list.empty()) {
+			std::map<std::string, std::vector<std::string> >::const_iterator waypoint = roadmap.find(open_list.front());
+			open_list.pop_front();
+			if (waypoint == roadmap.end()) {
+				continue;
+			}
+
+			for (std::vector<std::string>::const_iterator ci = (*waypoint).second.begin(); ci != (*waypoint).second.end(); ++ci) {
+				if (!visited.insert(*ci).second) {
+					continue;
+				}
+
+				std::map<std::string, std::vector<unsigned int> >::const_iterator to = indices.find(*ci);
+				if (to == indices.end()) {
+					open_list.push_back(*ci);
+					continue;
+				}
+
+				for (std::vector<unsigned int>::const_iterator fi = (*from).second.begin(); fi != (*from).second.end(); ++fi) {
+					for (std::vector<unsigned int>::const_iterator ti = (*to).second.begin(); ti != (*to).second.end(); ++ti) {
+						edges.push_back(std::make_pair(*fi, *ti));
+					}
+				}
+			}
+		}
+	}
+	setEdges(names.size(), edges);
+}
+
+bool LocationGraph::isConnected(unsigned int from, unsigned int to) const
+{
+	if (complete_) {
+		return from < nr_locations_ && to < nr_locations_;
+	}
+	return std::binary_search(targets_.begin() + offsets_[from], targets_.begin() + offsets_[from + 1], to);
+}
+
+};
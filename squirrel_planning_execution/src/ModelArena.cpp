@@ -0,0 +1,66 @@
+#include <squirrel_planning_execution/ModelArena.h>
+
+#include <algorithm>
+
+namespace KCL_rosplan {
+
+// Enough for every member of the model: pointers, doubles and the standard containers.
+static const std::size_t ALIGNMENT = 2 * sizeof(void*);
+
+ModelArena::ModelArena(std::size_t block_size)
+	: block_size_(block_size), next_(NULL), remaining_(0), memory_usage_(0)
+{
+
+}
+
+ModelArena::~ModelArena()
+{
+	release();
+}
+
+void ModelArena::release()
+{
+	// Later objects may refer to earlier ones, so they go first.
+	for (std::vector<std::pair<void (*)(void*), void*> >::reverse_iterator ri = finalisers_.rbegin(); ri != finalisers_.rend(); ++ri) {
+		(*ri).first((*ri).second);
+	}
+	finalisers_.clear();
+
+	for (std::vector<char*>::const_iterator ci = blocks_.begin(); ci != blocks_.end(); ++ci) {
+		delete[] *ci;
+	}
+	blocks_.clear();
+	next_ = NULL;
+	remaining_ = 0;
+	memory_usage_ = 0;
+	names_.clear();
+}
+
+const std::string& ModelArena::intern(const std::string& name)
+{
+	return *names_.insert(name).first;
+}
+
+void* ModelArena::allocate(std::size_t size)
+{
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	if (size > remaining_) {
+		// A large object gets a block of its own, the current block stays in use for the small ones.
+		std::size_t block_size = std::max(size, block_size_);
+		char* block = new char[block_size];
+		blocks_.push_back(block);
+		memory_usage_ += block_size;
+		if (block_size > block_size_) {
+			return block;
+		}
+		next_ = block;
+		remaining_ = block_size;
+	}
+
+	void* memory = next_;
+	next_ += size;
+	remaining_ -= size;
+	return memory;
+}
+
+};
@@ -0,0 +1,107 @@
+#include <squirrel_planning_execution/PDDLWriter.h>
+
+#include <stdio.h>
+
+namespace KCL_rosplan {
+
+PDDLWriter::PDDLWriter(std::size_t capacity)
+{
+	buffer_.reserve(capacity);
+}
+
+PDDLWriter& PDDLWriter::operator<<(int value)
+{
+	char text[32];
+	buffer_.append(text, snprintf(text, sizeof(text), "%d", value));
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::operator<<(unsigned int value)
+{
+	char text[32];
+	buffer_.append(text, snprintf(text, sizeof(text), "%u", value));
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::operator<<(long value)
+{
+	char text[32];
+	buffer_.append(text, snprintf(text, sizeof(text), "%ld", value));
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::operator<<(unsigned long value)
+{
+	char text[32];
+	buffer_.append(text, snprintf(text, sizeof(text), "%lu", value));
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::operator<<(double value)
+{
+	// The same format a std::ostream uses by default.
+	char text[32];
+	buffer_.append(text, snprintf(text, sizeof(text), "%g", value));
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::operator<<(std::ostream& (*manipulator)(std::ostream&))
+{
+	if (manipulator == static_cast<std::ostream& (*)(std::ostream&)>(std::endl)) {
+		buffer_.push_back('\n');
+	}
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::fact(unsigned int depth, const std::string& predicate, const std::string& a)
+{
+	indent(depth);
+	buffer_.push_back('(');
+	buffer_.append(predicate).append(1, ' ').append(a);
+	buffer_.append(")\n");
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::fact(unsigned int depth, const std::string& predicate, const std::string& a, const std::string& b)
+{
+	indent(depth);
+	buffer_.push_back('(');
+	buffer_.append(predicate).append(1, ' ').append(a).append(1, ' ').append(b);
+	buffer_.append(")\n");
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::fact(unsigned int depth, const std::string& predicate, const std::string& a, const std::string& b, const std::string& c)
+{
+	indent(depth);
+	buffer_.push_back('(');
+	buffer_.append(predicate).append(1, ' ').append(a).append(1, ' ').append(b).append(1, ' ').append(c);
+	buffer_.append(")\n");
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::beginAction(const std::string& name)
+{
+	buffer_.append("(:action ").append(name);
+	buffer_.push_back('\n');
+	return *this;
+}
+
+PDDLWriter& PDDLWriter::parameters(const std::string& parameters)
+{
+	buffer_.append("\t:parameters (").append(parameters);
+	buffer_.append(")\n");
+	return *this;
+}
+
+bool PDDLWriter::writeToFile(const std::string& file_name) const
+{
+	FILE* file = fopen(file_name.c_str(), "wb");
+	if (file == NULL) {
+		return false;
+	}
+	bool written = fwrite(buffer_.data(), 1, buffer_.size(), file) == buffer_.size();
+	return fclose(file) == 0 && written;
+}
+
+};
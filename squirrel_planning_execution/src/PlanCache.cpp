@@ -0,0 +1,307 @@
+#include <squirrel_planning_execution/PlanCache.h>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+
+namespace KCL_rosplan {
+
+namespace {
+
+	const char* INPUTS_FILE = "inputs";
+	const char* DOMAIN_FILE = "domain.pddl";
+	const char* PROBLEM_FILE = "problem.pddl";
+	const char* PLAN_FILE = "plan.pddl";
+	const char* PENDING_PLAN_FILE = "plan.pending";
+
+	std::string toString(std::size_t value)
+	{
+		std::stringstream ss;
+		ss << value;
+		return ss.str();
+	}
+
+	bool copyFile(const std::string& from, const std::string& to)
+	{
+		std::ifstream in(from.c_str(), std::ios::binary);
+		if (!in.is_open()) {
+			return false;
+		}
+		std::ofstream out(to.c_str(), std::ios::binary | std::ios::trunc);
+		if (!out.is_open()) {
+			return false;
+		}
+		out << in.rdbuf();
+		return out.good();
+	}
+
+	bool readFile(const std::string& file_name, std::string& content)
+	{
+		std::ifstream in(file_name.c_str(), std::ios::binary);
+		if (!in.is_open()) {
+			return false;
+		}
+		std::stringstream ss;
+		ss << in.rdbuf();
+		content = ss.str();
+		return true;
+	}
+
+	bool isComplete(const boost::filesystem::path& entry)
+	{
+		return boost::filesystem::exists(entry / INPUTS_FILE) && boost::filesystem::exists(entry / DOMAIN_FILE) &&
+		       boost::filesystem::exists(entry / PROBLEM_FILE) && boost::filesystem::exists(entry / PLAN_FILE);
+	}
+
+	bool isMoreRecent(const std::pair<std::time_t, std::string>& lhs, const std::pair<std::time_t, std::string>& rhs)
+	{
+		return lhs.first > rhs.first;
+	}
+};
+
+/*--------*/
+/* Inputs */
+/*--------*/
+
+PlanCache::Inputs::Inputs(const std::string& generator)
+{
+	add(generator);
+}
+
+PlanCache::Inputs& PlanCache::Inputs::add(const std::string& value)
+{
+	canonical_ += toString(value.size());
+	canonical_ += ':';
+	canonical_ += value;
+	canonical_ += ';';
+	return *this;
+}
+
+PlanCache::Inputs& PlanCache::Inputs::add(unsigned int value)
+{
+	canonical_ += toString(value);
+	canonical_ += ';';
+	return *this;
+}
+
+PlanCache::Inputs& PlanCache::Inputs::add(const std::vector<std::string>& values)
+{
+	canonical_ += '[';
+	add((unsigned int)values.size());
+	for (std::vector<std::string>::const_iterator ci = values.begin(); ci != values.end(); ++ci) {
+		add(*ci);
+	}
+	canonical_ += ']';
+	return *this;
+}
+
+PlanCache::Inputs& PlanCache::Inputs::add(const std::map<std::string, std::string>& mapping)
+{
+	canonical_ += '{';
+	add((unsigned int)mapping.size());
+	for (std::map<std::string, std::string>::const_iterator ci = mapping.begin(); ci != mapping.end(); ++ci) {
+		add((*ci).first);
+		add((*ci).second);
+	}
+	canonical_ += '}';
+	return *this;
+}
+
+PlanCache::Inputs& PlanCache::Inputs::add(const std::map<std::string, std::vector<std::string> >& mapping)
+{
+	canonical_ += '{';
+	add((unsigned int)mapping.size());
+	for (std::map<std::string, std::vector<std::string> >::const_iterator ci = mapping.begin(); ci != mapping.end(); ++ci) {
+		add((*ci).first);
+		add((*ci).second);
+	}
+	canonical_ += '}';
+	return *this;
+}
+
+PlanCache::Inputs& PlanCache::Inputs::add(const std::vector<std::pair<std::string, std::string> >& pairs)
+{
+	canonical_ += '[';
+	add((unsigned int)pairs.size());
+	for (std::vector<std::pair<std::string, std::string> >::const_iterator ci = pairs.begin(); ci != pairs.end(); ++ci) {
+		add((*ci).first);
+		add((*ci).second);
+	}
+	canonical_ += ']';
+	return *this;
+}
+
+std::string PlanCache::Inputs::getHash() const
+{
+	boost::uint64_t hash = 0xcbf29ce484222325ULL;
+	for (std::string::const_iterator ci = canonical_.begin(); ci != canonical_.end(); ++ci) {
+		hash ^= (unsigned char)*ci;
+		hash *= 0x100000001b3ULL;
+	}
+
+	std::stringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return ss.str();
+}
+
+/*-----------*/
+/* PlanCache */
+/*-----------*/
+
+PlanCache::PlanCache()
+	: max_entries_(0), hits_(0), misses_(0)
+{
+
+}
+
+bool PlanCache::configure(const std::string& cache_path, unsigned int max_entries)
+{
+	cache_path_ = cache_path;
+	max_entries_ = max_entries;
+	lru_.clear();
+	entries_.clear();
+	if (max_entries_ == 0) {
+		return false;
+	}
+
+	boost::system::error_code error;
+	boost::filesystem::create_directories(cache_path_, error);
+	if (error || !boost::filesystem::is_directory(cache_path_, error)) {
+		max_entries_ = 0;
+		return false;
+	}
+
+	// Entries that never got a plan are left behind by planners that failed or were interrupted.
+	std::vector<std::pair<std::time_t, std::string> > complete_entries;
+	for (boost::filesystem::directory_iterator di(cache_path_, error), end; !error && di != end; di.increment(error)) {
+		const boost::filesystem::path& entry = (*di).path();
+		if (!boost::filesystem::is_directory(entry)) {
+			continue;
+		}
+		if (isComplete(entry)) {
+			complete_entries.push_back(std::make_pair(boost::filesystem::last_write_time(entry), entry.filename().string()));
+		} else {
+			boost::filesystem::remove_all(entry, error);
+		}
+	}
+
+	std::sort(complete_entries.begin(), complete_entries.end(), isMoreRecent);
+	for (std::vector<std::pair<std::time_t, std::string> >::const_iterator ci = complete_entries.begin(); ci != complete_entries.end(); ++ci) {
+		lru_.push_back((*ci).second);
+		entries_[(*ci).second] = --lru_.end();
+	}
+	evict();
+	return true;
+}
+
+bool PlanCache::restore(const Inputs& inputs, const std::string& domain_path, const std::string& problem_path)
+{
+	if (!isEnabled()) {
+		return false;
+	}
+
+	const std::string hash = inputs.getHash();
+	std::map<std::string, std::list<std::string>::iterator>::iterator entry = entries_.find(hash);
+	if (entry == entries_.end()) {
+		++misses_;
+		return false;
+	}
+
+	// Guard against a collision of the hashes.
+	const boost::filesystem::path entry_path(getEntryPath(hash));
+	std::string stored_inputs;
+	if (!readFile((entry_path / INPUTS_FILE).string(), stored_inputs) || stored_inputs != inputs.str() ||
+	    !copyFile((entry_path / DOMAIN_FILE).string(), domain_path) ||
+	    !copyFile((entry_path / PROBLEM_FILE).string(), problem_path)) {
+		++misses_;
+		return false;
+	}
+
+	lru_.splice(lru_.begin(), lru_, (*entry).second);
+	boost::system::error_code error;
+	boost::filesystem::last_write_time(entry_path, std::time(NULL), error);
+	++hits_;
+	return true;
+}
+
+bool PlanCache::store(const Inputs& inputs, const std::string& domain_path, const std::string& problem_path)
+{
+	if (!isEnabled()) {
+		return false;
+	}
+
+	const std::string hash = inputs.getHash();
+	std::map<std::string, std::list<std::string>::iterator>::iterator entry = entries_.find(hash);
+	if (entry != entries_.end()) {
+		lru_.erase((*entry).second);
+		entries_.erase(entry);
+	}
+
+	const boost::filesystem::path entry_path(getEntryPath(hash));
+	boost::system::error_code error;
+	boost::filesystem::remove_all(entry_path, error);
+	boost::filesystem::create_directories(entry_path, error);
+	if (error) {
+		return false;
+	}
+
+	std::ofstream out((entry_path / INPUTS_FILE).string().c_str(), std::ios::binary | std::ios::trunc);
+	out << inputs.str();
+	out.close();
+
+	return out.good() && copyFile(domain_path, (entry_path / DOMAIN_FILE).string()) && copyFile(problem_path, (entry_path / PROBLEM_FILE).string());
+}
+
+bool PlanCache::commitPlan(const std::string& hash)
+{
+	if (!isEnabled() || entries_.find(hash) != entries_.end()) {
+		return false;
+	}
+
+	const boost::filesystem::path entry_path(getEntryPath(hash));
+	boost::system::error_code error;
+	if (boost::filesystem::file_size(entry_path / PENDING_PLAN_FILE, error) == 0 || error) {
+		return false;
+	}
+	boost::filesystem::rename(entry_path / PENDING_PLAN_FILE, entry_path / PLAN_FILE, error);
+	if (error || !isComplete(entry_path)) {
+		return false;
+	}
+
+	lru_.push_front(hash);
+	entries_[hash] = lru_.begin();
+	evict();
+	return true;
+}
+
+std::string PlanCache::getPlanPath(const std::string& hash) const
+{
+	return (boost::filesystem::path(getEntryPath(hash)) / PLAN_FILE).string();
+}
+
+std::string PlanCache::getPendingPlanPath(const std::string& hash) const
+{
+	return (boost::filesystem::path(getEntryPath(hash)) / PENDING_PLAN_FILE).string();
+}
+
+void PlanCache::evict()
+{
+	boost::system::error_code error;
+	while (lru_.size() > max_entries_) {
+		boost::filesystem::remove_all(getEntryPath(lru_.back()), error);
+		entries_.erase(lru_.back());
+		lru_.pop_back();
+	}
+}
+
+std::string PlanCache::getEntryPath(const std::string& hash) const
+{
+	return (boost::filesystem::path(cache_path_) / hash).string();
+}
+
+};
@@ -33,6 +33,37 @@ namespace KCL_rosplan {
 			marker.text = wit->first;
 			marker_array.markers.push_back(marker);
 		}
+
+		// every edge of the roadmap once, as one line list
+		visualization_msgs::Marker edges;
+		edges.header.frame_id = fixed_frame;
+		edges.header.stamp = ros::Time();
+		edges.ns = "roadmap_edge";
+		edges.id = 0;
+		edges.type = visualization_msgs::Marker::LINE_LIST;
+		edges.action = visualization_msgs::Marker::MODIFY;
+		edges.pose.orientation.w = 1.0;
+		edges.scale.x = 0.02;
+		edges.color.a = 0.8;
+		edges.color.r = 0.3;
+		edges.color.g = 0.3;
+		edges.color.b = 1.0;
+		for (std::map<std::string, Waypoint*>::iterator wit=waypoints.begin(); wit!=waypoints.end(); ++wit) {
+			for (std::vector<std::string>::const_iterator nit = wit->second->neighbours.begin(); nit != wit->second->neighbours.end(); ++nit) {
+				if (*nit < wit->first)
+					continue;
+				geometry_msgs::Point p;
+				p.x = wit->second->real_x;
+				p.y = wit->second->real_y;
+				edges.points.push_back(p);
+				p.x = waypoints[*nit]->real_x;
+				p.y = waypoints[*nit]->real_y;
+				edges.points.push_back(p);
+			}
+		}
+		if (!edges.points.empty())
+			marker_array.markers.push_back(edges);
+
 		waypoints_pub.publish( marker_array );
 	}
 	/* clears all waypoints and edges */
@@ -49,6 +80,13 @@ namespace KCL_rosplan {
 			marker.action = visualization_msgs::Marker::DELETE;
 			marker_array.markers.push_back(marker);
 		}
+		visualization_msgs::Marker edges;
+		edges.header.frame_id = fixed_frame;
+		edges.header.stamp = ros::Time();
+		edges.ns = "roadmap_edge";
+		edges.id = 0;
+		edges.action = visualization_msgs::Marker::DELETE;
+		marker_array.markers.push_back(edges);
 		waypoints_pub.publish( marker_array );
 	}
 }
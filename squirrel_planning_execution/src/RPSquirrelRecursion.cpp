@@ -1,7 +1,12 @@
 #include <std_msgs/Int8.h>
+#include <std_msgs/Float32MultiArray.h>
+#include <std_msgs/Int32MultiArray.h>
+#include <tf/transform_listener.h>
 
 #include <map>
+#include <set>
 #include <algorithm>
+#include <limits>
 #include <string>
 #include <sstream>
 
@@ -10,6 +15,8 @@
 #include "squirrel_planning_execution/ContingentTacticalClassifyPDDLGenerator.h"
 #include "squirrel_planning_execution/ContingentTidyPDDLGenerator.h"
 #include "squirrel_planning_execution/ViewConeGenerator.h"
+#include "squirrel_planning_execution/DistanceField.h"
+#include "squirrel_planning_execution/TourPlanner.h"
 #include "squirrel_planning_execution/ClassicalTidyPDDLGenerator.h"
 #include "pddl_actions/ShedKnowledgePDDLAction.h"
 #include "pddl_actions/FinaliseClassificationPDDLAction.h"
@@ -27,7 +34,7 @@ namespace KCL_rosplan {
 	/*-------------*/
 
 	RPSquirrelRecursion::RPSquirrelRecursion(ros::NodeHandle &nh)
-		: node_handle(&nh), message_store(nh), initial_problem_generated(false), simulated(false)
+		: node_handle(&nh), message_store(nh), tour_planner(NULL), plan_cache_hit(false), initial_problem_generated(false), simulated(false), approach_clearance(0.25), view_cone_time_budget(0)
 	{
 		// knowledge interface
 		update_knowledge_client = nh.serviceClient<rosplan_knowledge_msgs::KnowledgeUpdateService>("/kcl_rosplan/update_knowledge_base");
@@ -47,12 +54,112 @@ namespace KCL_rosplan {
 
 		nh.getParam("/squirrel_planning_execution/simulated", simulated);
 		
+		// Cache the domain, problem and plan of every sub-problem under the hash of the inputs of its generator, 
+		// keeping at most plan_cache_size entries (0 = no cache).
+		std::string data_path;
+		nh.getParam("/data_path", data_path);
+		std::string plan_cache_path = data_path + "plan_cache/";
+		int plan_cache_size = 64;
+		nh.param("plan_cache_path", plan_cache_path, plan_cache_path);
+		nh.param("plan_cache_size", plan_cache_size, plan_cache_size);
+		if (plan_cache.configure(plan_cache_path, std::max(plan_cache_size, 0))) {
+			ROS_INFO("KCL: (RPSquirrelRecursion) Plan cache at %s holds %u of at most %d entries.", plan_cache_path.c_str(), plan_cache.getNrEntries(), plan_cache_size);
+		} else if (plan_cache_size > 0) {
+			ROS_WARN("KCL: (RPSquirrelRecursion) Could not create the plan cache at %s, every problem is planned for.", plan_cache_path.c_str());
+		}
+		plan_cache_statistics_pub = nh.advertise<std_msgs::Int32MultiArray>("/kcl_rosplan/plan_cache_statistics", 1, true);
+		publishPlanCacheStatistics();
+		
 		
 		if (!simulated)
 		{
 			std::string occupancyTopic("/map");
 			nh.param("occupancy_topic", occupancyTopic, occupancyTopic);
 			view_cone_generator = new ViewConeGenerator(nh, occupancyTopic);
+			
+			// The clearance that is required around the poses from where the robot grasps or pushes objects.
+			nh.param("approach_pose_clearance", approach_clearance, approach_clearance);
+			
+			// Number of threads used to evaluate view cones (0 = one per core) and the seed of the sampler.
+			int view_cone_threads = 0;
+			nh.param("view_cone_threads", view_cone_threads, view_cone_threads);
+			view_cone_generator->setNumberOfThreads(view_cone_threads);
+			
+			// The travel costs between the view poses are computed with the same number of threads.
+			tour_planner = new TourPlanner();
+			tour_planner->setNumberOfThreads(view_cone_threads);
+			exploration_travel_costs_pub = nh.advertise<std_msgs::Float32MultiArray>("/kcl_rosplan/exploration_travel_costs", 1, true);
+			exploration_tour_pub = nh.advertise<std_msgs::Int32MultiArray>("/kcl_rosplan/exploration_tour", 1, true);
+			
+			int view_cone_seed = 0;
+			if (nh.getParam("view_cone_seed", view_cone_seed)) {
+				view_cone_generator->setSeed(view_cone_seed);
+			}
+			
+			// How the view cones are selected, either "random_restart" or "lazy_greedy". The pool size is only 
+			// used by the latter (0 = 10 times the sample size).
+			std::string view_cone_strategy("random_restart");
+			nh.param("view_cone_strategy", view_cone_strategy, view_cone_strategy);
+			view_cone_generator->setSelectionStrategy(view_cone_strategy == "lazy_greedy" ? ViewConeGenerator::LAZY_GREEDY : ViewConeGenerator::RANDOM_RESTART);
+			
+			int view_cone_pool_size = 0;
+			nh.param("view_cone_pool_size", view_cone_pool_size, view_cone_pool_size);
+			view_cone_generator->setCandidatePoolSize(view_cone_pool_size);
+			
+			// How the positions of the view cones are sampled: "rejection", "uniform" or "stratified".
+			std::string view_cone_sampling("stratified");
+			nh.param("view_cone_sampling", view_cone_sampling, view_cone_sampling);
+			if (view_cone_sampling == "rejection") {
+				view_cone_generator->setSamplingStrategy(ViewConeGenerator::REJECTION_SAMPLING);
+			} else if (view_cone_sampling == "uniform") {
+				view_cone_generator->setSamplingStrategy(ViewConeGenerator::ADMISSIBLE_UNIFORM);
+			} else {
+				view_cone_generator->setSamplingStrategy(ViewConeGenerator::ADMISSIBLE_STRATIFIED);
+			}
+			
+			// Restrict the yaw of the view cones to a number of bins (0 = continuous), optionally trying all of them.
+			int view_cone_yaw_bins = 0;
+			bool view_cone_try_all_yaw_bins = false;
+			nh.param("view_cone_yaw_bins", view_cone_yaw_bins, view_cone_yaw_bins);
+			nh.param("view_cone_try_all_yaw_bins", view_cone_try_all_yaw_bins, view_cone_try_all_yaw_bins);
+			view_cone_generator->setYawBins(view_cone_yaw_bins, view_cone_try_all_yaw_bins);
+			
+			// Cap the time spent on exploration planning, the best view cones found so far are used when it runs out.
+			nh.param("view_cone_time_budget", view_cone_time_budget, view_cone_time_budget);
+			
+			// Only replace the view cones near the parts of the map that changed since the last exploration.
+			bool view_cone_incremental = true;
+			nh.param("view_cone_incremental", view_cone_incremental, view_cone_incremental);
+			view_cone_generator->setIncrementalReplanning(view_cone_incremental);
+			
+			// The rooms to explore, e.g. from a room segmentation: a list of polygons, each a list of [x, y] corners.
+			XmlRpc::XmlRpcValue regions;
+			if (nh.getParam("view_cone_regions", regions) && regions.getType() == XmlRpc::XmlRpcValue::TypeArray) {
+				for (int i = 0; i < regions.size(); ++i) {
+					if (regions[i].getType() != XmlRpc::XmlRpcValue::TypeArray) {
+						ROS_WARN("KCL: (RPSquirrelRecursion) Region %d is not a list of corners, it is ignored.", i);
+						continue;
+					}
+					std::vector<tf::Vector3> polygon;
+					for (int j = 0; j < regions[i].size(); ++j) {
+						XmlRpc::XmlRpcValue& corner = regions[i][j];
+						if (corner.getType() != XmlRpc::XmlRpcValue::TypeArray || corner.size() != 2) {
+							break;
+						}
+						double coordinates[2];
+						for (int k = 0; k < 2; ++k) {
+							coordinates[k] = corner[k].getType() == XmlRpc::XmlRpcValue::TypeInt ? (double)(int)corner[k] : (double)corner[k];
+						}
+						polygon.push_back(tf::Vector3(coordinates[0], coordinates[1], 0.0));
+					}
+					if (polygon.size() < 3 || polygon.size() != (unsigned int)regions[i].size()) {
+						ROS_WARN("KCL: (RPSquirrelRecursion) Region %d needs at least 3 corners of the form [x, y], it is ignored.", i);
+						continue;
+					}
+					view_cone_regions.push_back(polygon);
+				}
+				ROS_INFO("KCL: (RPSquirrelRecursion) Loaded %lu regions to explore.", view_cone_regions.size());
+			}
 		}
 		else
 		{
@@ -307,6 +414,15 @@ namespace KCL_rosplan {
 			return;
 		}
 		
+		// Serve the plan from the cache, or keep a copy of the output of the planner so it can be added to the cache.
+		const std::string cache_hash = plan_cache_hash;
+		const bool cache_hit = plan_cache_hit;
+		if (cache_hit) {
+			planner_command = "cat " + plan_cache.getPlanPath(cache_hash);
+		} else if (!cache_hash.empty()) {
+			planner_command += " | tee " + plan_cache.getPendingPlanPath(cache_hash);
+		}
+		
 		planner_instance.startPlanner(domain_name, problem_name, data_path, planner_command);
 		
 		// publish feedback (enabled)
@@ -327,6 +443,11 @@ namespace KCL_rosplan {
 
 		if(state == actionlib::SimpleClientGoalState::SUCCEEDED) {
 			
+			if (!cache_hit && !cache_hash.empty() && plan_cache.commitPlan(cache_hash)) {
+				ROS_INFO("KCL: (RPSquirrelRecursion) Added the plan for %s to the plan cache (%s).", action_name.c_str(), cache_hash.c_str());
+				publishPlanCacheStatistics();
+			}
+			
 			// Update the knowledge base with what has been achieved.
 			if ("explore_area" == action_name)
 			{
@@ -608,6 +729,112 @@ namespace KCL_rosplan {
 		ROS_INFO("KCL: (RPSquirrelRecursion) Added the goal (tidy room) to the knowledge base.");
 	}
 	
+	geometry_msgs::Pose RPSquirrelRecursion::findApproachPose(const geometry_msgs::Point& target, float distance) const
+	{
+		boost::shared_ptr<const DistanceField> distance_field = view_cone_generator->getDistanceField();
+		
+		// Try a number of angles around the target, starting at a random one.
+		const unsigned int nr_angles = 16;
+		float start_angle = ((float)rand() / (float)RAND_MAX) * 2 * M_PI;
+		
+		geometry_msgs::Pose best_pose;
+		float best_clearance = -std::numeric_limits<float>::max();
+		for (unsigned int i = 0; i < nr_angles; ++i)
+		{
+			float angle = start_angle + i * 2 * M_PI / nr_angles;
+			
+			// The pose faces the target.
+			geometry_msgs::Pose pose;
+			pose.position.x = target.x + distance * cos(angle);
+			pose.position.y = target.y + distance * sin(angle);
+			pose.position.z = 0.0f;
+			
+			tf::Quaternion rotation(tf::Vector3(0, 0, 1), angle + M_PI);
+			pose.orientation.x = rotation.x();
+			pose.orientation.y = rotation.y();
+			pose.orientation.z = rotation.z();
+			pose.orientation.w = rotation.w();
+			
+			float clearance = distance_field->getDistance(pose.position);
+			if (clearance >= approach_clearance)
+			{
+				return pose;
+			}
+			
+			if (clearance > best_clearance)
+			{
+				best_clearance = clearance;
+				best_pose = pose;
+			}
+		}
+		
+		ROS_WARN("KCL: (RPSquirrelRecursion) Could not find a pose %f metres from (%f, %f) that is %f metres from any obstacle, the best pose has a clearance of %f metres.", distance, target.x, target.y, approach_clearance, best_clearance);
+		return best_pose;
+	}
+	
+	void RPSquirrelRecursion::orderViewPoses(const std::vector<geometry_msgs::Pose>& view_poses, std::vector<unsigned int>& tour)
+	{
+		tour.clear();
+		for (unsigned int i = 0; i < view_poses.size(); ++i) {
+			tour.push_back(i);
+		}
+		
+		if (tour_planner == NULL || view_poses.size() < 2 || !view_cone_generator->hasReceivedOccupancyGrid()) {
+			return;
+		}
+		
+		// Start from where the robot is, or from the first view pose if it cannot be located.
+		std::vector<geometry_msgs::Point> waypoints;
+		geometry_msgs::PoseStamped robot_pose;
+		try {
+			tf::TransformListener tfl;
+			geometry_msgs::PoseStamped base_pose;
+			base_pose.header.frame_id = "/base_link";
+			base_pose.header.stamp = ros::Time(0);
+			base_pose.pose.orientation.w = 1.0;
+			tfl.waitForTransform("/map", "/base_link", ros::Time(0), ros::Duration(1.0));
+			tfl.transformPose("/map", base_pose, robot_pose);
+			waypoints.push_back(robot_pose.pose.position);
+		} catch (tf::TransformException& ex) {
+			ROS_WARN("KCL: (RPSquirrelRecursion) Could not locate the robot, the tour starts at the first view pose: %s", ex.what());
+			waypoints.push_back(view_poses[0].position);
+		}
+		for (std::vector<geometry_msgs::Pose>::const_iterator ci = view_poses.begin(); ci != view_poses.end(); ++ci) {
+			waypoints.push_back((*ci).position);
+		}
+		
+		// The same occupancy threshold as the view cones, so every view pose is reachable through free cells.
+		ros::WallTime start_time = ros::WallTime::now();
+		tour_planner->computeTravelCosts(*view_cone_generator->getOccupancyGrid(), 5, waypoints);
+		std::vector<unsigned int> waypoint_tour;
+		float cost = tour_planner->findTour(0, waypoint_tour);
+		
+		tour.clear();
+		for (unsigned int i = 1; i < waypoint_tour.size(); ++i) {
+			tour.push_back(waypoint_tour[i] - 1);
+		}
+		ROS_INFO("KCL: (RPSquirrelRecursion) Ordered %lu view poses, the tour is %f metres long (%f seconds).", view_poses.size(), cost, (ros::WallTime::now() - start_time).toSec());
+		
+		std_msgs::Float32MultiArray travel_costs;
+		travel_costs.layout.dim.resize(2);
+		travel_costs.layout.dim[0].label = "from";
+		travel_costs.layout.dim[0].size = waypoints.size();
+		travel_costs.layout.dim[0].stride = waypoints.size() * waypoints.size();
+		travel_costs.layout.dim[1].label = "to";
+		travel_costs.layout.dim[1].size = waypoints.size();
+		travel_costs.layout.dim[1].stride = waypoints.size();
+		travel_costs.data = tour_planner->getTravelCosts();
+		exploration_travel_costs_pub.publish(travel_costs);
+		
+		std_msgs::Int32MultiArray tour_msg;
+		tour_msg.layout.dim.resize(1);
+		tour_msg.layout.dim[0].label = "waypoint";
+		tour_msg.layout.dim[0].size = waypoint_tour.size();
+		tour_msg.layout.dim[0].stride = waypoint_tour.size();
+		tour_msg.data.assign(waypoint_tour.begin(), waypoint_tour.end());
+		exploration_tour_pub.publish(tour_msg);
+	}
+	
 	bool RPSquirrelRecursion::createDomain(const std::string& action_name)
 	{
 		ROS_INFO("KCL: (RPSquirrelRecursion) Create domain for action %s.", action_name.c_str());
@@ -633,6 +860,12 @@ namespace KCL_rosplan {
 		std::string problem_path = ss.str();
 		ss.str(std::string());
 		
+		// The plan depends on the planner as well as on the inputs of the generator.
+		std::string planner_path;
+		node_handle->getParam("/planner_path", planner_path);
+		plan_cache_hash.clear();
+		plan_cache_hit = false;
+		
  		if (action_name == "explore_area") {
 			
 			//rviz things
@@ -644,16 +877,21 @@ namespace KCL_rosplan {
 			std::vector<geometry_msgs::Pose> view_poses;
 			if (!simulated)
 			{
-				std::vector<tf::Vector3> bounding_box;
-				tf::Vector3 p1(3.22, 4.36, 0.00);
-				tf::Vector3 p2(-0.5, 4.07, 0.00);
-				tf::Vector3 p3(3.49, 0.01, 0.00);
-				tf::Vector3 p4(-0.35, -0.09, 0.00);
-				bounding_box.push_back(p1);
-				bounding_box.push_back(p3);
-				bounding_box.push_back(p4);
-				bounding_box.push_back(p2);
-				view_cone_generator->createViewCones(view_poses, bounding_box, 3, 5, 30.0f, 2.0f, 100, 0.35f);
+				// Without a room segmentation, explore the default area.
+				std::vector<std::vector<tf::Vector3> > regions(view_cone_regions);
+				if (regions.empty()) {
+					std::vector<tf::Vector3> bounding_box;
+					tf::Vector3 p1(3.22, 4.36, 0.00);
+					tf::Vector3 p2(-0.5, 4.07, 0.00);
+					tf::Vector3 p3(3.49, 0.01, 0.00);
+					tf::Vector3 p4(-0.35, -0.09, 0.00);
+					bounding_box.push_back(p1);
+					bounding_box.push_back(p3);
+					bounding_box.push_back(p4);
+					bounding_box.push_back(p2);
+					regions.push_back(bounding_box);
+				}
+				view_cone_generator->createViewCones(view_poses, regions, 3, 5, 30.0f, 2.0f, 100, 0.35f, ros::WallDuration(view_cone_time_budget));
 			}
 			else
 			{
@@ -663,16 +901,21 @@ namespace KCL_rosplan {
 				view_poses.push_back(geometry_msgs::Pose());
 			}
 			
+			// Add the poses in the order they are best visited, the planner tends to follow the order of the goals.
+			std::vector<unsigned int> tour;
+			orderViewPoses(view_poses, tour);
+			
 			// Add these poses to the knowledge base.
 			rosplan_knowledge_msgs::KnowledgeUpdateService add_waypoints_service;
 			add_waypoints_service.request.update_type = rosplan_knowledge_msgs::KnowledgeUpdateService::Request::ADD_KNOWLEDGE;
 			
 			unsigned int waypoint_number = 0;
 			std::stringstream ss;
-			for (std::vector<geometry_msgs::Pose>::const_iterator ci = view_poses.begin(); ci != view_poses.end(); ++ci) {
+			for (std::vector<unsigned int>::const_iterator ti = tour.begin(); ti != tour.end(); ++ti) {
 				
+				std::vector<geometry_msgs::Pose>::const_iterator ci = view_poses.begin() + *ti;
 				ss.str(std::string());
-				ss << "explore_wp" << waypoint_number;
+				ss << "explore_wp" << *ti;
 				rosplan_knowledge_msgs::KnowledgeItem waypoint_knowledge;
 				add_waypoints_service.request.update_type = rosplan_knowledge_msgs::KnowledgeUpdateService::Request::ADD_KNOWLEDGE;
 				waypoint_knowledge.knowledge_type = rosplan_knowledge_msgs::KnowledgeItem::INSTANCE;
@@ -896,7 +1139,34 @@ namespace KCL_rosplan {
 			}
 			else
 			{
-				ContingentStrategicClassifyPDDLGenerator::createPDDL(data_path, domain_name, problem_name, robot_location, object_to_location_mappings, near_waypoint_mappings, 3);
+				// Connect the waypoints along the roadmap, the near waypoints have no position and are connected to 
+				// the waypoint of their object only.
+				std::vector<std::string> locations;
+				std::map<std::string, std::string> attached_locations;
+				locations.push_back(robot_location);
+				for (std::map<std::string, std::string>::const_iterator ci = object_to_location_mappings.begin(); ci != object_to_location_mappings.end(); ++ci) {
+					locations.push_back((*ci).second);
+					std::map<std::string, std::vector<std::string> >::const_iterator mi = near_waypoint_mappings.find((*ci).second);
+					if (mi == near_waypoint_mappings.end()) {
+						continue;
+					}
+					for (std::vector<std::string>::const_iterator ci2 = (*mi).second.begin(); ci2 != (*mi).second.end(); ++ci2) {
+						locations.push_back(*ci2);
+						attached_locations[*ci2] = (*ci).second;
+					}
+				}
+				
+				std::vector<std::pair<std::string, std::string> > connections;
+				if (!getRoadmapConnections(locations, std::map<std::string, geometry_msgs::Point>(), attached_locations, connections)) {
+					return false;
+				}
+				
+				PlanCache::Inputs inputs("ContingentStrategicClassify");
+				inputs.add(planner_path).add(robot_location).add(object_to_location_mappings).add(near_waypoint_mappings).add(3u).add(connections);
+				if (!restoreFromPlanCache(inputs, domain_path, problem_path)) {
+					ContingentStrategicClassifyPDDLGenerator::createPDDL(data_path, domain_name, problem_name, robot_location, object_to_location_mappings, near_waypoint_mappings, 3, connections);
+					storeInPlanCache(inputs, domain_path, problem_path);
+				}
 			}
 			
 		// Create the classify_object contingent domain and problem files.
@@ -1038,7 +1308,28 @@ namespace KCL_rosplan {
 			
 			ROS_INFO("KCL: (RPSquirrelRecursion) Kenny is at waypoint: %s", robot_location.c_str());
 			
-			ContingentTacticalClassifyPDDLGenerator::createPDDL(data_path, domain_name, problem_name, robot_location, observation_location_predicates, object_name, object_location);
+			// Connect the waypoints along the roadmap. The observation waypoints are not in the scene database, 
+			// and 'nowhere' is not driven to.
+			std::vector<std::string> locations;
+			std::map<std::string, geometry_msgs::Point> positions;
+			locations.push_back(robot_location);
+			locations.push_back(object_location);
+			for (unsigned int i = 0; i < getTaskPose.response.poses.size(); ++i) {
+				locations.push_back(observation_location_predicates[i]);
+				positions[observation_location_predicates[i]] = getTaskPose.response.poses[i].pose.pose.position;
+			}
+			
+			std::vector<std::pair<std::string, std::string> > connections;
+			if (!getRoadmapConnections(locations, positions, std::map<std::string, std::string>(), connections)) {
+				return false;
+			}
+			
+			PlanCache::Inputs inputs("ContingentTacticalClassify");
+			inputs.add(planner_path).add(robot_location).add(observation_location_predicates).add(object_name).add(object_location).add(connections);
+			if (!restoreFromPlanCache(inputs, domain_path, problem_path)) {
+				ContingentTacticalClassifyPDDLGenerator::createPDDL(data_path, domain_name, problem_name, robot_location, observation_location_predicates, object_name, object_location, connections);
+				storeInPlanCache(inputs, domain_path, problem_path);
+			}
 		} else if (action_name == "tidy_area") {
 			// Get all the objects in the knowledge base that are in this area. 
 			// TODO For now we assume there is only one area, so all objects in the knowledge base are relevant (unless already tidied).
@@ -1093,27 +1384,12 @@ namespace KCL_rosplan {
 					const geometry_msgs::PoseStamped &box_wp = *results[0];
 					box_to_pose_mapping[box_predicate] = box_wp.pose;
 					
-					// Create a waypoint 44 cm from this box at a random angle.
-					float angle = ((float)rand() / (float)RAND_MAX) * 360.0f;
-					tf::Vector3 v(0.44f, 0.0f, 0.0f);
-					v.rotate(tf::Vector3(0, 0, 1), angle);
-					v += tf::Vector3(box_wp.pose.position.x, box_wp.pose.position.y, 0.0f);
-					
-					tf::Quaternion v_rotation(tf::Vector3(0, 0, 1), angle + 180.0f);
-					
-					// Store this location in the knowledge base.
+					// Create a waypoint 44 cm from this box that is clear of obstacles.
 					geometry_msgs::PoseStamped near_pose;
 					near_pose.header.seq = 0;
 					near_pose.header.stamp = ros::Time::now();
 					near_pose.header.frame_id = "/map";
-					near_pose.pose.position.x = v.x();
-					near_pose.pose.position.y = v.y();
-					near_pose.pose.position.z = 0.0f;
-					
-					near_pose.pose.orientation.x = v_rotation.x();
-					near_pose.pose.orientation.y = v_rotation.y();
-					near_pose.pose.orientation.z = v_rotation.z();
-					near_pose.pose.orientation.w = v_rotation.w();
+					near_pose.pose = findApproachPose(box_wp.pose.position, 0.44f);
 					
 					std::string near_waypoint_mongodb_id(message_store.insertNamed(ss.str(), near_pose));
 				}
@@ -1344,27 +1620,12 @@ namespace KCL_rosplan {
 					
 					if (!simulated)
 					{
-						// Create a waypoint 43 cm from this box at a random angle.
-						float angle = ((float)rand() / (float)RAND_MAX) * 360.0f;
-						tf::Vector3 v(0.43f, 0.0f, 0.0f);
-						v.rotate(tf::Vector3(0, 0, 1), angle);
-						v += tf::Vector3(obj_pose.position.x, obj_pose.position.y, 0.0f);
-						
-						tf::Quaternion v_rotation(tf::Vector3(0, 0, 1), angle + 180.0f);
-						
-						// Store this location in the knowledge base.
+						// Create a waypoint 43 cm from this object that is clear of obstacles.
 						geometry_msgs::PoseStamped near_pose;
 						near_pose.header.seq = 0;
 						near_pose.header.stamp = ros::Time::now();
 						near_pose.header.frame_id = "/map";
-						near_pose.pose.position.x = v.x();
-						near_pose.pose.position.y = v.y();
-						near_pose.pose.position.z = 0.0f;
-						
-						near_pose.pose.orientation.x = v_rotation.x();
-						near_pose.pose.orientation.y = v_rotation.y();
-						near_pose.pose.orientation.z = v_rotation.z();
-						near_pose.pose.orientation.w = v_rotation.w();
+						near_pose.pose = findApproachPose(obj_pose.position, 0.43f);
 						
 						std::string near_waypoint_mongodb_id(message_store.insertNamed(ss.str(), near_pose));
 					}
@@ -1425,6 +1686,11 @@ namespace KCL_rosplan {
 						near_pose.pose.orientation.z = behind_robot_rotation.z();
 						near_pose.pose.orientation.w = behind_robot_rotation.w();
 						
+						if (view_cone_generator->getDistanceField()->isBlocked(near_pose.pose.position, approach_clearance))
+						{
+							ROS_WARN("KCL: (RPSquirrelRecursion) The pushing waypoint %s is within %f metres of an obstacle.", ss.str().c_str(), approach_clearance);
+						}
+						
 						std::string behind_robot_waypoint_mongodb_id(message_store.insertNamed(ss.str(), near_pose));
 					}
 					std::vector<std::string> pushing_waypoints;
@@ -1474,13 +1740,166 @@ namespace KCL_rosplan {
 				}
 			}
 			
-			ClassicalTidyPDDLGenerator::createPDDL(data_path, domain_name, problem_name, robot_location, object_to_location_mapping, grasping_waypoint_mappings, pushing_waypoint_mappings, object_to_type_mapping, box_to_location_mapping, box_to_type_mapping, near_box_location_mapping);
+			PlanCache::Inputs inputs("ClassicalTidy");
+			inputs.add(planner_path).add(robot_location).add(object_to_location_mapping).add(grasping_waypoint_mappings).add(pushing_waypoint_mappings);
+			inputs.add(object_to_type_mapping).add(box_to_location_mapping).add(box_to_type_mapping).add(near_box_location_mapping);
+			if (!restoreFromPlanCache(inputs, domain_path, problem_path)) {
+				ClassicalTidyPDDLGenerator::createPDDL(data_path, domain_name, problem_name, robot_location, object_to_location_mapping, grasping_waypoint_mappings, pushing_waypoint_mappings, object_to_type_mapping, box_to_location_mapping, box_to_type_mapping, near_box_location_mapping);
+				storeInPlanCache(inputs, domain_path, problem_path);
+			}
 		} else {
 			ROS_INFO("KCL: (RPSquirrelRecursion) Unable to create a domain for unknown action %s.", action_name.c_str());
 			return false;
 		}
 		return true;
 	}
+	
+	bool RPSquirrelRecursion::getRoadmapConnections(const std::vector<std::string>& locations, const std::map<std::string, geometry_msgs::Point>& positions, const std::map<std::string, std::string>& attached_locations, std::vector<std::pair<std::string, std::string> >& connections)
+	{
+		connections.clear();
+		
+		rosplan_knowledge_msgs::GetAttributeService get_attribute;
+		get_attribute.request.predicate_name = "connected";
+		if (!get_attribute_client.call(get_attribute)) {
+			ROS_ERROR("KCL: (RPSquirrelRecursion) Failed to recieve the attributes of the predicate 'connected'");
+			return false;
+		}
+		
+		std::set<std::string> roadmap_waypoints;
+		for (std::vector<rosplan_knowledge_msgs::KnowledgeItem>::const_iterator ci = get_attribute.response.attributes.begin(); ci != get_attribute.response.attributes.end(); ++ci) {
+			const rosplan_knowledge_msgs::KnowledgeItem& knowledge_item = *ci;
+			std::string from;
+			std::string to;
+			for (std::vector<diagnostic_msgs::KeyValue>::const_iterator ci = knowledge_item.values.begin(); ci != knowledge_item.values.end(); ++ci) {
+				const diagnostic_msgs::KeyValue& key_value = *ci;
+				if ("from" == key_value.key) {
+					from = key_value.value;
+				}
+				
+				if ("to" == key_value.key) {
+					to = key_value.value;
+				}
+			}
+			
+			if (from != "" && to != "") {
+				connections.push_back(std::make_pair(from, to));
+				roadmap_waypoints.insert(from);
+				roadmap_waypoints.insert(to);
+			}
+		}
+		
+		if (connections.empty()) {
+			ROS_INFO("KCL: (RPSquirrelRecursion) There is no roadmap, every waypoint is connected to every other waypoint.");
+			return true;
+		}
+		
+		// Find the positions of the locations that are not on the roadmap.
+		std::map<std::string, geometry_msgs::Point> unplaced_locations;
+		for (std::vector<std::string>::const_iterator ci = locations.begin(); ci != locations.end(); ++ci) {
+			const std::string& location = *ci;
+			if (roadmap_waypoints.count(location) != 0) {
+				continue;
+			}
+			
+			std::map<std::string, std::string>::const_iterator attached_location = attached_locations.find(location);
+			if (attached_location != attached_locations.end()) {
+				connections.push_back(std::make_pair(location, (*attached_location).second));
+				connections.push_back(std::make_pair((*attached_location).second, location));
+				continue;
+			}
+			
+			std::map<std::string, geometry_msgs::Point>::const_iterator position = positions.find(location);
+			if (position != positions.end()) {
+				unplaced_locations[location] = (*position).second;
+				continue;
+			}
+			
+			std::vector< boost::shared_ptr<geometry_msgs::PoseStamped> > results;
+			if (!message_store.queryNamed<geometry_msgs::PoseStamped>(location, results) || results.empty()) {
+				ROS_WARN("KCL: (RPSquirrelRecursion) Could not find the position of %s, every waypoint is connected to every other waypoint.", location.c_str());
+				connections.clear();
+				return true;
+			}
+			unplaced_locations[location] = results[0]->pose.position;
+		}
+		
+		// Connect them to the nearest roadmap waypoint, the positions of the roadmap are fetched in one query.
+		if (!unplaced_locations.empty()) {
+			mongo::BSONArrayBuilder names;
+			for (std::set<std::string>::const_iterator ci = roadmap_waypoints.begin(); ci != roadmap_waypoints.end(); ++ci)
+				names.append(*ci);
+			std::vector< std::pair<boost::shared_ptr<geometry_msgs::PoseStamped>, mongo::BSONObj> > results;
+			if (!message_store.queryWithMeta<geometry_msgs::PoseStamped>(results, mongo::BSONObj(), BSON("name" << BSON("$in" << names.arr()))) || results.empty()) {
+				ROS_WARN("KCL: (RPSquirrelRecursion) Could not find the positions of the roadmap, every waypoint is connected to every other waypoint.");
+				connections.clear();
+				return true;
+			}
+			
+			for (std::map<std::string, geometry_msgs::Point>::const_iterator ci = unplaced_locations.begin(); ci != unplaced_locations.end(); ++ci) {
+				const geometry_msgs::Point& position = (*ci).second;
+				std::string nearest_waypoint;
+				double min_distance = std::numeric_limits<double>::max();
+				for (std::vector< std::pair<boost::shared_ptr<geometry_msgs::PoseStamped>, mongo::BSONObj> >::const_iterator ri = results.begin(); ri != results.end(); ++ri) {
+					const geometry_msgs::Point& waypoint_position = (*ri).first->pose.position;
+					double distance = (waypoint_position.x - position.x) * (waypoint_position.x - position.x) + (waypoint_position.y - position.y) * (waypoint_position.y - position.y);
+					if (distance < min_distance) {
+						min_distance = distance;
+						nearest_waypoint = (*ri).second.getStringField("name");
+					}
+				}
+				connections.push_back(std::make_pair((*ci).first, nearest_waypoint));
+				connections.push_back(std::make_pair(nearest_waypoint, (*ci).first));
+				ROS_INFO("KCL: (RPSquirrelRecursion) Connected %s to the roadmap at %s.", (*ci).first.c_str(), nearest_waypoint.c_str());
+			}
+		}
+		
+		// Sort the edges, so the plan cache sees the same roadmap regardless of the order of the facts.
+		std::sort(connections.begin(), connections.end());
+		connections.erase(std::unique(connections.begin(), connections.end()), connections.end());
+		ROS_INFO("KCL: (RPSquirrelRecursion) Found %lu roadmap edges.", (unsigned long)connections.size());
+		return true;
+	}
+	
+	bool RPSquirrelRecursion::restoreFromPlanCache(const PlanCache::Inputs& inputs, const std::string& domain_path, const std::string& problem_path)
+	{
+		if (!plan_cache.isEnabled()) {
+			return false;
+		}
+		
+		plan_cache_hit = plan_cache.restore(inputs, domain_path, problem_path);
+		if (plan_cache_hit) {
+			plan_cache_hash = inputs.getHash();
+		}
+		ROS_INFO("KCL: (RPSquirrelRecursion) Plan cache %s for %s (hits: %u, misses: %u).", plan_cache_hit ? "hit" : "miss", inputs.getHash().c_str(), plan_cache.getHits(), plan_cache.getMisses());
+		publishPlanCacheStatistics();
+		return plan_cache_hit;
+	}
+	
+	void RPSquirrelRecursion::storeInPlanCache(const PlanCache::Inputs& inputs, const std::string& domain_path, const std::string& problem_path)
+	{
+		if (!plan_cache.isEnabled()) {
+			return;
+		}
+		
+		if (plan_cache.store(inputs, domain_path, problem_path)) {
+			plan_cache_hash = inputs.getHash();
+		} else {
+			ROS_WARN("KCL: (RPSquirrelRecursion) Could not add %s and %s to the plan cache.", domain_path.c_str(), problem_path.c_str());
+		}
+	}
+	
+	void RPSquirrelRecursion::publishPlanCacheStatistics()
+	{
+		std_msgs::Int32MultiArray statistics;
+		statistics.layout.dim.resize(1);
+		statistics.layout.dim[0].label = "hits, misses, entries";
+		statistics.layout.dim[0].size = 3;
+		statistics.layout.dim[0].stride = 3;
+		statistics.data.push_back(plan_cache.getHits());
+		statistics.data.push_back(plan_cache.getMisses());
+		statistics.data.push_back(plan_cache.getNrEntries());
+		plan_cache_statistics_pub.publish(statistics);
+	}
 
 } // close namespace
 
@@ -1,4 +1,10 @@
 #include "squirrel_planning_execution/RPSquirrelRoadmap.h"
+#include <occupancy_grid_utils/coordinate_conversions.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <map>
+#include <math.h>
 
 /* implementation of squirrel_planning_execution::RPSquirrelRoadmap.h */
 namespace KCL_rosplan {
@@ -14,18 +20,37 @@ namespace KCL_rosplan {
 		nh.param("static_map_service", static_map_service, staticMapService);
 		nh.param("use_static_map", use_static_map, false);
 		nh.param("occupancy_threshold", occupancy_threshold, 20.0);
+		nh.param("waypoint_clearance", waypoint_clearance, 0.0);
+		nh.param("resample_radius", resample_radius, 0.5);
+
+		// the footprint of the robot, by default the radius the navigation costmap uses
+		double robotRadius = 0.0;
+		ros::param::get("/move_base/global_costmap/robot_radius", robotRadius);
+		nh.param("footprint_radius", footprint_radius, robotRadius);
+		robot_clearance = footprint_radius + waypoint_clearance;
+		nh.param("connection_radius", connection_radius, 2.0);
+		nh.param("max_neighbours", max_neighbours, 8);
+		nh.param("nr_threads", nr_threads, 0);
+		srand(time(NULL));
+
+		// the cells of the spatial index are about as large as the distance between connected waypoints
+		waypoint_index.reset(connection_radius);
 
 		// knowledge interface
 		get_instance_client = nh.serviceClient<rosplan_knowledge_msgs::GetInstanceService>("/kcl_rosplan/get_instances");
-		update_knowledge_client = nh.serviceClient<rosplan_knowledge_msgs::KnowledgeUpdateService>("/kcl_rosplan/update_knowledge_base");
+		// persistent, so adding the waypoints does not open a new connection for every call
+		update_knowledge_client = nh.serviceClient<rosplan_knowledge_msgs::KnowledgeUpdateService>("/kcl_rosplan/update_knowledge_base", true);
 
 		// visualisation
 		waypoints_pub = nh.advertise<visualization_msgs::MarkerArray>("/kcl_rosplan/viz/waypoints", 10, true);
 
 		// request topics
 		std::string manipulationTopic("/squirrel_manipulation/waypoint_service");
-		nh.param("manipulation_service_topic", manipulationTopic, manipulationTopic);
-		manipulation_client = nh.serviceClient<squirrel_planning_knowledge_msgs::TaskPoseService>(manipulationTopic);
+		nh.param("manipulation_service_topic", manipulation_service_topic, manipulationTopic);
+		int maxConcurrentRequests = 4;
+		nh.param("max_concurrent_requests", maxConcurrentRequests, maxConcurrentRequests);
+		for (int i = 0; i < std::max(1, maxConcurrentRequests); ++i)
+			manipulation_clients.push_back(nh.serviceClient<squirrel_planning_knowledge_msgs::TaskPoseService>(manipulation_service_topic, true));
 
 		// map interface
 		map_client = nh.serviceClient<nav_msgs::GetMap>(static_map_service);
@@ -38,7 +63,9 @@ namespace KCL_rosplan {
 
 	/* update the costmap */
 	void RPSquirrelRoadmap::costMapCallback( const nav_msgs::OccupancyGridConstPtr& msg ) {
-		cost_map = *msg;
+		// keep the message instead of copying it, readers hold on to the map they started with
+		boost::mutex::scoped_lock lock(cost_map_mutex);
+		cost_map = msg;
 	}
 
 	/*-----------*/
@@ -51,6 +78,12 @@ namespace KCL_rosplan {
 	bool RPSquirrelRoadmap::generateRoadmap(rosplan_knowledge_msgs::CreatePRM::Request &req, rosplan_knowledge_msgs::CreatePRM::Response &res) {
 
 		ros::NodeHandle nh("~");
+		ros::WallTime start_time = ros::WallTime::now();
+
+		// a persistent connection is dropped if the knowledge base restarts
+		if (!update_knowledge_client.isValid()) {
+			update_knowledge_client = nh.serviceClient<rosplan_knowledge_msgs::KnowledgeUpdateService>("/kcl_rosplan/update_knowledge_base", true);
+		}
 
 		// clear previous roadmap from knowledge base
 		ROS_INFO("KCL: (RPSquirrelRoadmap) Cleaning old roadmap");
@@ -60,6 +93,10 @@ namespace KCL_rosplan {
 		updateSrv.request.knowledge.instance_type = "waypoint";
 		update_knowledge_client.call(updateSrv);
 
+		updateSrv.request.knowledge.knowledge_type = rosplan_knowledge_msgs::KnowledgeItem::FACT;
+		updateSrv.request.knowledge.attribute_name = "connected";
+		update_knowledge_client.call(updateSrv);
+
 		// clear previous roadmap from scene database
 		for (std::map<std::string,Waypoint*>::iterator wit=waypoints.begin(); wit!=waypoints.end(); ++wit) {
 			message_store.deleteID(db_name_map[wit->first]);
@@ -73,28 +110,39 @@ namespace KCL_rosplan {
 		for (std::map<std::string, Waypoint*>::const_iterator ci = waypoints.begin(); ci != waypoints.end(); ++ci)
 			delete (*ci).second;
 		waypoints.clear();
+		waypoint_index.clear();
 
-		// read map
-		nav_msgs::OccupancyGrid map;
+		// read map; the map is pinned for the duration of this call
+		nav_msgs::OccupancyGridConstPtr map;
 		if(use_static_map) {
 			ROS_INFO("KCL: (RPSquirrelRoadmap) Reading in map");
-			nav_msgs::GetMap mapSrv;
-			map_client.call(mapSrv);
-			map = mapSrv.response.map;
+			boost::shared_ptr<nav_msgs::GetMap> mapSrv(new nav_msgs::GetMap());
+			map_client.call(*mapSrv);
+			map = nav_msgs::OccupancyGridConstPtr(mapSrv, &mapSrv->response.map);
 		} else {
+			boost::mutex::scoped_lock lock(cost_map_mutex);
 			map = cost_map;
 		}
 
+		if(!map) {
+			ROS_INFO("KCL: (RPSquirrelRoadmap) No map received");
+			return false;
+		}
+
 		// map info
-		int width = map.info.width;
-		int height = map.info.height;
-		double resolution = map.info.resolution; // m per cell
+		int width = map->info.width;
+		int height = map->info.height;
+		double resolution = map->info.resolution; // m per cell
 
 		if(width==0 || height==0) {
 			ROS_INFO("KCL: (RPSquirrelRoadmap) Empty map");
 			return false;
 		}
 
+		// distance from each cell to the nearest obstacle, used for the collision checks
+		distance_field.compute(*map, occupancy_threshold);
+		ros::WallTime map_time = ros::WallTime::now();
+
 		// generate waypoints
 		ROS_INFO("KCL: (RPSquirrelRoadmap) Requesting waypoints");
 
@@ -108,89 +156,381 @@ namespace KCL_rosplan {
 			return false;
 		}
 		ROS_INFO("KCL: (RPSquirrelRoadmap) Received all the object instances.");
-		for (std::vector<std::string>::const_iterator ci = getInstances.response.instances.begin(); ci != getInstances.response.instances.end(); ++ci) {
-
-			// fetch position of object from message store
-			std::vector< boost::shared_ptr<geometry_msgs::PoseStamped> > results;
-			if(message_store.queryNamed<geometry_msgs::PoseStamped>(*ci, results)) {
-				if(results.size()<1) {
-					ROS_ERROR("KCL: (RPSquirrelRoadmap) aborting waypoint request; no matching obID %s", (*ci).c_str());
-					return false;
+
+		// fetch the positions of all objects from message store in one query
+		const std::vector<std::string>& instances = getInstances.response.instances;
+		mongo::BSONArrayBuilder names;
+		for (std::vector<std::string>::const_iterator ci = instances.begin(); ci != instances.end(); ++ci)
+			names.append(*ci);
+		std::vector< std::pair<boost::shared_ptr<geometry_msgs::PoseStamped>, mongo::BSONObj> > results;
+		if(!message_store.queryWithMeta<geometry_msgs::PoseStamped>(results, mongo::BSONObj(), BSON("name" << BSON("$in" << names.arr())))) {
+			ROS_ERROR("KCL: (RPSquirrelRoadmap) could not query message store to fetch object pose");
+			return false;
+		}
+
+		std::map<std::string, boost::shared_ptr<geometry_msgs::PoseStamped> > object_poses;
+		for (std::vector< std::pair<boost::shared_ptr<geometry_msgs::PoseStamped>, mongo::BSONObj> >::const_iterator ci = results.begin(); ci != results.end(); ++ci) {
+			std::string name = ci->second.getStringField("name");
+			if (object_poses.find(name) == object_poses.end())
+				object_poses[name] = ci->first;
+		}
+
+		std::vector<std::pair<std::string, geometry_msgs::PoseStamped> > objects;
+		for (std::vector<std::string>::const_iterator ci = instances.begin(); ci != instances.end(); ++ci) {
+			std::map<std::string, boost::shared_ptr<geometry_msgs::PoseStamped> >::const_iterator pi = object_poses.find(*ci);
+			if(pi == object_poses.end()) {
+				ROS_ERROR("KCL: (RPSquirrelRoadmap) aborting waypoint request; no matching obID %s", (*ci).c_str());
+				return false;
+			}
+			objects.push_back(std::make_pair(*ci, *pi->second));
+		}
+
+		// request manipulation waypoints for the objects, with a bounded number of requests in flight
+		std::vector<std::vector<std::pair<int, geometry_msgs::Point> > > accepted_points(objects.size());
+		unsigned int next_object = 0;
+		boost::mutex next_object_mutex;
+		unsigned int nr_workers = std::min(manipulation_clients.size(), objects.size());
+		boost::thread_group workers;
+		for (unsigned int worker = 0; worker < nr_workers; ++worker) {
+			if (!manipulation_clients[worker].isValid())
+				manipulation_clients[worker] = nh.serviceClient<squirrel_planning_knowledge_msgs::TaskPoseService>(manipulation_service_topic, true);
+			workers.create_thread(boost::bind(&RPSquirrelRoadmap::requestManipulationWaypoints, this, worker, boost::cref(objects), boost::ref(next_object), boost::ref(next_object_mutex), boost::ref(accepted_points)));
+		}
+		workers.join_all();
+
+		// merge the waypoints, the roadmap is committed once all objects are processed
+		for (unsigned int i = 0; i < objects.size(); ++i) {
+			for (unsigned int j = 0; j < accepted_points[i].size(); ++j) {
+				std::stringstream ss;
+				ss << "wp_" << objects[i].first << "_" << accepted_points[i][j].first;
+				Waypoint* wp = new Waypoint(ss.str(), accepted_points[i][j].second.x, accepted_points[i][j].second.y);
+				waypoints[wp->wpID] = wp;
+				waypoint_index.insert(wp->wpID, wp->real_x, wp->real_y);
+			}
+		}
+		ros::WallTime request_time = ros::WallTime::now();
+
+		// fill the free space between the manipulation waypoints
+		unsigned int nr_sampled = sampleWaypoints(req);
+		ros::WallTime sample_time = ros::WallTime::now();
+
+		// edges between nearby waypoints
+		unsigned int nr_edges = connectWaypoints(req.connecting_distance);
+		ros::WallTime connect_time = ros::WallTime::now();
+		ROS_INFO("KCL: (RPSquirrelRoadmap) Sampled %u waypoints, connected %lu waypoints with %u edges.", nr_sampled, waypoints.size(), nr_edges);
+
+		// publish visualization
+		publishWaypointMarkerArray(nh);
+
+		// add roadmap to knowledge base and scene database, every waypoint once
+		ROS_INFO("KCL: (RPSquirrelRoadmap) Adding knowledge");
+		rosplan_knowledge_msgs::KnowledgeUpdateService addSrv;
+		addSrv.request.update_type = rosplan_knowledge_msgs::KnowledgeUpdateService::Request::ADD_KNOWLEDGE;
+		addSrv.request.knowledge.knowledge_type = rosplan_knowledge_msgs::KnowledgeItem::INSTANCE;
+		addSrv.request.knowledge.instance_type = "waypoint";
+
+		geometry_msgs::PoseStamped pose;
+		pose.header.frame_id = fixed_frame;
+		pose.pose.position.z = 0.0;
+		pose.pose.orientation.x = 0.0;
+		pose.pose.orientation.y = 0.0;
+		pose.pose.orientation.z = 1.0;
+		pose.pose.orientation.w = 1.0;
+
+		res.waypoints.reserve(waypoints.size());
+		for (std::map<std::string,Waypoint*>::iterator wit=waypoints.begin(); wit!=waypoints.end(); ++wit) {
+
+			// instance
+			addSrv.request.knowledge.instance_name = wit->first;
+			if (!update_knowledge_client.call(addSrv)) {
+				ROS_ERROR("KCL: (RPSquirrelRoadmap) Failed to add the waypoint %s to the knowledge base.", wit->first.c_str());
+			}
+
+			res.waypoints.push_back(wit->first);
+
+			//data
+			pose.pose.position.x = wit->second->real_x;
+			pose.pose.position.y = wit->second->real_y;
+			std::string id(message_store.insertNamed(wit->first, pose));
+			db_name_map[wit->first] = id;
+		}
+
+		// edges; connected is directed in the domain and every waypoint lists its neighbours, so both directions are added
+		addSrv.request.knowledge.knowledge_type = rosplan_knowledge_msgs::KnowledgeItem::FACT;
+		addSrv.request.knowledge.attribute_name = "connected";
+		addSrv.request.knowledge.values.resize(2);
+		addSrv.request.knowledge.values[0].key = "from";
+		addSrv.request.knowledge.values[1].key = "to";
+		for (std::map<std::string,Waypoint*>::iterator wit=waypoints.begin(); wit!=waypoints.end(); ++wit) {
+			addSrv.request.knowledge.values[0].value = wit->first;
+			for (std::vector<std::string>::const_iterator nit = wit->second->neighbours.begin(); nit != wit->second->neighbours.end(); ++nit) {
+				addSrv.request.knowledge.values[1].value = *nit;
+				if (!update_knowledge_client.call(addSrv)) {
+					ROS_ERROR("KCL: (RPSquirrelRoadmap) Failed to add the edge %s %s to the knowledge base.", wit->first.c_str(), (*nit).c_str());
 				}
+			}
+		}
+		ros::WallTime commit_time = ros::WallTime::now();
+
+		ROS_INFO("KCL: (RPSquirrelRoadmap) Generated %lu waypoints in %f seconds (map %f, requests %f, sampling %f, edges %f, commit %f).", waypoints.size(), (commit_time - start_time).toSec(), (map_time - start_time).toSec(), (request_time - map_time).toSec(), (sample_time - request_time).toSec(), (connect_time - sample_time).toSec(), (commit_time - connect_time).toSec());
+
+		ROS_INFO("KCL: (RPSquirrelRoadmap) Done");
+		return true;
+	}
+
+	/**
+	 * Samples waypoints around the waypoints that are already in the roadmap
+	 */
+	unsigned int RPSquirrelRoadmap::sampleWaypoints(const rosplan_knowledge_msgs::CreatePRM::Request &req) {
+
+		const nav_msgs::MapMetaData& info = distance_field.getInfo();
+		std::vector<Waypoint*> nodes;
+		for (std::map<std::string,Waypoint*>::iterator wit=waypoints.begin(); wit!=waypoints.end(); ++wit)
+			nodes.push_back(wit->second);
+
+		int nr_sampled = 0;
+		std::vector<WaypointIndex::Neighbour> nearest;
+		for (int attempt = 0; attempt < req.total_attempts && nr_sampled < req.nr_waypoints; ++attempt) {
+
+			// the first waypoint, or every waypoint if there is no casting distance, can be anywhere on the map
+			geometry_msgs::Point p;
+			if (nodes.empty() || req.casting_distance <= 0) {
+				p.x = info.origin.position.x + ((double)rand() / RAND_MAX) * info.width * info.resolution;
+				p.y = info.origin.position.y + ((double)rand() / RAND_MAX) * info.height * info.resolution;
 			} else {
-				ROS_ERROR("KCL: (RPSquirrelRoadmap) could not query message store to fetch object pose");
+				const Waypoint* from = nodes[rand() % nodes.size()];
+				double angle = ((double)rand() / RAND_MAX) * 2 * M_PI;
+				double distance = ((double)rand() / RAND_MAX) * req.casting_distance;
+				p.x = from->real_x + distance * cos(angle);
+				p.y = from->real_y + distance * sin(angle);
+			}
+
+			if (distance_field.isBlocked(p, robot_clearance))
+				continue;
+			if (req.min_distance > 0) {
+				waypoint_index.findNearest(p.x, p.y, 1, req.min_distance, nearest);
+				if (!nearest.empty())
+					continue;
+			}
+
+			std::stringstream ss;
+			ss << "wp_prm_" << nr_sampled;
+			Waypoint* wp = new Waypoint(ss.str(), p.x, p.y);
+			waypoints[wp->wpID] = wp;
+			waypoint_index.insert(wp->wpID, wp->real_x, wp->real_y);
+			nodes.push_back(wp);
+			++nr_sampled;
+		}
+		return nr_sampled;
+	}
+
+	/**
+	 * Searches the rings around a blocked waypoint for a free pose at a similar distance to the target
+	 */
+	bool RPSquirrelRoadmap::resampleWaypoint(const geometry_msgs::Point& waypoint, const geometry_msgs::Point& target, geometry_msgs::Point& free) const {
+
+		double resolution = distance_field.getInfo().resolution;
+		double reach = sqrt((waypoint.x - target.x) * (waypoint.x - target.x) + (waypoint.y - target.y) * (waypoint.y - target.y));
+		geometry_msgs::Point p;
+		for (double radius = resolution; radius <= resample_radius; radius += resolution) {
+
+			// samples about one cell apart along the ring
+			int nr_samples = std::max(8, (int)ceil(2 * M_PI * radius / resolution));
+			double best_error = -1;
+			for (int i = 0; i < nr_samples; ++i) {
+				double angle = 2 * M_PI * i / nr_samples;
+				p.x = waypoint.x + radius * cos(angle);
+				p.y = waypoint.y + radius * sin(angle);
+				if (distance_field.isBlocked(p, robot_clearance))
+					continue;
+				double error = fabs(sqrt((p.x - target.x) * (p.x - target.x) + (p.y - target.y) * (p.y - target.y)) - reach);
+				if (best_error < 0 || error < best_error) {
+					best_error = error;
+					free = p;
+				}
+			}
+			if (best_error >= 0)
+				return true;
+		}
+		return false;
+	}
+
+	/**
+	 * Traces the line between two cells and checks the clearance of every cell it passes
+	 */
+	bool RPSquirrelRoadmap::isConnected(int from_x, int from_y, int to_x, int to_y) const {
+
+		int dx = abs(to_x - from_x);
+		int dy = -abs(to_y - from_y);
+		int step_x = from_x < to_x ? 1 : -1;
+		int step_y = from_y < to_y ? 1 : -1;
+		int error = dx + dy;
+		int x = from_x;
+		int y = from_y;
+		while (true) {
+			float distance = distance_field.getDistance(x, y);
+			if (distance < 0 || distance <= robot_clearance)
 				return false;
+			if (x == to_x && y == to_y)
+				return true;
+			int error2 = 2 * error;
+			if (error2 >= dy) {
+				error += dy;
+				x += step_x;
+			}
+			if (error2 <= dx) {
+				error += dx;
+				y += step_y;
 			}
+		}
+	}
 
-			// request manipulation waypoints for object
-			geometry_msgs::PoseStamped &objPose = *results[0];
+	/**
+	 * Checks every nr_threads'th candidate edge, the edges of different threads are written to different entries
+	 */
+	void RPSquirrelRoadmap::checkEdges(const std::vector<std::pair<Waypoint*, Waypoint*> >& edges, std::vector<char>& connected, unsigned int thread_id, unsigned int nr_threads) const {
+
+		const nav_msgs::MapMetaData& info = distance_field.getInfo();
+		geometry_msgs::Point p;
+		for (unsigned int i = thread_id; i < edges.size(); i += nr_threads) {
+			p.x = edges[i].first->real_x;
+			p.y = edges[i].first->real_y;
+			occupancy_grid_utils::Cell from = occupancy_grid_utils::pointCell(info, p);
+			p.x = edges[i].second->real_x;
+			p.y = edges[i].second->real_y;
+			occupancy_grid_utils::Cell to = occupancy_grid_utils::pointCell(info, p);
+			connected[i] = isConnected(from.x, from.y, to.x, to.y);
+		}
+	}
 
+	/**
+	 * Orders edges by the names of their waypoints, so the order does not depend on where the waypoints are allocated
+	 */
+	static bool compareEdgeNames(const std::pair<Waypoint*, Waypoint*>& lhs, const std::pair<Waypoint*, Waypoint*>& rhs) {
+		return lhs.first->wpID < rhs.first->wpID || (lhs.first->wpID == rhs.first->wpID && lhs.second->wpID < rhs.second->wpID);
+	}
+
+	/**
+	 * Connects every waypoint to its nearest connected waypoints, the candidates are found with the spatial index
+	 * and checked in parallel
+	 */
+	unsigned int RPSquirrelRoadmap::connectWaypoints(double connecting_distance) {
+
+		double radius = connecting_distance > 0 ? connecting_distance : connection_radius;
+
+		// every candidate edge once, ordered by the names of its waypoints
+		std::vector<std::pair<Waypoint*, Waypoint*> > edges;
+		std::vector<WaypointIndex::Neighbour> candidates;
+		for (std::map<std::string,Waypoint*>::iterator wit=waypoints.begin(); wit!=waypoints.end(); ++wit) {
+			wit->second->neighbours.clear();
+
+			// the waypoint itself is the nearest one
+			waypoint_index.findNearest(wit->second->real_x, wit->second->real_y, std::max(max_neighbours, 0) + 1, radius, candidates);
+			for (std::vector<WaypointIndex::Neighbour>::const_iterator ci = candidates.begin(); ci != candidates.end(); ++ci) {
+				if (ci->name_ == wit->first)
+					continue;
+				Waypoint* other = waypoints[ci->name_];
+				if (wit->first < ci->name_)
+					edges.push_back(std::make_pair(wit->second, other));
+				else
+					edges.push_back(std::make_pair(other, wit->second));
+			}
+		}
+		std::sort(edges.begin(), edges.end(), compareEdgeNames);
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		// the checks only read the distance field and each writes its own entry
+		std::vector<char> connected(edges.size(), 0);
+		unsigned int threads = nr_threads <= 0 ? std::max(1u, boost::thread::hardware_concurrency()) : nr_threads;
+		threads = std::min(threads, std::max(1u, (unsigned int)edges.size()));
+		if (threads > 1) {
+			boost::thread_group workers;
+			for (unsigned int thread_id = 0; thread_id < threads; ++thread_id) {
+				workers.create_thread(boost::bind(&RPSquirrelRoadmap::checkEdges, this, boost::cref(edges), boost::ref(connected), thread_id, threads));
+			}
+			workers.join_all();
+		} else {
+			checkEdges(edges, connected, 0, 1);
+		}
+
+		unsigned int nr_edges = 0;
+		for (unsigned int i = 0; i < edges.size(); ++i) {
+			if (!connected[i])
+				continue;
+			edges[i].first->neighbours.push_back(edges[i].second->wpID);
+			edges[i].second->neighbours.push_back(edges[i].first->wpID);
+			++nr_edges;
+		}
+		return nr_edges;
+	}
+
+	/*-----------------*/
+	/* spatial queries */
+	/*-----------------*/
+
+	/**
+	 * Returns the waypoints nearest to a point, looked up in the spatial index
+	 */
+	bool RPSquirrelRoadmap::findNearestWaypoints(squirrel_planning_execution::FindNearestWaypoints::Request &req, squirrel_planning_execution::FindNearestWaypoints::Response &res) {
+
+		std::vector<WaypointIndex::Neighbour> neighbours;
+		waypoint_index.findNearest(req.point.x, req.point.y, req.k, req.radius, neighbours);
+
+		res.waypoints.reserve(neighbours.size());
+		res.positions.reserve(neighbours.size());
+		res.distances.reserve(neighbours.size());
+		geometry_msgs::Point p;
+		for (std::vector<WaypointIndex::Neighbour>::const_iterator ci = neighbours.begin(); ci != neighbours.end(); ++ci) {
+			p.x = ci->x_;
+			p.y = ci->y_;
+			res.waypoints.push_back(ci->name_);
+			res.positions.push_back(p);
+			res.distances.push_back(ci->distance_);
+		}
+		return true;
+	}
+
+	/**
+	 * Requests the manipulation waypoints of the next object that has not been requested yet, until there are none left
+	 */
+	void RPSquirrelRoadmap::requestManipulationWaypoints(unsigned int worker, const std::vector<std::pair<std::string, geometry_msgs::PoseStamped> >& objects, unsigned int& next_object, boost::mutex& next_object_mutex, std::vector<std::vector<std::pair<int, geometry_msgs::Point> > >& accepted_points) {
+
+		while (true) {
+			unsigned int object;
+			{
+				boost::mutex::scoped_lock lock(next_object_mutex);
+				if (next_object >= objects.size())
+					return;
+				object = next_object++;
+			}
+
+			const geometry_msgs::PoseStamped &objPose = objects[object].second;
 			squirrel_planning_knowledge_msgs::TaskPoseService getTaskPose;
 			getTaskPose.request.target.header = objPose.header;
 			getTaskPose.request.target.point = objPose.pose.position;
 
-			if (!manipulation_client.call(getTaskPose)) {
-				ROS_ERROR("KCL: (RPSquirrelRoadmap) Failed to recieve manipulation waypoints for %s.", (*ci).c_str());
-			} else {
+			if (!manipulation_clients[worker].call(getTaskPose)) {
+				ROS_ERROR("KCL: (RPSquirrelRoadmap) Failed to recieve manipulation waypoints for %s.", objects[object].first.c_str());
+				continue;
+			}
+
+			// only this worker writes the waypoints of this object
+			for(int i=0;i<getTaskPose.response.poses.size(); i++) {
+
+				geometry_msgs::Point p = getTaskPose.response.poses[i].pose.position;
 
-				for(int i=0;i<getTaskPose.response.poses.size(); i++) {
-
-					geometry_msgs::Point p = getTaskPose.response.poses[i].pose.position;
-				
-					// check collision
-					tf::Point p1;
-					tf::pointMsgToTF(p, p1);
-					tf::Transform world_to_map;
-					tf::poseMsgToTF (map.info.origin, world_to_map);
-					tf::Point p2 = world_to_map.inverse()*p1;
-					int index = floor(p2.x()/map.info.resolution) + floor(p2.y()/map.info.resolution)*map.info.width;
-					if (map.data[index] > occupancy_threshold) {
-						std::cout << "DEBUG: collision detected, ignoring waypoint" << std::endl;
-					} else {
-
-						// save here for viz
-						std::stringstream ss;
-						ss << "wp_" << (*ci) << "_" << i;
-						Waypoint* wp = new Waypoint(ss.str(), p.x, p.y);
-						waypoints[wp->wpID] = wp;
-
-						// publish visualization
-						publishWaypointMarkerArray(nh);
-
-						// add roadmap to knowledge base and scene database
-						ROS_INFO("KCL: (RPSquirrelRoadmap) Adding knowledge");
-						for (std::map<std::string,Waypoint*>::iterator wit=waypoints.begin(); wit!=waypoints.end(); ++wit) {
-
-							// instance
-							rosplan_knowledge_msgs::KnowledgeUpdateService updateSrv;
-							updateSrv.request.update_type = rosplan_knowledge_msgs::KnowledgeUpdateService::Request::ADD_KNOWLEDGE;
-							updateSrv.request.knowledge.knowledge_type = rosplan_knowledge_msgs::KnowledgeItem::INSTANCE;
-							updateSrv.request.knowledge.instance_type = "waypoint";
-							updateSrv.request.knowledge.instance_name = wit->first;
-							update_knowledge_client.call(updateSrv);
-
-							res.waypoints.push_back(wit->first);
-
-							//data
-							geometry_msgs::PoseStamped pose;
-							pose.header.frame_id = fixed_frame;
-							pose.pose.position.x = wit->second->real_x;
-							pose.pose.position.y = wit->second->real_y;
-							pose.pose.position.z = 0.0;
-							pose.pose.orientation.x = 0.0;;
-							pose.pose.orientation.y = 0.0;;
-							pose.pose.orientation.z = 1.0;
-							pose.pose.orientation.w = 1.0;
-							std::string id(message_store.insertNamed(wit->first, pose));
-							db_name_map[wit->first] = id;
-						}
+				// check collision with the footprint, a blocked waypoint is moved to free space nearby
+				if (distance_field.isBlocked(p, robot_clearance)) {
+					geometry_msgs::Point free;
+					if (!resampleWaypoint(p, objPose.pose.position, free)) {
+						ROS_INFO("KCL: (RPSquirrelRoadmap) No free pose near waypoint %d of %s, ignoring it.", i, objects[object].first.c_str());
+						continue;
 					}
+					p = free;
 				}
+				accepted_points[object].push_back(std::make_pair(i, p));
 			}
 		}
-
-		ROS_INFO("KCL: (RPSquirrelRoadmap) Done");
-		return true;
 	}
 
 } // close namespace
@@ -214,6 +554,7 @@ namespace KCL_rosplan {
 		// init
 		KCL_rosplan::RPSquirrelRoadmap sms(nh, fixed_frame);
 		ros::ServiceServer createPRMService = nh.advertiseService("/kcl_rosplan/roadmap_server/request_waypoints", &KCL_rosplan::RPSquirrelRoadmap::generateRoadmap, &sms);
+		ros::ServiceServer findNearestService = nh.advertiseService("/kcl_rosplan/roadmap_server/find_nearest_waypoints", &KCL_rosplan::RPSquirrelRoadmap::findNearestWaypoints, &sms);
 		ros::Subscriber map_sub = nh.subscribe<nav_msgs::OccupancyGrid>(costMapTopic, 1, &KCL_rosplan::RPSquirrelRoadmap::costMapCallback, &sms);
 
 		ROS_INFO("KCL: (RPSquirrelRoadmap) Ready to receive.");
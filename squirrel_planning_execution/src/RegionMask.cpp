@@ -0,0 +1,90 @@
+#include <squirrel_planning_execution/RegionMask.h>
+
+#include <algorithm>
+#include <math.h>
+
+namespace KCL_rosplan {
+
+RegionMask::RegionMask()
+	: restricted_(false), min_x_(0), min_y_(0), max_x_(-1), max_y_(-1)
+{
+
+}
+
+void RegionMask::compute(const nav_msgs::MapMetaData& info, const std::vector<std::vector<tf::Vector3> >& polygons)
+{
+	restricted_ = !polygons.empty();
+	cells_.clear();
+	min_x_ = min_y_ = 0;
+	max_x_ = max_y_ = -1;
+	if (!restricted_) {
+		return;
+	}
+
+	// Work in grid coordinates, where the centre of cell (x, y) lies at (x, y).
+	tf::Transform map_to_world;
+	tf::poseMsgToTF(info.origin, map_to_world);
+	tf::Transform world_to_map = map_to_world.inverse();
+
+	std::vector<std::vector<tf::Vector3> > corners(polygons.size());
+	double min_x = info.width;
+	double min_y = info.height;
+	double max_x = -1;
+	double max_y = -1;
+	for (unsigned int i = 0; i < polygons.size(); ++i) {
+		for (std::vector<tf::Vector3>::const_iterator ci = polygons[i].begin(); ci != polygons[i].end(); ++ci) {
+			tf::Vector3 corner = world_to_map * (*ci);
+			corner = tf::Vector3(corner.x() / info.resolution - 0.5, corner.y() / info.resolution - 0.5, 0.0);
+			corners[i].push_back(corner);
+			min_x = std::min(min_x, corner.x());
+			min_y = std::min(min_y, corner.y());
+			max_x = std::max(max_x, corner.x());
+			max_y = std::max(max_y, corner.y());
+		}
+	}
+
+	// Only the cells in the bounding rectangle of the polygons, clipped to the grid, are stored.
+	min_x_ = std::max(0, (int)ceil(min_x));
+	min_y_ = std::max(0, (int)ceil(min_y));
+	max_x_ = std::min((int)info.width - 1, (int)floor(max_x));
+	max_y_ = std::min((int)info.height - 1, (int)floor(max_y));
+	if (min_x_ > max_x_ || min_y_ > max_y_) {
+		return;
+	}
+
+	const int width = max_x_ - min_x_ + 1;
+	cells_.assign(width * (max_y_ - min_y_ + 1), false);
+
+	// Fill every polygon row by row, between each pair of edge crossings.
+	std::vector<double> crossings;
+	for (unsigned int i = 0; i < corners.size(); ++i) {
+		const std::vector<tf::Vector3>& polygon = corners[i];
+		if (polygon.size() < 3) {
+			continue;
+		}
+
+		for (int y = min_y_; y <= max_y_; ++y) {
+			crossings.clear();
+			for (unsigned int j = 0; j < polygon.size(); ++j) {
+				const tf::Vector3& p0 = polygon[j];
+				const tf::Vector3& p1 = polygon[(j + 1) % polygon.size()];
+
+				// Half-open in y, so a row through a corner counts the crossing once.
+				if ((p0.y() <= y && p1.y() > y) || (p1.y() <= y && p0.y() > y)) {
+					crossings.push_back(p0.x() + (y - p0.y()) * (p1.x() - p0.x()) / (p1.y() - p0.y()));
+				}
+			}
+			std::sort(crossings.begin(), crossings.end());
+
+			for (unsigned int j = 0; j + 1 < crossings.size(); j += 2) {
+				int first_x = std::max(min_x_, (int)ceil(crossings[j]));
+				int last_x = std::min(max_x_, (int)floor(crossings[j + 1]));
+				for (int x = first_x; x <= last_x; ++x) {
+					cells_[(x - min_x_) + (y - min_y_) * width] = true;
+				}
+			}
+		}
+	}
+}
+
+};
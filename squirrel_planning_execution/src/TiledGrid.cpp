@@ -0,0 +1,198 @@
+#include <squirrel_planning_execution/TiledGrid.h>
+
+#include <algorithm>
+
+namespace KCL_rosplan {
+
+const int TiledGrid::TILE_SHIFT;
+const int TiledGrid::TILE_SIZE;
+
+TiledGrid::TiledGrid()
+	: occupancy_threshold_(0), width_(0), height_(0), width_in_tiles_(0), height_in_tiles_(0), total_nr_free_cells_(0)
+{
+
+}
+
+void TiledGrid::compute(const nav_msgs::OccupancyGrid& grid, int occupancy_threshold)
+{
+	occupancy_threshold_ = occupancy_threshold;
+	width_ = grid.info.width;
+	height_ = grid.info.height;
+	width_in_tiles_ = (width_ + TILE_SIZE - 1) >> TILE_SHIFT;
+	height_in_tiles_ = (height_ + TILE_SIZE - 1) >> TILE_SHIFT;
+
+	int nr_tiles = width_in_tiles_ * height_in_tiles_;
+	states_.assign(nr_tiles, FREE);
+	nr_free_cells_.assign(nr_tiles, 0);
+	mask_indices_.assign(nr_tiles, -1);
+	blocked_masks_.clear();
+	total_nr_free_cells_ = 0;
+
+	std::vector<uint64_t> mask(TILE_SIZE);
+	for (int tile_y = 0; tile_y < height_in_tiles_; ++tile_y) {
+		for (int tile_x = 0; tile_x < width_in_tiles_; ++tile_x) {
+			int min_x = tile_x << TILE_SHIFT;
+			int min_y = tile_y << TILE_SHIFT;
+			int max_x = std::min(min_x + TILE_SIZE, width_);
+			int max_y = std::min(min_y + TILE_SIZE, height_);
+
+			// Cells outside the grid are blocked, so they never count as unprocessed.
+			std::fill(mask.begin(), mask.end(), ~(uint64_t)0);
+			unsigned int nr_free = 0;
+			unsigned int nr_occupied = 0;
+			unsigned int nr_unknown = 0;
+			for (int y = min_y; y < max_y; ++y) {
+				const int8_t* row = &grid.data[y * width_];
+				for (int x = min_x; x < max_x; ++x) {
+					if (row[x] == -1) {
+						++nr_unknown;
+					} else if (row[x] > occupancy_threshold) {
+						++nr_occupied;
+					} else {
+						++nr_free;
+						mask[y - min_y] &= ~((uint64_t)1 << (x - min_x));
+					}
+				}
+			}
+
+			int tile = tile_x + tile_y * width_in_tiles_;
+			nr_free_cells_[tile] = nr_free;
+			total_nr_free_cells_ += nr_free;
+
+			unsigned int nr_cells = (max_x - min_x) * (max_y - min_y);
+			if (nr_free == nr_cells) {
+				states_[tile] = FREE;
+			} else if (nr_occupied == nr_cells) {
+				states_[tile] = OCCUPIED;
+			} else if (nr_unknown == nr_cells) {
+				states_[tile] = UNKNOWN;
+			} else {
+				states_[tile] = MIXED;
+				mask_indices_[tile] = blocked_masks_.size();
+				blocked_masks_.insert(blocked_masks_.end(), mask.begin(), mask.end());
+			}
+		}
+	}
+}
+
+const uint64_t* TiledGrid::getBlockedMask(int tile_x, int tile_y) const
+{
+	int index = mask_indices_[tile_x + tile_y * width_in_tiles_];
+	if (index < 0) {
+		return NULL;
+	}
+	return &blocked_masks_[index];
+}
+
+bool TiledGrid::isAreaFree(int min_x, int min_y, int max_x, int max_y) const
+{
+	int min_tile_x = std::max(min_x, 0) >> TILE_SHIFT;
+	int min_tile_y = std::max(min_y, 0) >> TILE_SHIFT;
+	int max_tile_x = std::min(max_x, width_ - 1) >> TILE_SHIFT;
+	int max_tile_y = std::min(max_y, height_ - 1) >> TILE_SHIFT;
+	for (int tile_y = min_tile_y; tile_y <= max_tile_y; ++tile_y) {
+		for (int tile_x = min_tile_x; tile_x <= max_tile_x; ++tile_x) {
+			if (states_[tile_x + tile_y * width_in_tiles_] != FREE) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+TiledCoverage::TiledCoverage(const TiledGrid& tiled_grid)
+	: width_(tiled_grid.getWidth()), height_(tiled_grid.getHeight()), width_in_tiles_(tiled_grid.getWidthInTiles()), height_in_tiles_(tiled_grid.getHeightInTiles())
+{
+	int nr_tiles = width_in_tiles_ * height_in_tiles_;
+	bitmap_indices_.assign(nr_tiles, -1);
+	nr_unprocessed_cells_.resize(nr_tiles);
+
+	// Only the mixed tiles need a bitmap, the blocked cells are the ones that are processed.
+	bitmaps_.reserve(tiled_grid.getNrMixedTiles() * TiledGrid::TILE_SIZE);
+	for (int tile_y = 0; tile_y < height_in_tiles_; ++tile_y) {
+		for (int tile_x = 0; tile_x < width_in_tiles_; ++tile_x) {
+			int tile = tile_x + tile_y * width_in_tiles_;
+			nr_unprocessed_cells_[tile] = tiled_grid.getNrFreeCells(tile_x, tile_y);
+
+			const uint64_t* mask = tiled_grid.getBlockedMask(tile_x, tile_y);
+			if (mask != NULL) {
+				bitmap_indices_[tile] = bitmaps_.size();
+				bitmaps_.insert(bitmaps_.end(), mask, mask + TiledGrid::TILE_SIZE);
+			}
+		}
+	}
+}
+
+bool TiledCoverage::setProcessed(int x, int y)
+{
+	int tile_x = x >> TiledGrid::TILE_SHIFT;
+	int tile_y = y >> TiledGrid::TILE_SHIFT;
+	int tile = tile_x + tile_y * width_in_tiles_;
+	if (nr_unprocessed_cells_[tile] == 0) {
+		return false;
+	}
+
+	// The first cell that is marked in a free tile gives it a bitmap, cells outside the grid are processed.
+	if (bitmap_indices_[tile] < 0) {
+		bitmap_indices_[tile] = bitmaps_.size();
+		bitmaps_.resize(bitmaps_.size() + TiledGrid::TILE_SIZE, 0);
+
+		int max_x = std::min((tile_x + 1) << TiledGrid::TILE_SHIFT, width_) - (tile_x << TiledGrid::TILE_SHIFT);
+		int max_y = std::min((tile_y + 1) << TiledGrid::TILE_SHIFT, height_) - (tile_y << TiledGrid::TILE_SHIFT);
+		uint64_t outside = max_x == TiledGrid::TILE_SIZE ? 0 : ~(uint64_t)0 << max_x;
+		for (int row = 0; row < TiledGrid::TILE_SIZE; ++row) {
+			bitmaps_[bitmap_indices_[tile] + row] = row < max_y ? outside : ~(uint64_t)0;
+		}
+	}
+
+	uint64_t& row = bitmaps_[bitmap_indices_[tile] + (y & (TiledGrid::TILE_SIZE - 1))];
+	uint64_t bit = (uint64_t)1 << (x & (TiledGrid::TILE_SIZE - 1));
+	if (row & bit) {
+		return false;
+	}
+	row |= bit;
+	--nr_unprocessed_cells_[tile];
+	return true;
+}
+
+void TiledCoverage::setTileProcessed(int tile_x, int tile_y)
+{
+	// A bitmap the tile already has is filled rather than released, so the indices of the other tiles stay valid.
+	int tile = tile_x + tile_y * width_in_tiles_;
+	if (bitmap_indices_[tile] >= 0) {
+		std::fill(bitmaps_.begin() + bitmap_indices_[tile], bitmaps_.begin() + bitmap_indices_[tile] + TiledGrid::TILE_SIZE, ~(uint64_t)0);
+	}
+	nr_unprocessed_cells_[tile] = 0;
+}
+
+unsigned int TiledCoverage::getNrUnprocessedCells() const
+{
+	unsigned int nr_unprocessed_cells = 0;
+	for (std::vector<unsigned int>::const_iterator ci = nr_unprocessed_cells_.begin(); ci != nr_unprocessed_cells_.end(); ++ci) {
+		nr_unprocessed_cells += *ci;
+	}
+	return nr_unprocessed_cells;
+}
+
+bool TiledCoverage::isAreaProcessed(int min_x, int min_y, int max_x, int max_y) const
+{
+	int min_tile_x = std::max(min_x, 0) >> TiledGrid::TILE_SHIFT;
+	int min_tile_y = std::max(min_y, 0) >> TiledGrid::TILE_SHIFT;
+	int max_tile_x = std::min(max_x, width_ - 1) >> TiledGrid::TILE_SHIFT;
+	int max_tile_y = std::min(max_y, height_ - 1) >> TiledGrid::TILE_SHIFT;
+	for (int tile_y = min_tile_y; tile_y <= max_tile_y; ++tile_y) {
+		for (int tile_x = min_tile_x; tile_x <= max_tile_x; ++tile_x) {
+			if (nr_unprocessed_cells_[tile_x + tile_y * width_in_tiles_] != 0) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+std::size_t TiledCoverage::getMemoryUsage() const
+{
+	return bitmap_indices_.size() * sizeof(int) + nr_unprocessed_cells_.size() * sizeof(unsigned int) + bitmaps_.size() * sizeof(uint64_t);
+}
+
+};
@@ -0,0 +1,256 @@
+#include <squirrel_planning_execution/TourPlanner.h>
+#include <occupancy_grid_utils/coordinate_conversions.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <math.h>
+
+namespace KCL_rosplan {
+
+const float TourPlanner::UNREACHABLE = 1e6f;
+
+// Moves that shorten a tour by less than this (in metres) are ignored, so the improvement always terminates.
+static const float MIN_IMPROVEMENT = 1e-4f;
+
+TourPlanner::TourPlanner()
+	: nr_threads_(1), nr_waypoints_(0)
+{
+
+}
+
+void TourPlanner::setNumberOfThreads(unsigned int nr_threads)
+{
+	nr_threads_ = nr_threads;
+}
+
+void TourPlanner::computeTravelCosts(const nav_msgs::OccupancyGrid& grid, int occupancy_threshold, const std::vector<geometry_msgs::Point>& waypoints)
+{
+	const int width = grid.info.width;
+	const int height = grid.info.height;
+	nr_waypoints_ = waypoints.size();
+	travel_costs_.assign(nr_waypoints_ * nr_waypoints_, UNREACHABLE);
+
+	std::vector<unsigned char> passable(width * height, 0);
+	for (int i = 0; i < width * height; ++i) {
+		passable[i] = grid.data[i] != -1 && grid.data[i] <= occupancy_threshold;
+	}
+
+	std::vector<int> waypoint_cells(nr_waypoints_, -1);
+	for (unsigned int i = 0; i < nr_waypoints_; ++i) {
+		occupancy_grid_utils::Cell cell = occupancy_grid_utils::pointCell(grid.info, waypoints[i]);
+		if (cell.x >= 0 && cell.x < width && cell.y >= 0 && cell.y < height) {
+			waypoint_cells[i] = cell.x + cell.y * width;
+			passable[waypoint_cells[i]] = 1;
+		}
+		travel_costs_[i * nr_waypoints_ + i] = 0.0f;
+	}
+
+	// Every wavefront only reads the passable cells and writes its own row of travel costs.
+	unsigned int nr_threads = nr_threads_ == 0 ? std::max(1u, boost::thread::hardware_concurrency()) : nr_threads_;
+	nr_threads = std::min(nr_threads, std::max(1u, nr_waypoints_));
+	if (nr_threads > 1) {
+		boost::thread_group workers;
+		for (unsigned int thread_id = 0; thread_id < nr_threads; ++thread_id) {
+			workers.create_thread(boost::bind(&TourPlanner::computeWavefronts, this, boost::cref(grid.info), boost::cref(passable), boost::cref(waypoint_cells), thread_id, nr_threads));
+		}
+		workers.join_all();
+	} else {
+		computeWavefronts(grid.info, passable, waypoint_cells, 0, 1);
+	}
+}
+
+void TourPlanner::computeWavefronts(const nav_msgs::MapMetaData& info, const std::vector<unsigned char>& passable, const std::vector<int>& waypoint_cells, unsigned int thread_id, unsigned int nr_threads)
+{
+	const int width = info.width;
+	const int height = info.height;
+	const float straight = info.resolution;
+	const float diagonal = info.resolution * sqrt(2.0f);
+
+	// The wavefront can stop once the cells of all the waypoints are reached.
+	std::vector<unsigned char> is_waypoint(width * height, 0);
+	unsigned int nr_waypoint_cells = 0;
+	for (std::vector<int>::const_iterator ci = waypoint_cells.begin(); ci != waypoint_cells.end(); ++ci) {
+		if (*ci >= 0 && !is_waypoint[*ci]) {
+			is_waypoint[*ci] = 1;
+			++nr_waypoint_cells;
+		}
+	}
+
+	std::vector<float> distances;
+	for (unsigned int source = thread_id; source < nr_waypoints_; source += nr_threads) {
+		if (waypoint_cells[source] < 0) {
+			continue;
+		}
+
+		distances.assign(width * height, std::numeric_limits<float>::max());
+		std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int> >, std::greater<std::pair<float, int> > > queue;
+		distances[waypoint_cells[source]] = 0.0f;
+		queue.push(std::make_pair(0.0f, waypoint_cells[source]));
+
+		unsigned int nr_reached = 0;
+		while (!queue.empty() && nr_reached < nr_waypoint_cells) {
+			std::pair<float, int> entry = queue.top();
+			queue.pop();
+			const int cell = entry.second;
+			if (entry.first > distances[cell]) {
+				continue;
+			}
+			if (is_waypoint[cell]) {
+				++nr_reached;
+			}
+
+			const int x = cell % width;
+			const int y = cell / width;
+			for (int dy = -1; dy <= 1; ++dy) {
+				for (int dx = -1; dx <= 1; ++dx) {
+					int nx = x + dx;
+					int ny = y + dy;
+					if ((dx == 0 && dy == 0) || nx < 0 || nx >= width || ny < 0 || ny >= height) {
+						continue;
+					}
+					int neighbour = nx + ny * width;
+					if (!passable[neighbour]) {
+						continue;
+					}
+
+					// Do not cut the corners of obstacles.
+					if (dx != 0 && dy != 0 && (!passable[nx + y * width] || !passable[x + ny * width])) {
+						continue;
+					}
+
+					float distance = entry.first + (dx != 0 && dy != 0 ? diagonal : straight);
+					if (distance < distances[neighbour]) {
+						distances[neighbour] = distance;
+						queue.push(std::make_pair(distance, neighbour));
+					}
+				}
+			}
+		}
+
+		for (unsigned int target = 0; target < nr_waypoints_; ++target) {
+			if (target != source && waypoint_cells[target] >= 0 && distances[waypoint_cells[target]] != std::numeric_limits<float>::max()) {
+				travel_costs_[source * nr_waypoints_ + target] = distances[waypoint_cells[target]];
+			}
+		}
+	}
+}
+
+float TourPlanner::findTour(unsigned int start, std::vector<unsigned int>& tour) const
+{
+	tour.clear();
+	if (start >= nr_waypoints_) {
+		return 0.0f;
+	}
+
+	// Start with a nearest-neighbour tour.
+	std::vector<bool> visited(nr_waypoints_, false);
+	tour.push_back(start);
+	visited[start] = true;
+	while (tour.size() < nr_waypoints_) {
+		unsigned int nearest = 0;
+		float nearest_cost = std::numeric_limits<float>::max();
+		for (unsigned int i = 0; i < nr_waypoints_; ++i) {
+			if (!visited[i] && getCost(tour.back(), i) < nearest_cost) {
+				nearest = i;
+				nearest_cost = getCost(tour.back(), i);
+			}
+		}
+		tour.push_back(nearest);
+		visited[nearest] = true;
+	}
+
+	// Alternate both kinds of moves until neither shortens the tour.
+	bool improved = true;
+	while (improved) {
+		improved = improveTwoOpt(tour);
+		improved = improveOrOpt(tour) || improved;
+	}
+
+	float cost = 0.0f;
+	for (unsigned int i = 1; i < tour.size(); ++i) {
+		cost += getTravelCost(tour[i - 1], tour[i]);
+	}
+	return cost;
+}
+
+bool TourPlanner::improveTwoOpt(std::vector<unsigned int>& tour) const
+{
+	const unsigned int n = tour.size();
+	bool changed = false;
+	bool improved = true;
+	while (improved) {
+		improved = false;
+
+		// Reverse tour[i + 1 .. j], the tour is open so the last waypoint has no successor.
+		for (unsigned int i = 0; i + 2 < n; ++i) {
+			for (unsigned int j = i + 2; j < n; ++j) {
+				float delta = getCost(tour[i], tour[j]) - getCost(tour[i], tour[i + 1]);
+				if (j + 1 < n) {
+					delta += getCost(tour[i + 1], tour[j + 1]) - getCost(tour[j], tour[j + 1]);
+				}
+				if (delta < -MIN_IMPROVEMENT) {
+					std::reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+					improved = changed = true;
+				}
+			}
+		}
+	}
+	return changed;
+}
+
+bool TourPlanner::improveOrOpt(std::vector<unsigned int>& tour) const
+{
+	const unsigned int n = tour.size();
+	bool changed = false;
+	bool improved = true;
+	while (improved) {
+		improved = false;
+		for (unsigned int length = 1; length <= 3 && !improved; ++length) {
+			// Move tour[i .. i + length - 1], the start of the tour stays in place.
+			for (unsigned int i = 1; i + length <= n && !improved; ++i) {
+				unsigned int previous = tour[i - 1];
+				unsigned int first = tour[i];
+				unsigned int last = tour[i + length - 1];
+				bool has_next = i + length < n;
+				float removed = getCost(previous, first);
+				if (has_next) {
+					removed += getCost(last, tour[i + length]) - getCost(previous, tour[i + length]);
+				}
+
+				// Insert the sequence after tour[p].
+				for (unsigned int p = 0; p < n && !improved; ++p) {
+					if (p + 1 >= i && p < i + length) {
+						continue;
+					}
+					bool has_successor = p + 1 < n;
+					float added = getCost(tour[p], first);
+					float added_reversed = getCost(tour[p], last);
+					if (has_successor) {
+						added += getCost(last, tour[p + 1]) - getCost(tour[p], tour[p + 1]);
+						added_reversed += getCost(first, tour[p + 1]) - getCost(tour[p], tour[p + 1]);
+					}
+					if (std::min(added, added_reversed) - removed >= -MIN_IMPROVEMENT) {
+						continue;
+					}
+
+					std::vector<unsigned int> sequence(tour.begin() + i, tour.begin() + i + length);
+					if (added_reversed < added) {
+						std::reverse(sequence.begin(), sequence.end());
+					}
+					tour.erase(tour.begin() + i, tour.begin() + i + length);
+					unsigned int position = p < i ? p + 1 : p + 1 - length;
+					tour.insert(tour.begin() + position, sequence.begin(), sequence.end());
+					improved = changed = true;
+				}
+			}
+		}
+	}
+	return changed;
+}
+
+};
@@ -2,276 +2,1092 @@
 #include <occupancy_grid_utils/ray_tracer.h>
 #include <occupancy_grid_utils/coordinate_conversions.h>
 #include <visualization_msgs/MarkerArray.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 //#include <tf/Quaternion.h>
 //#include <tf/Vector3.h>
 
+#include <tf/transform_datatypes.h>
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <limits>
+#include <queue>
+#include <stdint.h>
+#include <math.h>
 #include <stdlib.h>
 #include <time.h> 
 
 namespace KCL_rosplan {
 
 ViewConeGenerator::ViewConeGenerator(ros::NodeHandle& node_handle, const std::string& topic_name)
-	: has_received_occupancy_grid_(false)
+	: has_received_occupancy_grid_(false), nr_threads_(1), seed_(time(NULL)), strategy_(RANDOM_RESTART), pool_size_(0), sampling_(ADMISSIBLE_STRATIFIED), incremental_(true), nr_yaw_bins_(0), try_all_yaw_bins_(false)
 {
+	initialiseSnapshot();
+	
 	navigation_grid_sub_ = node_handle.subscribe(topic_name, 1, &ViewConeGenerator::storeNavigationGrid, this);
 	rivz_pub_ = node_handle.advertise<visualization_msgs::MarkerArray>("/vis/view_cones", 1000);
-	srand(time(NULL));
+	diagnostics_pub_ = node_handle.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 10);
+}
+
+ViewConeGenerator::ViewConeGenerator()
+	: has_received_occupancy_grid_(false), nr_threads_(1), seed_(time(NULL)), strategy_(RANDOM_RESTART), pool_size_(0), sampling_(ADMISSIBLE_STRATIFIED), incremental_(true), nr_yaw_bins_(0), try_all_yaw_bins_(false)
+{
+	initialiseSnapshot();
+}
+
+void ViewConeGenerator::initialiseSnapshot()
+{
+	GridSnapshot* snapshot = new GridSnapshot();
+	snapshot->grid_.reset(new nav_msgs::OccupancyGrid());
+	snapshot->distance_field_.reset(new DistanceField());
+	snapshot_.reset(snapshot);
+}
+
+boost::shared_ptr<const TiledGrid> ViewConeGenerator::getTiledGrid(const nav_msgs::OccupancyGrid::ConstPtr& grid, int occupancy_threshold)
+{
+	if (!tiled_grid_ || tiled_grid_source_ != grid || tiled_grid_->getOccupancyThreshold() != occupancy_threshold) {
+		TiledGrid* tiled_grid = new TiledGrid();
+		tiled_grid->compute(*grid, occupancy_threshold);
+		tiled_grid_.reset(tiled_grid);
+		tiled_grid_source_ = grid;
+	}
+	return tiled_grid_;
+}
+
+void ViewConeGenerator::setNumberOfThreads(unsigned int nr_threads)
+{
+	nr_threads_ = nr_threads;
+}
+
+unsigned int ViewConeGenerator::getNumberOfThreads() const
+{
+	if (nr_threads_ == 0) {
+		return std::max(1u, boost::thread::hardware_concurrency());
+	}
+	return nr_threads_;
+}
+
+void ViewConeGenerator::setSeed(unsigned int seed)
+{
+	seed_ = seed;
+}
+
+void ViewConeGenerator::setSelectionStrategy(SelectionStrategy strategy)
+{
+	strategy_ = strategy;
+}
+
+void ViewConeGenerator::setCandidatePoolSize(unsigned int pool_size)
+{
+	pool_size_ = pool_size;
+}
+
+void ViewConeGenerator::setSamplingStrategy(SamplingStrategy sampling)
+{
+	sampling_ = sampling;
+}
+
+void ViewConeGenerator::setYawBins(unsigned int nr_yaw_bins, bool try_all_yaw_bins)
+{
+	nr_yaw_bins_ = nr_yaw_bins;
+	try_all_yaw_bins_ = try_all_yaw_bins;
 }
 
 void ViewConeGenerator::storeNavigationGrid(const nav_msgs::OccupancyGrid::ConstPtr& msg)
 {
-	last_received_occupancy_grid_msgs_ = *msg;
+	// Any cell with a value above 0 is considered an obstacle when checking the safe distance.
+	DistanceField* distance_field = new DistanceField();
+	distance_field->compute(*msg, 0);
+	
+	GridSnapshot* snapshot = new GridSnapshot();
+	snapshot->grid_ = msg;
+	snapshot->distance_field_.reset(distance_field);
+	GridSnapshotConstPtr new_snapshot(snapshot);
+	
+	// Swap in the new snapshot, the old one is released once the last reader is done with it.
+	boost::mutex::scoped_lock lock(snapshot_mutex_);
+	snapshot_.swap(new_snapshot);
 	has_received_occupancy_grid_ = true;
 }
 
+bool ViewConeGenerator::hasReceivedOccupancyGrid() const
+{
+	boost::mutex::scoped_lock lock(snapshot_mutex_);
+	return has_received_occupancy_grid_;
+}
+
+ViewConeGenerator::GridSnapshotConstPtr ViewConeGenerator::getSnapshot() const
+{
+	boost::mutex::scoped_lock lock(snapshot_mutex_);
+	return snapshot_;
+}
+
+void ViewConeGenerator::setIncrementalReplanning(bool incremental)
+{
+	incremental_ = incremental;
+	if (!incremental_) {
+		previous_plan_.reset();
+	}
+}
+
+boost::shared_ptr<const DistanceField> ViewConeGenerator::getDistanceField() const
+{
+	return getSnapshot()->distance_field_;
+}
+
+nav_msgs::OccupancyGrid::ConstPtr ViewConeGenerator::getOccupancyGrid() const
+{
+	return getSnapshot()->grid_;
+}
+
+void ViewConeGenerator::getViewConeCells(const nav_msgs::MapMetaData& info, const occupancy_grid_utils::Cell& view_cell, float yaw, float fov, float view_distance, std::vector<occupancy_grid_utils::Cell>& cells) const
+{
+	geometry_msgs::Point p = occupancy_grid_utils::cellCenter(info, view_cell);
+	tf::Vector3 view_point(p.x, p.y, p.z);
+	tf::Vector3 v1, v2;
+	computeViewConeCorners(view_point, yaw, fov, view_distance, v1, v2);
+	rasteriseViewCone(info, view_point, v1, v2, view_cell, cells);
+}
+
 void ViewConeGenerator::createViewCones(std::vector<geometry_msgs::Pose>& poses, const std::vector<tf::Vector3>& bounding_box, unsigned int max_view_cones, int occupancy_threshold, float fov, float view_distance, unsigned int sample_size, float safe_distance)
 {
-	if (!has_received_occupancy_grid_) {
+	createViewCones(poses, bounding_box, max_view_cones, occupancy_threshold, fov, view_distance, sample_size, safe_distance, ros::WallDuration(0));
+}
+
+ViewConeGenerator::ViewConeProgress ViewConeGenerator::createViewCones(std::vector<geometry_msgs::Pose>& poses, const std::vector<tf::Vector3>& bounding_box, unsigned int max_view_cones, int occupancy_threshold, float fov, float view_distance, unsigned int sample_size, float safe_distance, const ros::WallDuration& time_budget, const ProgressCallback& progress_callback)
+{
+	std::vector<std::vector<tf::Vector3> > regions;
+	if (!bounding_box.empty()) {
+		regions.push_back(bounding_box);
+	}
+	return createViewCones(poses, regions, max_view_cones, occupancy_threshold, fov, view_distance, sample_size, safe_distance, time_budget, progress_callback);
+}
+
+ViewConeGenerator::ViewConeProgress ViewConeGenerator::createViewCones(std::vector<geometry_msgs::Pose>& poses, const std::vector<std::vector<tf::Vector3> >& regions, unsigned int max_view_cones, int occupancy_threshold, float fov, float view_distance, unsigned int sample_size, float safe_distance, const ros::WallDuration& time_budget, const ProgressCallback& progress_callback)
+{
+	ViewConeProgress progress;
+	progress.start_time_ = ros::WallTime::now();
+	phase_timings_ = PhaseTimings();
+	
+	if (!hasReceivedOccupancyGrid()) {
 		ROS_WARN("(ViewConeGenerator) The occupancy grid was not published yet, no poses returned.");
-		return;
+		progress.finished_ = true;
+		return progress;
 	}
 	
+	// Pin the latest occupancy grid, grids that are received while we are busy do not affect this call.
+	GridSnapshotConstPtr snapshot = getSnapshot();
+	const nav_msgs::OccupancyGrid& grid = *snapshot->grid_;
+	
 	ROS_INFO("(ViewConeGenerator) View code generation started.");
-	// Initialise the processed cells list.
-	std::vector<bool> processed_cells(last_received_occupancy_grid_msgs_.info.width * last_received_occupancy_grid_msgs_.info.height, false);
-	for (int y = 0; y < last_received_occupancy_grid_msgs_.info.height; ++y) {
-		for (int x = 0; x < last_received_occupancy_grid_msgs_.info.width; ++x) {
-			if (last_received_occupancy_grid_msgs_.data[x + y * last_received_occupancy_grid_msgs_.info.width] > occupancy_threshold ||
-			    last_received_occupancy_grid_msgs_.data[x + y * last_received_occupancy_grid_msgs_.info.width] == -1) {
-				processed_cells[x + y * last_received_occupancy_grid_msgs_.info.width] = true;
-			} else {
-				processed_cells[x + y * last_received_occupancy_grid_msgs_.info.width] = false;
-			}
-		}
-	}
+	// Initialise the processed cells, only the free cells are unprocessed. Uniform tiles do not store any cells.
+	boost::shared_ptr<const TiledGrid> tiled_grid = getTiledGrid(snapshot->grid_, occupancy_threshold);
+	TiledCoverage processed_cells(*tiled_grid);
 	
-	ROS_INFO("(ViewConeGenerator) Initialised the processed cells.");
+	// Cells outside the regions are processed from the start, so they are never counted as covered.
+	RegionMask region_mask;
+	region_mask.compute(grid.info, regions);
+	restrictToRegion(*tiled_grid, region_mask, processed_cells);
+	progress.nr_free_cells_ = processed_cells.getNrUnprocessedCells();
 	
-	for (unsigned int i = 0; i < max_view_cones; ++i) {
-		//ROS_INFO("(ViewConeGenerator) Process view cone: %d.", i);
-		// First we generate a bunch of random view cones and rate them.
-		geometry_msgs::Pose best_pose;
-		std::vector<occupancy_grid_utils::Cell> best_visible_cells;
-		for (unsigned int j = 0; j < sample_size; ++j) {
-			int grid_x = ((float)rand() / (float)RAND_MAX) * last_received_occupancy_grid_msgs_.info.width;
-			int grid_y = ((float)rand() / (float)RAND_MAX) * last_received_occupancy_grid_msgs_.info.height;
-			
-			occupancy_grid_utils::Cell c(grid_x, grid_y);
-			
-			geometry_msgs::Point p = occupancy_grid_utils::cellCenter(last_received_occupancy_grid_msgs_.info, c);
-			
-			// Check if this cell point is not too close to any obstacles.
-			if (isBlocked(p, safe_distance)) {
-				continue;
+	ROS_INFO("(ViewConeGenerator) Initialised the processed cells, %u of the %d tiles are mixed (%lu bytes).", tiled_grid->getNrMixedTiles(), tiled_grid->getWidthInTiles() * tiled_grid->getHeightInTiles(), processed_cells.getMemoryUsage());
+	
+	// The parameters of this call, the view cones are added as they are selected.
+	boost::shared_ptr<ViewConePlan> plan(new ViewConePlan());
+	plan->grid_ = snapshot->grid_;
+	plan->regions_ = regions;
+	plan->max_view_cones_ = max_view_cones;
+	plan->occupancy_threshold_ = occupancy_threshold;
+	plan->fov_ = fov;
+	plan->view_distance_ = view_distance;
+	plan->sample_size_ = sample_size;
+	plan->safe_distance_ = safe_distance;
+	plan->strategy_ = strategy_;
+	plan->pool_size_ = pool_size_;
+	plan->sampling_ = sampling_;
+	plan->nr_yaw_bins_ = nr_yaw_bins_;
+	plan->try_all_yaw_bins_ = try_all_yaw_bins_;
+	
+	// Keep the view cones of the previous call whose surroundings did not change, new view cones are only 
+	// sampled near the tiles that changed. An empty region means the whole grid.
+	std::vector<bool> region;
+	unsigned int nr_new_view_cones = max_view_cones;
+	if (incremental_ && previous_plan_ && isCompatible(*previous_plan_, *plan)) {
+		std::vector<bool> changed_tiles;
+		unsigned int nr_changed_tiles = 0;
+		if (previous_plan_->grid_ != snapshot->grid_) {
+			nr_changed_tiles = findChangedTiles(*previous_plan_->grid_, grid, *tiled_grid, changed_tiles);
+		}
+		
+		const int radius = getViewConeRadius(grid.info, fov, view_distance, safe_distance);
+		const int last_tile_x = tiled_grid->getWidthInTiles() - 1;
+		const int last_tile_y = tiled_grid->getHeightInTiles() - 1;
+		for (std::vector<ViewConeCandidate>::const_iterator ci = previous_plan_->view_cones_.begin(); ci != previous_plan_->view_cones_.end(); ++ci) {
+			const ViewConeCandidate& view_cone = *ci;
+			bool changed = false;
+			if (nr_changed_tiles > 0) {
+				int min_tile_x = std::max(0, (int)view_cone.view_cell_.x - radius) >> TiledGrid::TILE_SHIFT;
+				int min_tile_y = std::max(0, (int)view_cone.view_cell_.y - radius) >> TiledGrid::TILE_SHIFT;
+				int max_tile_x = std::min(last_tile_x, ((int)view_cone.view_cell_.x + radius) >> TiledGrid::TILE_SHIFT);
+				int max_tile_y = std::min(last_tile_y, ((int)view_cone.view_cell_.y + radius) >> TiledGrid::TILE_SHIFT);
+				for (int tile_y = min_tile_y; tile_y <= max_tile_y && !changed; ++tile_y) {
+					for (int tile_x = min_tile_x; tile_x <= max_tile_x && !changed; ++tile_x) {
+						changed = changed_tiles[tile_x + tile_y * tiled_grid->getWidthInTiles()];
+					}
+				}
 			}
 			
-			// Check if this point falls within the bounding box.
-			{
-				bool falls_within_bounded_box = true;
-				char sign = 0;
-				tf::Vector3 cell_point(p.x, p.y, p.z);
-				for (int i = 0; i < bounding_box.size(); ++i)
-				{
-					const tf::Vector3& v1 = bounding_box[i];
-					const tf::Vector3& v2 = bounding_box[i + 1];
-					
-					tf::Vector3 cross_product = (cell_point - v1).cross(v2 - v1);
-					
-					if (sign == 0)
-					{
-						sign = cross_product.z() > 0 ? 1 : -1;
+			if (!changed) {
+				markObserved(grid, view_cone, processed_cells, progress, *plan);
+				poses.push_back(view_cone.pose_);
+			}
+		}
+		
+		ROS_INFO("(ViewConeGenerator) %u tiles changed, %u of the %lu previous view cones are kept.", nr_changed_tiles, progress.nr_view_cones_, previous_plan_->view_cones_.size());
+		
+		// Replacement view cones can cover cells up to twice the radius away from the changed tiles. If the previous 
+		// call found fewer view cones than it was asked for, the missing ones are sampled from the whole grid, even 
+		// if nothing changed.
+		nr_new_view_cones = max_view_cones - std::min(max_view_cones, progress.nr_view_cones_);
+		if (nr_new_view_cones > 0 && nr_changed_tiles > 0 && previous_plan_->view_cones_.size() >= max_view_cones) {
+			int nr_tiles = (2 * radius + TiledGrid::TILE_SIZE - 1) >> TiledGrid::TILE_SHIFT;
+			region.resize(changed_tiles.size(), false);
+			for (int tile_y = 0; tile_y <= last_tile_y; ++tile_y) {
+				for (int tile_x = 0; tile_x <= last_tile_x; ++tile_x) {
+					if (!changed_tiles[tile_x + tile_y * tiled_grid->getWidthInTiles()]) {
+						continue;
 					}
-					else
-					{
-						if (sign == -1 && cross_product.z() > 0 ||
-							 sign == 1 && cross_product.z() < 0)
-						{
-							falls_within_bounded_box = false;
-							break;
+					for (int y = std::max(0, tile_y - nr_tiles); y <= std::min(last_tile_y, tile_y + nr_tiles); ++y) {
+						for (int x = std::max(0, tile_x - nr_tiles); x <= std::min(last_tile_x, tile_x + nr_tiles); ++x) {
+							region[x + y * tiled_grid->getWidthInTiles()] = true;
 						}
 					}
 				}
-				
-				if (!falls_within_bounded_box) continue;
 			}
-			float yaw = ((float)rand() / (float)RAND_MAX) * 2 * M_PI;
-			
-			//ROS_INFO("(ViewConeGenerator) Sample cone: (%d, %d) %f.", grid_x, grid_y, yaw);
-			//ROS_INFO("(ViewConeGenerator) Sample cone: (%f, %f) %f.", p.x, p.y, yaw);
-			
-			geometry_msgs::Pose pose;
-			pose.position = p;
-			
-			tf::Quaternion q;
-			q.setEulerZYX(yaw, 0.0f, 0.0f);
+		}
+	}
+	
+	ros::WallTime phase_start = ros::WallTime::now();
+	phase_timings_.initialisation_ = phase_start - progress.start_time_;
+	
+	// The admissible cells are found once, every sample is drawn from them.
+	std::vector<occupancy_grid_utils::Cell> admissible_cells;
+	
+	// The footprints of the view cones are rasterised once for every yaw bin.
+	std::vector<ViewConeStencil> stencils;
+	if (nr_yaw_bins_ > 0) {
+		buildStencils(grid.info, fov, view_distance, nr_yaw_bins_, stencils);
+	}
+	phase_timings_.stencils_ = ros::WallTime::now() - phase_start;
+	
+	// Rejection sampling would draw from the whole grid, when replanning a region draw from its admissible cells.
+	SamplingStrategy sampling = sampling_;
+	if (!region.empty() && sampling == REJECTION_SAMPLING) {
+		sampling = ADMISSIBLE_STRATIFIED;
+	}
+	
+	ViewConeSettings settings(*snapshot, *tiled_grid, region_mask, admissible_cells, sampling, stencils, try_all_yaw_bins_, occupancy_threshold, fov, view_distance, safe_distance, getNumberOfThreads());
+	if (time_budget > ros::WallDuration(0)) {
+		settings.deadline_ = progress.start_time_ + time_budget;
+	}
+	
+	sampling_statistics_ = SamplingStatistics();
+	phase_start = ros::WallTime::now();
+	if (sampling != REJECTION_SAMPLING && nr_new_view_cones > 0) {
+		findAdmissibleCells(settings, region, admissible_cells);
+		sampling_statistics_.nr_admissible_cells_ = admissible_cells.size();
+		ROS_INFO("(ViewConeGenerator) Found %lu admissible cells.", admissible_cells.size());
+	}
+	phase_timings_.admissible_cells_ = ros::WallTime::now() - phase_start;
+	
+	phase_start = ros::WallTime::now();
+	if (nr_new_view_cones == 0) {
+		// All the view cones of the previous call are still valid.
+	} else if (strategy_ == LAZY_GREEDY) {
+		// When only a few view cones are replaced, the pool shrinks accordingly.
+		unsigned int pool_size = pool_size_ == 0 ? 10 * sample_size : pool_size_;
+		if (nr_new_view_cones < max_view_cones) {
+			pool_size = std::max(sample_size, (unsigned int)((uint64_t)pool_size * nr_new_view_cones / max_view_cones));
+		}
+		selectLazyGreedy(poses, nr_new_view_cones, pool_size, settings, processed_cells, sampling_statistics_, progress, progress_callback, *plan);
+	} else {
+		selectRandomRestart(poses, nr_new_view_cones, sample_size, settings, processed_cells, sampling_statistics_, progress, progress_callback, *plan);
+	}
+	phase_timings_.selection_ = ros::WallTime::now() - phase_start;
+	
+	if (progress.deadline_reached_) {
+		ROS_WARN("(ViewConeGenerator) The time budget of %f seconds ran out after %u view cones.", time_budget.toSec(), progress.nr_view_cones_);
+	}
+	
+	ROS_INFO("(ViewConeGenerator) %u of the %u sampled view cones were accepted (%.1f%%).", sampling_statistics_.nr_accepted_samples_, sampling_statistics_.nr_samples_, sampling_statistics_.nr_samples_ == 0 ? 0.0f : 100.0f * sampling_statistics_.nr_accepted_samples_ / sampling_statistics_.nr_samples_);
+	
+	for (std::vector<geometry_msgs::Pose>::const_iterator ci = poses.begin(); ci != poses.end(); ++ci) {
+		ROS_INFO("(ViewConeGenerator) Found the pose(%f, %f, %f).", (*ci).position.x, (*ci).position.y, (*ci).position.z);
+	}
+	
+	// Visualise the view cones.
+	phase_start = ros::WallTime::now();
+	visualiseViewCones(poses, view_distance, fov);
+	phase_timings_.visualisation_ = ros::WallTime::now() - phase_start;
+	phase_timings_.total_ = ros::WallTime::now() - progress.start_time_;
+	
+	// A plan that was cut short by the deadline is not kept, the next call would return it as it is if the grid 
+	// did not change. The plan of the previous call is still valid for the grid it was made for.
+	if (incremental_ && !progress.deadline_reached_) {
+		previous_plan_ = plan;
+	}
+	
+	progress.finished_ = true;
+	reportProgress(progress, progress_callback);
+	ROS_INFO("(ViewConeGenerator) %u view cones cover %u of the %u free cells (%.1f%%) in %f seconds.", progress.nr_view_cones_, progress.nr_covered_cells_, progress.nr_free_cells_, 100.0f * progress.getCoverage(), progress.elapsed_time_.toSec());
+	return progress;
+}
 
-			pose.orientation.x = q.getX();
-			pose.orientation.y = q.getY();
-			pose.orientation.z = q.getZ();
-			pose.orientation.w = q.getW();
-			
-			// Calculate the triangle points encompasses the area that is viewed.
-			tf::Vector3 view_point(p.x, p.y, p.z);
-			
-			tf::Vector3 v0(view_distance, 0.0f, 0.0f);
-			v0 = v0.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), yaw);
-			
-			//ROS_INFO("(ViewConeGenerator) Viewing direction: (%f, %f, %f).", v0.x(), v0.y(), v0.z());
-			
-			tf::Vector3 v0_normalised = v0.normalized();
-			
-			//ROS_INFO("(ViewConeGenerator) Viewing direction (normalised): (%f, %f, %f).", v0_normalised.x(), v0_normalised.y(), v0_normalised.z());
-			
-			tf::Vector3 v1 = v0;
-			v1 = v1.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), fov / 2.0f);
-			v1 = v1.normalize();
-			
-			//ROS_INFO("(ViewConeGenerator) V1 (normalised): (%f, %f, %f).", v1.x(), v1.y(), v1.z());
-			
-			float length = v0.length() / v0_normalised.dot(v1);
-			v1 *= length;
-			v1 += view_point;
-			
-			//ROS_INFO("(ViewConeGenerator) V1 (actual): (%f, %f, %f); length = %f.", v1.x(), v1.y(), v1.z(), length);
-			
-			tf::Vector3 v2 = v0;
-			v2 = v2.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), -fov / 2.0f);
-			v2 = v2.normalize();
-			//ROS_INFO("(ViewConeGenerator) V2 (normalised): (%f, %f, %f).", v2.x(), v2.y(), v2.z());
-			
-			length = v0.length() / v0_normalised.dot(v2);
-			v2 *= length;
-			v2 += view_point;
-			//ROS_INFO("(ViewConeGenerator) V2 (actual): (%f, %f, %f); length = %f.", v2.x(), v2.y(), v2.z(), length);
-			
-			//ROS_INFO("(ViewConeGenerator) Triangle: (%f, %f, %f), (%f, %f, %f), (%f, %f, %f).", p.x, p.y, p.z, v1.x(), v1.y(), v1.z(), v2.x(), v2.y(), v2.z());
-			
-			// The triangle now is view_point, v1, v2, we use a flood algorithm to determine which cells
-			// are inside the viewing cone.
-			//occupancy_grid_utils::Cell cell = occupancy_grid_utils::pointCell(last_received_occupancy_grid_msgs_.info, );
-			
-			std::vector<occupancy_grid_utils::Cell> open_list;
-			open_list.push_back(c);
-			
-			std::vector<occupancy_grid_utils::Cell> complete_list;
-			
-			while (open_list.size() > 0) {
-				
-				occupancy_grid_utils::Cell cell = open_list[0];
-				open_list.erase(open_list.begin());
-				
-				// Check if the cell is inside the triangle.
-				geometry_msgs::Point cell_centre_point = occupancy_grid_utils::cellCenter(last_received_occupancy_grid_msgs_.info, cell);
-				tf::Vector3 cell_point(cell_centre_point.x, cell_centre_point.y, cell_centre_point.z);
-				
-				tf::Vector3 cross_v1 = (cell_point - v1).cross(v2 - v1);
-				tf::Vector3 cross_v2 = (cell_point - v2).cross(view_point - v2);
-				tf::Vector3 cross_v3 = (cell_point - view_point).cross(v1 - view_point);
-				
-				// If both cross produces have the same sign we are good.
-				bool is_in_triangle = false;
-				if ((cross_v1.z() > 0 && cross_v2.z() > 0 && cross_v3.z() > 0) ||
-				    (cross_v1.z() < 0 && cross_v2.z() < 0 && cross_v3.z() < 0) ||
-				    (cell.x == c.x && cell.y == c.y)) {
-					is_in_triangle = true;
-				}
-				
-				if (!is_in_triangle) {
-					continue;
-				}
-				
-				// Make sure this cell was not already added.
-				bool has_been_processed = false;
-				for (std::vector<occupancy_grid_utils::Cell>::const_iterator ci = complete_list.begin(); ci != complete_list.end(); ++ci) {
-					const occupancy_grid_utils::Cell& completed_cell = *ci;
-					if (completed_cell.x == cell.x && completed_cell.y == cell.y) {
-						has_been_processed = true;
-						break;
-					}
-				}
-				
-				if (has_been_processed) {
-					continue;
-				}
-				
-				complete_list.push_back(cell);
-				
-				// Add its children to the list.
-				occupancy_grid_utils::Cell new_cell;
-				for (int x = cell.x - 1; x < cell.x + 2; ++x) {
-					for (int y = cell.y - 1; y < cell.y + 2; ++y) {
-						if (x > -1 && x + 1 < last_received_occupancy_grid_msgs_.info.width &&
-						    y > -1 && y + 1 < last_received_occupancy_grid_msgs_.info.height)
-						{
-							new_cell.x = x;
-							new_cell.y = y;
-							open_list.push_back(new_cell);
-						}
+std::vector<ViewConeGenerator::ViewConeProgress> ViewConeGenerator::createViewCones(std::vector<std::vector<geometry_msgs::Pose> >& poses, const std::vector<ViewConeProfile>& profiles, int occupancy_threshold, const ros::WallDuration& time_budget)
+{
+	std::vector<ViewConeProgress> progress(profiles.size());
+	poses.resize(profiles.size());
+	ros::WallTime start_time = ros::WallTime::now();
+	phase_timings_ = PhaseTimings();
+	sampling_statistics_ = SamplingStatistics();
+	for (std::vector<ViewConeProgress>::iterator pi = progress.begin(); pi != progress.end(); ++pi) {
+		(*pi).start_time_ = start_time;
+		(*pi).finished_ = true;
+	}
+	
+	if (!hasReceivedOccupancyGrid()) {
+		ROS_WARN("(ViewConeGenerator) The occupancy grid was not published yet, no poses returned.");
+		return progress;
+	}
+	
+	// Every profile works on the same snapshot and tiles.
+	GridSnapshotConstPtr snapshot = getSnapshot();
+	const nav_msgs::OccupancyGrid& grid = *snapshot->grid_;
+	boost::shared_ptr<const TiledGrid> tiled_grid = getTiledGrid(snapshot->grid_, occupancy_threshold);
+	
+	// Profiles with the same regions and safe distance share their region mask, processed cells and admissible 
+	// cells, profiles with the same field of view and view distance share their stencils.
+	std::vector<unsigned int> area_indices(profiles.size());
+	std::vector<unsigned int> stencil_indices(profiles.size());
+	std::vector<unsigned int> first_area_profiles;
+	std::vector<unsigned int> first_stencil_profiles;
+	for (unsigned int i = 0; i < profiles.size(); ++i) {
+		area_indices[i] = first_area_profiles.size();
+		for (unsigned int j = 0; j < first_area_profiles.size(); ++j) {
+			const ViewConeProfile& other = profiles[first_area_profiles[j]];
+			if (other.safe_distance_ == profiles[i].safe_distance_ && other.regions_ == profiles[i].regions_) {
+				area_indices[i] = j;
+				break;
+			}
+		}
+		if (area_indices[i] == first_area_profiles.size()) {
+			first_area_profiles.push_back(i);
+		}
+		
+		stencil_indices[i] = first_stencil_profiles.size();
+		for (unsigned int j = 0; j < first_stencil_profiles.size(); ++j) {
+			const ViewConeProfile& other = profiles[first_stencil_profiles[j]];
+			if (other.fov_ == profiles[i].fov_ && other.view_distance_ == profiles[i].view_distance_) {
+				stencil_indices[i] = j;
+				break;
+			}
+		}
+		if (stencil_indices[i] == first_stencil_profiles.size()) {
+			first_stencil_profiles.push_back(i);
+		}
+	}
+	
+	std::vector<RegionMask> region_masks(first_area_profiles.size());
+	std::vector<TiledCoverage> area_processed_cells;
+	area_processed_cells.reserve(first_area_profiles.size());
+	for (unsigned int i = 0; i < first_area_profiles.size(); ++i) {
+		region_masks[i].compute(grid.info, profiles[first_area_profiles[i]].regions_);
+		area_processed_cells.push_back(TiledCoverage(*tiled_grid));
+		restrictToRegion(*tiled_grid, region_masks[i], area_processed_cells[i]);
+	}
+	
+	ros::WallTime phase_start = ros::WallTime::now();
+	phase_timings_.initialisation_ = phase_start - start_time;
+	
+	std::vector<std::vector<ViewConeStencil> > stencils(first_stencil_profiles.size());
+	if (nr_yaw_bins_ > 0) {
+		for (unsigned int i = 0; i < first_stencil_profiles.size(); ++i) {
+			const ViewConeProfile& profile = profiles[first_stencil_profiles[i]];
+			buildStencils(grid.info, profile.fov_, profile.view_distance_, nr_yaw_bins_, stencils[i]);
+		}
+	}
+	phase_timings_.stencils_ = ros::WallTime::now() - phase_start;
+	
+	// The threads are divided over the profiles, which are generated concurrently.
+	unsigned int nr_threads = std::max(1u, getNumberOfThreads() / std::max(1u, (unsigned int)profiles.size()));
+	std::vector<boost::shared_ptr<ViewConeSettings> > settings(profiles.size());
+	std::vector<std::vector<occupancy_grid_utils::Cell> > admissible_cells(first_area_profiles.size());
+	for (unsigned int i = 0; i < profiles.size(); ++i) {
+		const ViewConeProfile& profile = profiles[i];
+		settings[i].reset(new ViewConeSettings(*snapshot, *tiled_grid, region_masks[area_indices[i]], admissible_cells[area_indices[i]], sampling_, stencils[stencil_indices[i]], try_all_yaw_bins_, occupancy_threshold, profile.fov_, profile.view_distance_, profile.safe_distance_, nr_threads));
+		if (time_budget > ros::WallDuration(0)) {
+			settings[i]->deadline_ = start_time + time_budget;
+		}
+	}
+	
+	phase_start = ros::WallTime::now();
+	if (sampling_ != REJECTION_SAMPLING) {
+		for (unsigned int i = 0; i < first_area_profiles.size(); ++i) {
+			findAdmissibleCells(*settings[first_area_profiles[i]], std::vector<bool>(), admissible_cells[i]);
+			sampling_statistics_.nr_admissible_cells_ += admissible_cells[i].size();
+		}
+	}
+	phase_timings_.admissible_cells_ = ros::WallTime::now() - phase_start;
+	
+	ROS_INFO("(ViewConeGenerator) Generating %lu profiles with %lu region masks and %lu sets of stencils, %u threads each.", profiles.size(), first_area_profiles.size(), first_stencil_profiles.size(), nr_threads);
+	
+	// Every profile observes its own copy of the processed cells.
+	phase_start = ros::WallTime::now();
+	std::vector<TiledCoverage> processed_cells;
+	std::vector<SamplingStatistics> statistics(profiles.size());
+	processed_cells.reserve(profiles.size());
+	for (unsigned int i = 0; i < profiles.size(); ++i) {
+		processed_cells.push_back(area_processed_cells[area_indices[i]]);
+		progress[i].nr_free_cells_ = processed_cells[i].getNrUnprocessedCells();
+		progress[i].finished_ = false;
+	}
+	
+	if (profiles.size() > 1) {
+		boost::thread_group workers;
+		for (unsigned int i = 0; i < profiles.size(); ++i) {
+			workers.create_thread(boost::bind(&ViewConeGenerator::selectProfileViewCones, this, boost::ref(poses[i]), boost::cref(profiles[i]), boost::cref(*settings[i]), boost::ref(processed_cells[i]), boost::ref(statistics[i]), boost::ref(progress[i])));
+		}
+		workers.join_all();
+	} else if (profiles.size() == 1) {
+		selectProfileViewCones(poses[0], profiles[0], *settings[0], processed_cells[0], statistics[0], progress[0]);
+	}
+	phase_timings_.selection_ = ros::WallTime::now() - phase_start;
+	
+	for (unsigned int i = 0; i < profiles.size(); ++i) {
+		sampling_statistics_.nr_samples_ += statistics[i].nr_samples_;
+		sampling_statistics_.nr_accepted_samples_ += statistics[i].nr_accepted_samples_;
+		ROS_INFO("(ViewConeGenerator) Profile %u (fov=%f, view distance=%f): %u view cones cover %u of the %u free cells (%.1f%%) in %f seconds.", i, profiles[i].fov_, profiles[i].view_distance_, progress[i].nr_view_cones_, progress[i].nr_covered_cells_, progress[i].nr_free_cells_, 100.0f * progress[i].getCoverage(), progress[i].elapsed_time_.toSec());
+	}
+	phase_timings_.total_ = ros::WallTime::now() - start_time;
+	return progress;
+}
+
+void ViewConeGenerator::selectProfileViewCones(std::vector<geometry_msgs::Pose>& poses, const ViewConeProfile& profile, const ViewConeSettings& settings, TiledCoverage& processed_cells, SamplingStatistics& statistics, ViewConeProgress& progress) const
+{
+	// The view cones are not kept for incremental replanning.
+	ViewConePlan plan;
+	if (strategy_ == LAZY_GREEDY) {
+		unsigned int pool_size = pool_size_ == 0 ? 10 * profile.sample_size_ : pool_size_;
+		selectLazyGreedy(poses, profile.max_view_cones_, pool_size, settings, processed_cells, statistics, progress, ProgressCallback(), plan);
+	} else {
+		selectRandomRestart(poses, profile.max_view_cones_, profile.sample_size_, settings, processed_cells, statistics, progress, ProgressCallback(), plan);
+	}
+	
+	progress.finished_ = true;
+	reportProgress(progress, ProgressCallback());
+}
+
+void ViewConeGenerator::restrictToRegion(const TiledGrid& tiled_grid, const RegionMask& region_mask, TiledCoverage& processed_cells) const
+{
+	if (!region_mask.isRestricted()) {
+		return;
+	}
+	
+	// Tiles that do not overlap with the region are processed at once, the others cell by cell.
+	for (int tile_y = 0; tile_y < tiled_grid.getHeightInTiles(); ++tile_y) {
+		for (int tile_x = 0; tile_x < tiled_grid.getWidthInTiles(); ++tile_x) {
+			int min_x = tile_x << TiledGrid::TILE_SHIFT;
+			int min_y = tile_y << TiledGrid::TILE_SHIFT;
+			int max_x = std::min(min_x + TiledGrid::TILE_SIZE, tiled_grid.getWidth()) - 1;
+			int max_y = std::min(min_y + TiledGrid::TILE_SIZE, tiled_grid.getHeight()) - 1;
+			if (tiled_grid.getNrFreeCells(tile_x, tile_y) == 0) {
+				continue;
+			}
+			if (max_x < region_mask.getMinX() || min_x > region_mask.getMaxX() || max_y < region_mask.getMinY() || min_y > region_mask.getMaxY()) {
+				processed_cells.setTileProcessed(tile_x, tile_y);
+				continue;
+			}
+			for (int y = min_y; y <= max_y; ++y) {
+				for (int x = min_x; x <= max_x; ++x) {
+					if (!region_mask.contains(x, y)) {
+						processed_cells.setProcessed(x, y);
 					}
 				}
 			}
+		}
+	}
+}
+
+bool ViewConeGenerator::isAdmissible(const ViewConeSettings& settings, const occupancy_grid_utils::Cell& cell) const
+{
+	// Check if the cell falls within one of the regions.
+	if (!settings.region_mask_.contains(cell.x, cell.y)) {
+		return false;
+	}
+	
+	// Check if the cell is free.
+	int8_t value = settings.grid_.data[cell.x + cell.y * settings.grid_.info.width];
+	if (value == -1 || value > settings.occupancy_threshold_) {
+		return false;
+	}
+	
+	geometry_msgs::Point p = occupancy_grid_utils::cellCenter(settings.grid_.info, cell);
+	
+	// Check if this cell point is not too close to any obstacles.
+	if (settings.distance_field_.isBlocked(p, settings.safe_distance_)) {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Orders pairs of Morton codes and cells on their Morton code.
+ */
+struct MortonOrder
+{
+	bool operator()(const std::pair<uint64_t, occupancy_grid_utils::Cell>& lhs, const std::pair<uint64_t, occupancy_grid_utils::Cell>& rhs) const
+	{
+		return lhs.first < rhs.first;
+	}
+};
+
+/**
+ * Interleave the bits of the coordinates of a cell, sorting on this key puts the cells in Morton (Z-)order.
+ */
+static uint64_t mortonCode(const occupancy_grid_utils::Cell& cell)
+{
+	uint64_t code = 0;
+	for (unsigned int bit = 0; bit < 32; ++bit) {
+		code |= (uint64_t)(((unsigned int)cell.x >> bit) & 1) << (2 * bit);
+		code |= (uint64_t)(((unsigned int)cell.y >> bit) & 1) << (2 * bit + 1);
+	}
+	return code;
+}
+
+void ViewConeGenerator::findAdmissibleCells(const ViewConeSettings& settings, const std::vector<bool>& region, std::vector<occupancy_grid_utils::Cell>& admissible_cells) const
+{
+	// Only tiles with free cells can contain admissible cells.
+	const TiledGrid& tiled_grid = settings.tiled_grid_;
+	std::vector<std::pair<uint64_t, occupancy_grid_utils::Cell> > ordered_cells;
+	for (int tile_y = 0; tile_y < tiled_grid.getHeightInTiles(); ++tile_y) {
+		for (int tile_x = 0; tile_x < tiled_grid.getWidthInTiles(); ++tile_x) {
+			if (tiled_grid.getNrFreeCells(tile_x, tile_y) == 0 || (!region.empty() && !region[tile_x + tile_y * tiled_grid.getWidthInTiles()])) {
+				continue;
+			}
 			
-			//ROS_INFO("(ViewConeGenerator) Finished flood algorithm, %d cells in view.", complete_list.size());
-			
-			// Next we determine which of these cell points are visible from 'view_point'.
-			std::vector<occupancy_grid_utils::Cell> visible_cells;
-			for (std::vector<occupancy_grid_utils::Cell>::const_iterator ci = complete_list.begin(); ci != complete_list.end(); ++ci) {
-				
-				const occupancy_grid_utils::Cell& cell = *ci;
-				// Don't count cells that have already been processed.
-				if (processed_cells[cell.x + cell.y * last_received_occupancy_grid_msgs_.info.width]) {
-					continue;
+			int max_x = std::min((tile_x + 1) * TiledGrid::TILE_SIZE, tiled_grid.getWidth());
+			int max_y = std::min((tile_y + 1) * TiledGrid::TILE_SIZE, tiled_grid.getHeight());
+			for (int y = tile_y * TiledGrid::TILE_SIZE; y < max_y; ++y) {
+				for (int x = tile_x * TiledGrid::TILE_SIZE; x < max_x; ++x) {
+					occupancy_grid_utils::Cell cell(x, y);
+					if (isAdmissible(settings, cell)) {
+						ordered_cells.push_back(std::make_pair(mortonCode(cell), cell));
+					}
 				}
-				
-				geometry_msgs::Point point = occupancy_grid_utils::cellCenter(last_received_occupancy_grid_msgs_.info, *ci);
-				
-				if (canConnect(point, p, occupancy_threshold)) {
-					visible_cells.push_back(cell);
+			}
+		}
+	}
+	
+	std::sort(ordered_cells.begin(), ordered_cells.end(), MortonOrder());
+	
+	admissible_cells.reserve(admissible_cells.size() + ordered_cells.size());
+	for (std::vector<std::pair<uint64_t, occupancy_grid_utils::Cell> >::const_iterator ci = ordered_cells.begin(); ci != ordered_cells.end(); ++ci) {
+		admissible_cells.push_back((*ci).second);
+	}
+}
+
+bool ViewConeGenerator::isCompatible(const ViewConePlan& previous_plan, const ViewConePlan& plan)
+{
+	const nav_msgs::MapMetaData& previous_info = previous_plan.grid_->info;
+	const nav_msgs::MapMetaData& info = plan.grid_->info;
+	return previous_info.width == info.width && previous_info.height == info.height && previous_info.resolution == info.resolution &&
+	       previous_info.origin.position.x == info.origin.position.x && previous_info.origin.position.y == info.origin.position.y &&
+	       previous_info.origin.orientation.z == info.origin.orientation.z && previous_info.origin.orientation.w == info.origin.orientation.w &&
+	       previous_plan.regions_ == plan.regions_ && previous_plan.max_view_cones_ == plan.max_view_cones_ &&
+	       previous_plan.occupancy_threshold_ == plan.occupancy_threshold_ && previous_plan.fov_ == plan.fov_ &&
+	       previous_plan.view_distance_ == plan.view_distance_ && previous_plan.sample_size_ == plan.sample_size_ &&
+	       previous_plan.safe_distance_ == plan.safe_distance_ && previous_plan.strategy_ == plan.strategy_ &&
+	       previous_plan.pool_size_ == plan.pool_size_ && previous_plan.sampling_ == plan.sampling_ &&
+	       previous_plan.nr_yaw_bins_ == plan.nr_yaw_bins_ && previous_plan.try_all_yaw_bins_ == plan.try_all_yaw_bins_;
+}
+
+unsigned int ViewConeGenerator::findChangedTiles(const nav_msgs::OccupancyGrid& old_grid, const nav_msgs::OccupancyGrid& new_grid, const TiledGrid& tiled_grid, std::vector<bool>& changed_tiles) const
+{
+	const int width = tiled_grid.getWidth();
+	changed_tiles.assign(tiled_grid.getWidthInTiles() * tiled_grid.getHeightInTiles(), false);
+	
+	unsigned int nr_changed_tiles = 0;
+	for (int tile_y = 0; tile_y < tiled_grid.getHeightInTiles(); ++tile_y) {
+		for (int tile_x = 0; tile_x < tiled_grid.getWidthInTiles(); ++tile_x) {
+			int min_x = tile_x * TiledGrid::TILE_SIZE;
+			int nr_columns = std::min(TiledGrid::TILE_SIZE, width - min_x);
+			int max_y = std::min((tile_y + 1) * TiledGrid::TILE_SIZE, tiled_grid.getHeight());
+			for (int y = tile_y * TiledGrid::TILE_SIZE; y < max_y; ++y) {
+				if (memcmp(&old_grid.data[min_x + y * width], &new_grid.data[min_x + y * width], nr_columns) != 0) {
+					changed_tiles[tile_x + tile_y * tiled_grid.getWidthInTiles()] = true;
+					++nr_changed_tiles;
+					break;
 				}
 			}
-			
-			//ROS_INFO("(ViewConeGenerator) Finished checking visibility, %d cells actually visible.", visible_cells.size());
-			
-			// Check if this is the best view cone thus far.
-			if (visible_cells.size() > best_visible_cells.size()) {
-				best_pose = pose;
-				best_visible_cells = visible_cells;
-				
-				tf::Quaternion q(best_pose.orientation.x, best_pose.orientation.y, best_pose.orientation.z, best_pose.orientation.w);
-				float best_yaw = tf::getYaw(q);
-				
-				//ROS_INFO("(ViewConeGenerator) Best new pose(%f, %f, %f), yaw=%f (actual=%f) with %d cells.", best_pose.position.x, best_pose.position.y, best_pose.position.z, best_yaw, yaw, visible_cells.size());
+		}
+	}
+	return nr_changed_tiles;
+}
+
+int ViewConeGenerator::getViewConeRadius(const nav_msgs::MapMetaData& info, float fov, float view_distance, float safe_distance) const
+{
+	// The far corners of a view cone are view_distance / cos(fov / 2) away from the view point.
+	float reach = view_distance / std::max((float)fabs(cos(fov / 2.0f)), 0.01f);
+	return (int)ceil(std::max(reach, safe_distance) / info.resolution) + 1;
+}
+
+void ViewConeGenerator::sampleCandidates(unsigned int iteration, const ViewConeSettings& settings, const TiledCoverage& processed_cells, std::vector<ViewConeCandidate>& candidates, SamplingStatistics& statistics) const
+{
+	unsigned int nr_threads = settings.nr_threads_;
+	if (nr_threads > 1) {
+		boost::thread_group workers;
+		for (unsigned int thread_id = 0; thread_id < nr_threads; ++thread_id) {
+			workers.create_thread(boost::bind(&ViewConeGenerator::sampleViewCones, this, iteration, thread_id, nr_threads, boost::cref(settings), boost::cref(processed_cells), boost::ref(candidates)));
+		}
+		workers.join_all();
+	} else {
+		sampleViewCones(iteration, 0, 1, settings, processed_cells, candidates);
+	}
+	
+	statistics.nr_samples_ += candidates.size();
+	for (std::vector<ViewConeCandidate>::const_iterator ci = candidates.begin(); ci != candidates.end(); ++ci) {
+		if ((*ci).accepted_) {
+			++statistics.nr_accepted_samples_;
+		}
+	}
+}
+
+void ViewConeGenerator::selectRandomRestart(std::vector<geometry_msgs::Pose>& poses, unsigned int max_view_cones, unsigned int sample_size, const ViewConeSettings& settings, TiledCoverage& processed_cells, SamplingStatistics& statistics, ViewConeProgress& progress, const ProgressCallback& progress_callback, ViewConePlan& plan) const
+{
+	for (unsigned int i = 0; i < max_view_cones; ++i) {
+		// The view cones that have been selected so far are the best we can do in time.
+		if (settings.isDeadlineReached()) {
+			progress.deadline_reached_ = true;
+			break;
+		}
+		
+		//ROS_INFO("(ViewConeGenerator) Process view cone: %d.", i);
+		// First we generate a bunch of random view cones and rate them.
+		std::vector<ViewConeCandidate> candidates(sample_size);
+		sampleCandidates(i, settings, processed_cells, candidates, statistics);
+		
+		// Pick the best view cone. Ties are broken by the lowest sample index, so the result does not depend 
+		// on the number of threads.
+		const ViewConeCandidate* best_candidate = NULL;
+		for (std::vector<ViewConeCandidate>::const_iterator ci = candidates.begin(); ci != candidates.end(); ++ci) {
+			if (best_candidate == NULL || (*ci).visible_cells_.size() > best_candidate->visible_cells_.size()) {
+				best_candidate = &*ci;
 			}
 		}
 		
-		if (best_visible_cells.empty()) {
+		if (best_candidate == NULL || best_candidate->visible_cells_.empty()) {
 			ROS_INFO("(ViewConeGenerator) No good poses found!");
 			continue;
 		}
 		
-		// Update the state of which cells have been observed.
-		for (std::vector<occupancy_grid_utils::Cell>::const_iterator ci = best_visible_cells.begin(); ci != best_visible_cells.end(); ++ci) {
-			const occupancy_grid_utils::Cell& cell = *ci;
-			processed_cells[cell.x + cell.y * last_received_occupancy_grid_msgs_.info.width] = true;
+		markObserved(settings.grid_, *best_candidate, processed_cells, progress, plan);
+		poses.push_back(best_candidate->pose_);
+		reportProgress(progress, progress_callback);
+	}
+}
+
+void ViewConeGenerator::selectLazyGreedy(std::vector<geometry_msgs::Pose>& poses, unsigned int max_view_cones, unsigned int pool_size, const ViewConeSettings& settings, TiledCoverage& processed_cells, SamplingStatistics& statistics, ViewConeProgress& progress, const ProgressCallback& progress_callback, ViewConePlan& plan) const
+{
+	// Sample and evaluate the pool of candidates once.
+	std::vector<ViewConeCandidate> candidates(pool_size);
+	sampleCandidates(0, settings, processed_cells, candidates, statistics);
+	
+	std::priority_queue<LazyGreedyEntry> queue;
+	for (unsigned int i = 0; i < candidates.size(); ++i) {
+		if (!candidates[i].visible_cells_.empty()) {
+			queue.push(LazyGreedyEntry(candidates[i].visible_cells_.size(), i, 0));
 		}
+	}
+	
+	ROS_INFO("(ViewConeGenerator) Sampled %lu candidates, %lu of them are valid.", candidates.size(), queue.size());
+	
+	// If the deadline passed while sampling, the pool is incomplete but the selection is cheap enough to finish.
+	progress.deadline_reached_ = settings.isDeadlineReached();
+	
+	unsigned int nr_selected = 0;
+	unsigned int nr_evaluations = 0;
+	while (nr_selected < max_view_cones && !queue.empty()) {
+		LazyGreedyEntry entry = queue.top();
+		queue.pop();
 		
-		tf::Quaternion q(best_pose.orientation.x, best_pose.orientation.y, best_pose.orientation.z, best_pose.orientation.w);
-		float yaw = tf::getYaw(q);
+		ViewConeCandidate& candidate = candidates[entry.candidate_];
 		
-		ROS_INFO("(ViewConeGenerator) Add the pose(%f, %f, %f), yaw=%f with %d cells to the return list.", best_pose.position.x, best_pose.position.y, best_pose.position.z, yaw, best_visible_cells.size());
-		poses.push_back(best_pose);
+		// The gain is up to date, so no other candidate can do better.
+		if (entry.evaluated_at_ == nr_selected) {
+			markObserved(settings.grid_, candidate, processed_cells, progress, plan);
+			poses.push_back(candidate.pose_);
+			++nr_selected;
+			reportProgress(progress, progress_callback);
+			continue;
+		}
+		
+		// Remove the cells that have been observed since this candidate was last evaluated, the remaining 
+		// cells are its gain. This keeps the next evaluation of this candidate cheap.
+		std::vector<occupancy_grid_utils::Cell>& visible_cells = candidate.visible_cells_;
+		unsigned int nr_remaining = 0;
+		for (unsigned int i = 0; i < visible_cells.size(); ++i) {
+			const occupancy_grid_utils::Cell& cell = visible_cells[i];
+			if (!processed_cells.isProcessed(cell.x, cell.y)) {
+				visible_cells[nr_remaining++] = cell;
+			}
+		}
+		visible_cells.resize(nr_remaining);
+		++nr_evaluations;
+		
+		if (nr_remaining > 0) {
+			queue.push(LazyGreedyEntry(nr_remaining, entry.candidate_, nr_selected));
+		}
 	}
 	
-	for (std::vector<geometry_msgs::Pose>::const_iterator ci = poses.begin(); ci != poses.end(); ++ci) {
-		ROS_INFO("(ViewConeGenerator) Found the pose(%f, %f, %f).", (*ci).position.x, (*ci).position.y, (*ci).position.z);
+	if (nr_selected < max_view_cones) {
+		ROS_INFO("(ViewConeGenerator) No good poses found, only %u view cones were selected!", nr_selected);
 	}
+	ROS_INFO("(ViewConeGenerator) Selected %u view cones, %u candidates were re-evaluated.", nr_selected, nr_evaluations);
+}
+
+void ViewConeGenerator::markObserved(const nav_msgs::OccupancyGrid& grid, const ViewConeCandidate& candidate, TiledCoverage& processed_cells, ViewConeProgress& progress, ViewConePlan& plan) const
+{
+	const geometry_msgs::Pose& pose = candidate.pose_;
+	const std::vector<occupancy_grid_utils::Cell>& visible_cells = candidate.visible_cells_;
 	
-	// Visualise the view cones.
-	visualiseViewCones(poses, view_distance, fov);
+	// Update the state of which cells have been observed.
+	for (std::vector<occupancy_grid_utils::Cell>::const_iterator ci = visible_cells.begin(); ci != visible_cells.end(); ++ci) {
+		const occupancy_grid_utils::Cell& cell = *ci;
+		if (processed_cells.setProcessed(cell.x, cell.y)) {
+			++progress.nr_covered_cells_;
+		}
+	}
+	
+	++progress.nr_view_cones_;
+	plan.view_cones_.push_back(candidate);
+	
+	tf::Quaternion q(pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w);
+	float yaw = tf::getYaw(q);
+	
+	ROS_INFO("(ViewConeGenerator) Add the pose(%f, %f, %f), yaw=%f with %d cells to the return list.", pose.position.x, pose.position.y, pose.position.z, yaw, visible_cells.size());
+}
+
+void ViewConeGenerator::reportProgress(ViewConeProgress& progress, const ProgressCallback& progress_callback) const
+{
+	progress.elapsed_time_ = ros::WallTime::now() - progress.start_time_;
+	
+	if (progress_callback) {
+		progress_callback(progress);
+	}
+	
+	// Nothing is published when running without a ROS master.
+	if (!diagnostics_pub_) {
+		return;
+	}
+	
+	diagnostic_msgs::DiagnosticStatus status;
+	status.name = "ViewConeGenerator";
+	status.level = progress.deadline_reached_ ? diagnostic_msgs::DiagnosticStatus::WARN : diagnostic_msgs::DiagnosticStatus::OK;
+	status.message = progress.finished_ ? (progress.deadline_reached_ ? "Time budget ran out" : "Finished") : "Creating view cones";
+	
+	std::stringstream ss;
+	diagnostic_msgs::KeyValue key_value;
+	key_value.key = "view_cones";
+	ss << progress.nr_view_cones_;
+	key_value.value = ss.str();
+	status.values.push_back(key_value);
+	
+	ss.str(std::string());
+	key_value.key = "covered_cells";
+	ss << progress.nr_covered_cells_;
+	key_value.value = ss.str();
+	status.values.push_back(key_value);
+	
+	ss.str(std::string());
+	key_value.key = "free_cells";
+	ss << progress.nr_free_cells_;
+	key_value.value = ss.str();
+	status.values.push_back(key_value);
+	
+	ss.str(std::string());
+	key_value.key = "coverage";
+	ss << progress.getCoverage();
+	key_value.value = ss.str();
+	status.values.push_back(key_value);
+	
+	ss.str(std::string());
+	key_value.key = "elapsed_time";
+	ss << progress.elapsed_time_.toSec();
+	key_value.value = ss.str();
+	status.values.push_back(key_value);
+	
+	diagnostic_msgs::DiagnosticArray diagnostics;
+	diagnostics.header.stamp = ros::Time::now();
+	diagnostics.status.push_back(status);
+	diagnostics_pub_.publish(diagnostics);
+}
+
+void ViewConeGenerator::sampleViewCones(unsigned int iteration, unsigned int thread_id, unsigned int nr_threads, const ViewConeSettings& settings, const TiledCoverage& processed_cells, std::vector<ViewConeCandidate>& candidates) const
+{
+	for (unsigned int sample = thread_id; sample < candidates.size(); sample += nr_threads) {
+		// Samples that are not drawn before the deadline are left rejected.
+		if (settings.isDeadlineReached()) {
+			break;
+		}
+		sampleViewCone(iteration, sample, candidates.size(), settings, processed_cells, candidates[sample]);
+	}
+}
+
+void ViewConeGenerator::sampleViewCone(unsigned int iteration, unsigned int sample, unsigned int nr_samples, const ViewConeSettings& settings, const TiledCoverage& processed_cells, ViewConeCandidate& candidate) const
+{
+	// Every sample gets its own generator, seeded from the seed, the iteration and the sample index. This way 
+	// the sampled poses do not depend on which thread processes which sample.
+	std::size_t sample_seed = seed_;
+	boost::hash_combine(sample_seed, iteration);
+	boost::hash_combine(sample_seed, sample);
+	boost::random::mt19937 generator(sample_seed);
+	
+	occupancy_grid_utils::Cell c;
+	if (settings.sampling_ == REJECTION_SAMPLING) {
+		c.x = boost::random::uniform_int_distribution<int>(0, settings.grid_.info.width - 1)(generator);
+		c.y = boost::random::uniform_int_distribution<int>(0, settings.grid_.info.height - 1)(generator);
+		if (!isAdmissible(settings, c)) {
+			return;
+		}
+	} else {
+		const std::vector<occupancy_grid_utils::Cell>& admissible_cells = settings.admissible_cells_;
+		if (admissible_cells.empty()) {
+			return;
+		}
+		
+		// Every sample draws from its own range of the admissible cells. The cells are in Morton order, so 
+		// each range covers a compact area and the samples are spread over the whole grid.
+		std::size_t first = 0;
+		std::size_t last = admissible_cells.size() - 1;
+		if (settings.sampling_ == ADMISSIBLE_STRATIFIED && nr_samples <= admissible_cells.size()) {
+			first = (std::size_t)((uint64_t)sample * admissible_cells.size() / nr_samples);
+			last = (std::size_t)((uint64_t)(sample + 1) * admissible_cells.size() / nr_samples) - 1;
+		}
+		c = admissible_cells[boost::random::uniform_int_distribution<std::size_t>(first, last)(generator)];
+	}
+	candidate.accepted_ = true;
+	candidate.view_cell_ = c;
+	
+	geometry_msgs::Point p = occupancy_grid_utils::cellCenter(settings.grid_.info, c);
+	
+	float yaw;
+	if (settings.stencils_.empty()) {
+		yaw = boost::random::uniform_real_distribution<float>(0.0f, 2 * M_PI)(generator);
+		
+		//ROS_INFO("(ViewConeGenerator) Sample cone: (%f, %f) %f.", p.x, p.y, yaw);
+		
+		// Calculate the triangle points encompasses the area that is viewed.
+		tf::Vector3 view_point(p.x, p.y, p.z);
+		tf::Vector3 v1, v2;
+		computeViewConeCorners(view_point, yaw, settings.fov_, settings.view_distance_, v1, v2);
+		
+		// The triangle now is view_point, v1, v2, we rasterise it to find the cells that are inside the
+		// viewing cone.
+		std::vector<occupancy_grid_utils::Cell> complete_list;
+		rasteriseViewCone(settings.grid_.info, view_point, v1, v2, c, complete_list);
+		
+		//ROS_INFO("(ViewConeGenerator) Finished rasterisation, %d cells in view.", complete_list.size());
+		
+		// Next we determine which of these cell points are visible from 'view_point'.
+		findVisibleCells(settings, c, complete_list, processed_cells, candidate.visible_cells_);
+	} else {
+		// The footprint of the view cone is looked up in the stencils.
+		int yaw_bin = -1;
+		if (!settings.try_all_yaw_bins_) {
+			yaw_bin = boost::random::uniform_int_distribution<int>(0, settings.stencils_.size() - 1)(generator);
+		}
+		yaw = settings.stencils_[evaluateStencils(settings, c, yaw_bin, processed_cells, candidate.visible_cells_)].yaw_;
+	}
+	
+	//ROS_INFO("(ViewConeGenerator) Finished checking visibility, %d cells actually visible.", candidate.visible_cells_.size());
+	
+	geometry_msgs::Pose pose;
+	pose.position = p;
+	
+	tf::Quaternion q;
+	q.setEulerZYX(yaw, 0.0f, 0.0f);
+
+	pose.orientation.x = q.getX();
+	pose.orientation.y = q.getY();
+	pose.orientation.z = q.getZ();
+	pose.orientation.w = q.getW();
+	
+	candidate.pose_ = pose;
+}
+
+void ViewConeGenerator::computeViewConeCorners(const tf::Vector3& view_point, float yaw, float fov, float view_distance, tf::Vector3& v1, tf::Vector3& v2) const
+{
+	tf::Vector3 v0(view_distance, 0.0f, 0.0f);
+	v0 = v0.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), yaw);
+	
+	//ROS_INFO("(ViewConeGenerator) Viewing direction: (%f, %f, %f).", v0.x(), v0.y(), v0.z());
+	
+	tf::Vector3 v0_normalised = v0.normalized();
+	
+	v1 = v0;
+	v1 = v1.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), fov / 2.0f);
+	v1 = v1.normalize();
+	
+	float length = v0.length() / v0_normalised.dot(v1);
+	v1 *= length;
+	v1 += view_point;
+	
+	//ROS_INFO("(ViewConeGenerator) V1 (actual): (%f, %f, %f); length = %f.", v1.x(), v1.y(), v1.z(), length);
+	
+	v2 = v0;
+	v2 = v2.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), -fov / 2.0f);
+	v2 = v2.normalize();
+	
+	length = v0.length() / v0_normalised.dot(v2);
+	v2 *= length;
+	v2 += view_point;
+	
+	//ROS_INFO("(ViewConeGenerator) V2 (actual): (%f, %f, %f); length = %f.", v2.x(), v2.y(), v2.z(), length);
+}
+
+void ViewConeGenerator::buildStencils(const nav_msgs::MapMetaData& info, float fov, float view_distance, unsigned int nr_yaw_bins, std::vector<ViewConeStencil>& stencils) const
+{
+	// Rasterise the view cones in a grid that is just large enough to contain any of them, with the view point 
+	// at the centre of the middle cell. The grid has the same resolution and orientation as the occupancy grid, 
+	// so the stencils can be translated to any cell.
+	int radius = getViewConeRadius(info, fov, view_distance, 0.0f);
+	nav_msgs::MapMetaData stencil_info = info;
+	stencil_info.width = 2 * radius + 1;
+	stencil_info.height = 2 * radius + 1;
+	
+	occupancy_grid_utils::Cell view_cell(radius, radius);
+	geometry_msgs::Point p = occupancy_grid_utils::cellCenter(stencil_info, view_cell);
+	tf::Vector3 view_point(p.x, p.y, p.z);
+	
+	stencils.resize(nr_yaw_bins);
+	for (unsigned int i = 0; i < nr_yaw_bins; ++i) {
+		ViewConeStencil& stencil = stencils[i];
+		stencil.yaw_ = i * 2 * M_PI / nr_yaw_bins;
+		stencil.min_dx_ = stencil.max_dx_ = stencil.min_dy_ = stencil.max_dy_ = 0;
+		
+		tf::Vector3 v1, v2;
+		computeViewConeCorners(view_point, stencil.yaw_, fov, view_distance, v1, v2);
+		
+		std::vector<occupancy_grid_utils::Cell> cells;
+		rasteriseViewCone(stencil_info, view_point, v1, v2, view_cell, cells);
+		
+		for (std::vector<occupancy_grid_utils::Cell>::const_iterator ci = cells.begin(); ci != cells.end(); ++ci) {
+			int dx = (*ci).x - radius;
+			int dy = (*ci).y - radius;
+			if (dx == 0 && dy == 0) {
+				continue;
+			}
+			
+			stencil.offsets_.push_back(std::make_pair(dx, dy));
+			stencil.min_dx_ = std::min(stencil.min_dx_, dx);
+			stencil.max_dx_ = std::max(stencil.max_dx_, dx);
+			stencil.min_dy_ = std::min(stencil.min_dy_, dy);
+			stencil.max_dy_ = std::max(stencil.max_dy_, dy);
+		}
+	}
+}
+
+unsigned int ViewConeGenerator::evaluateStencils(const ViewConeSettings& settings, const occupancy_grid_utils::Cell& view_cell, int yaw_bin, const TiledCoverage& processed_cells, std::vector<occupancy_grid_utils::Cell>& visible_cells) const
+{
+	const nav_msgs::OccupancyGrid& grid = settings.grid_;
+	const int grid_width = grid.info.width;
+	const std::vector<ViewConeStencil>& stencils = settings.stencils_;
+	
+	unsigned int first_bin = yaw_bin < 0 ? 0 : yaw_bin;
+	unsigned int last_bin = yaw_bin < 0 ? stencils.size() - 1 : yaw_bin;
+	
+	// The visibility does not depend on the yaw, so it is computed once for the area covered by all the bins.
+	const int view_x = view_cell.x;
+	const int view_y = view_cell.y;
+	int min_x = view_x;
+	int max_x = view_x;
+	int min_y = view_y;
+	int max_y = view_y;
+	for (unsigned int bin = first_bin; bin <= last_bin; ++bin) {
+		min_x = std::min(min_x, view_x + stencils[bin].min_dx_);
+		max_x = std::max(max_x, view_x + stencils[bin].max_dx_);
+		min_y = std::min(min_y, view_y + stencils[bin].min_dy_);
+		max_y = std::max(max_y, view_y + stencils[bin].max_dy_);
+	}
+	min_x = std::max(min_x, 0);
+	max_x = std::min(max_x, grid_width - 1);
+	min_y = std::max(min_y, 0);
+	max_y = std::min(max_y, (int)grid.info.height - 1);
+	const int width = max_x - min_x + 1;
+	
+	// Nothing can be gained if all the tiles in reach have been processed.
+	if (processed_cells.isAreaProcessed(min_x, min_y, max_x, max_y)) {
+		return first_bin;
+	}
+	
+	std::vector<float> transparency;
+	computeTransparency(settings, view_cell, min_x, min_y, max_x, max_y, transparency);
+	
+	// Count the visible, unprocessed cells of every bin. Offsets that fall outside the grid are skipped.
+	unsigned int best_bin = first_bin;
+	if (first_bin != last_bin) {
+		unsigned int best_nr_visible_cells = 0;
+		for (unsigned int bin = first_bin; bin <= last_bin; ++bin) {
+			const std::vector<std::pair<int, int> >& offsets = stencils[bin].offsets_;
+			unsigned int nr_visible_cells = 0;
+			for (std::vector<std::pair<int, int> >::const_iterator ci = offsets.begin(); ci != offsets.end(); ++ci) {
+				int x = view_x + (*ci).first;
+				int y = view_y + (*ci).second;
+				if (x >= min_x && x <= max_x && y >= min_y && y <= max_y &&
+				    !processed_cells.isProcessed(x, y) && transparency[(x - min_x) + (y - min_y) * width] >= 0.5f) {
+					++nr_visible_cells;
+				}
+			}
+			
+			if (nr_visible_cells > best_nr_visible_cells) {
+				best_nr_visible_cells = nr_visible_cells;
+				best_bin = bin;
+			}
+		}
+	}
+	
+	// The view point is always visible.
+	if (!processed_cells.isProcessed(view_x, view_y)) {
+		visible_cells.push_back(view_cell);
+	}
+	
+	const std::vector<std::pair<int, int> >& offsets = stencils[best_bin].offsets_;
+	for (std::vector<std::pair<int, int> >::const_iterator ci = offsets.begin(); ci != offsets.end(); ++ci) {
+		int x = view_x + (*ci).first;
+		int y = view_y + (*ci).second;
+		if (x >= min_x && x <= max_x && y >= min_y && y <= max_y &&
+		    !processed_cells.isProcessed(x, y) && transparency[(x - min_x) + (y - min_y) * width] >= 0.5f) {
+			visible_cells.push_back(occupancy_grid_utils::Cell(x, y));
+		}
+	}
+	return best_bin;
 }
 
 void ViewConeGenerator::visualiseViewCones(const std::vector<geometry_msgs::Pose>& poses, float view_distance, float fov) const
 {
+	// Nothing is published when running without a ROS master.
+	if (!rivz_pub_) {
+		return;
+	}
+	
 	std::vector<geometry_msgs::Point> waypoints;
 	std::vector<std_msgs::ColorRGBA> waypoint_colours;
 	std::vector<geometry_msgs::Point> triangle_points;
@@ -418,52 +1234,199 @@ void ViewConeGenerator::visualiseViewCones(const std::vector<geometry_msgs::Pose
 	rivz_pub_.publish(marker_array);
 }
 
-bool ViewConeGenerator::canConnect(const geometry_msgs::Point& w1, const geometry_msgs::Point& w2, int occupancy_threshold)
+void ViewConeGenerator::rasteriseViewCone(const nav_msgs::MapMetaData& info, const tf::Vector3& view_point, const tf::Vector3& v1, const tf::Vector3& v2, const occupancy_grid_utils::Cell& view_cell, std::vector<occupancy_grid_utils::Cell>& cells) const
 {
-	occupancy_grid_utils::RayTraceIterRange ray_range = occupancy_grid_utils::rayTrace(last_received_occupancy_grid_msgs_.info, w1, w2, true, true);
-	for (occupancy_grid_utils::RayTraceIterator i = ray_range.first; i != ray_range.second; ++i)
-	{
-		const occupancy_grid_utils::Cell& cell = *i;
-
-		// Check if this cell is occupied.
-		if (cell.x + cell.y * last_received_occupancy_grid_msgs_.info.width < last_received_occupancy_grid_msgs_.data.size() && cell.x + cell.y * last_received_occupancy_grid_msgs_.info.width >= 0 && last_received_occupancy_grid_msgs_.data[cell.x + cell.y * last_received_occupancy_grid_msgs_.info.width] > occupancy_threshold)
-		{
-			return false;
-		}
+	// Work in grid coordinates, where the centre of cell (x, y) lies at (x, y).
+	tf::Transform map_to_world;
+	tf::poseMsgToTF(info.origin, map_to_world);
+	tf::Transform world_to_map = map_to_world.inverse();
+	
+	tf::Vector3 corners[3] = { world_to_map * view_point, world_to_map * v1, world_to_map * v2 };
+	for (int i = 0; i < 3; ++i) {
+		corners[i] = tf::Vector3(corners[i].x() / info.resolution - 0.5, corners[i].y() / info.resolution - 0.5, 0.0);
 	}
+	const tf::Vector3& a = corners[0];
+	const tf::Vector3& b = corners[1];
+	const tf::Vector3& c = corners[2];
 	
-	return true;
-}
-
-
-bool ViewConeGenerator::isBlocked(const geometry_msgs::Point& point, float min_distance) const
-{
-	for (float x = -min_distance - last_received_occupancy_grid_msgs_.info.resolution; x < min_distance + last_received_occupancy_grid_msgs_.info.resolution; x += last_received_occupancy_grid_msgs_.info.resolution)
-	{
-		for (float y = -min_distance - last_received_occupancy_grid_msgs_.info.resolution; y < min_distance + last_received_occupancy_grid_msgs_.info.resolution; y += last_received_occupancy_grid_msgs_.info.resolution)
-		{
-			if (sqrt(x * x + y * y) > min_distance)
-			{
+	// The view point is always visible.
+	cells.push_back(view_cell);
+	
+	double min_y = std::min(a.y(), std::min(b.y(), c.y()));
+	double max_y = std::max(a.y(), std::max(b.y(), c.y()));
+	int first_row = std::max(0, (int)floor(min_y));
+	int last_row = std::min((int)info.height - 1, (int)ceil(max_y));
+	
+	// The edge functions use the same winding as the original inside test: a cell centre is inside the
+	// cone if all three edge functions are strictly positive or all are strictly negative.
+	const tf::Vector3* edge_start[3] = { &b, &c, &a };
+	const tf::Vector3* edge_end[3] = { &c, &a, &b };
+	
+	for (int y = first_row; y <= last_row; ++y) {
+		
+		// Find the span of this row that overlaps with the triangle.
+		double span_min = std::numeric_limits<double>::max();
+		double span_max = -std::numeric_limits<double>::max();
+		for (int i = 0; i < 3; ++i) {
+			const tf::Vector3& p0 = *edge_start[i];
+			const tf::Vector3& p1 = *edge_end[i];
+			if ((y < p0.y() && y < p1.y()) || (y > p0.y() && y > p1.y())) {
 				continue;
 			}
 			
-			geometry_msgs::Point p;
-			p.x = x + point.x;
-			p.y = y + point.y;
-			
-			occupancy_grid_utils::Cell cell = occupancy_grid_utils::pointCell(last_received_occupancy_grid_msgs_.info, p);
+			if (p0.y() == p1.y()) {
+				span_min = std::min(span_min, std::min(p0.x(), p1.x()));
+				span_max = std::max(span_max, std::max(p0.x(), p1.x()));
+			} else {
+				double x = p0.x() + (y - p0.y()) * (p1.x() - p0.x()) / (p1.y() - p0.y());
+				span_min = std::min(span_min, x);
+				span_max = std::max(span_max, x);
+			}
+		}
+		
+		if (span_min > span_max) {
+			continue;
+		}
+		
+		int first_column = std::max(0, (int)floor(span_min));
+		int last_column = std::min((int)info.width - 1, (int)ceil(span_max));
+		
+		// Evaluate the edge functions at the start of the span and step them along the row.
+		double edge[3];
+		double edge_step[3];
+		for (int i = 0; i < 3; ++i) {
+			const tf::Vector3& p0 = *edge_start[i];
+			const tf::Vector3& p1 = *edge_end[i];
+			edge[i] = (first_column - p0.x()) * (p1.y() - p0.y()) - (y - p0.y()) * (p1.x() - p0.x());
+			edge_step[i] = p1.y() - p0.y();
+		}
+		
+		for (int x = first_column; x <= last_column; ++x) {
+			if (((edge[0] > 0 && edge[1] > 0 && edge[2] > 0) || (edge[0] < 0 && edge[1] < 0 && edge[2] < 0)) &&
+			    (x != view_cell.x || y != view_cell.y)) {
+				cells.push_back(occupancy_grid_utils::Cell(x, y));
+			}
 			
-			if (cell.x < 0 || cell.y < 0 || cell.x >= last_received_occupancy_grid_msgs_.info.width || cell.y >= last_received_occupancy_grid_msgs_.info.height) {
-				continue;
+			for (int i = 0; i < 3; ++i) {
+				edge[i] += edge_step[i];
 			}
+		}
+	}
+}
+
+void ViewConeGenerator::findVisibleCells(const ViewConeSettings& settings, const occupancy_grid_utils::Cell& view_cell, const std::vector<occupancy_grid_utils::Cell>& cells, const TiledCoverage& processed_cells, std::vector<occupancy_grid_utils::Cell>& visible_cells) const
+{
+	if (cells.empty()) {
+		return;
+	}
+	
+	// The lines of sight of the cells stay within the bounding box of the view cell and the cells, so the 
+	// sweep only needs to cover that area.
+	int min_x = view_cell.x;
+	int max_x = view_cell.x;
+	int min_y = view_cell.y;
+	int max_y = view_cell.y;
+	for (std::vector<occupancy_grid_utils::Cell>::const_iterator ci = cells.begin(); ci != cells.end(); ++ci) {
+		min_x = std::min(min_x, (int)(*ci).x);
+		max_x = std::max(max_x, (int)(*ci).x);
+		min_y = std::min(min_y, (int)(*ci).y);
+		max_y = std::max(max_y, (int)(*ci).y);
+	}
+	const int width = max_x - min_x + 1;
+	
+	// Nothing can be gained if all the tiles in reach have been processed.
+	if (processed_cells.isAreaProcessed(min_x, min_y, max_x, max_y)) {
+		return;
+	}
+	
+	std::vector<float> transparency;
+	computeTransparency(settings, view_cell, min_x, min_y, max_x, max_y, transparency);
+	
+	// A cell is visible if at least half of its line of sight is unobstructed.
+	for (std::vector<occupancy_grid_utils::Cell>::const_iterator ci = cells.begin(); ci != cells.end(); ++ci) {
+		const occupancy_grid_utils::Cell& cell = *ci;
+		
+		// Don't count cells that have already been processed.
+		if (processed_cells.isProcessed(cell.x, cell.y)) {
+			continue;
+		}
+		
+		if (transparency[(cell.x - min_x) + (cell.y - min_y) * width] >= 0.5f) {
+			visible_cells.push_back(cell);
+		}
+	}
+}
+
+void ViewConeGenerator::computeTransparency(const ViewConeSettings& settings, const occupancy_grid_utils::Cell& view_cell, int min_x, int min_y, int max_x, int max_y, std::vector<float>& transparency) const
+{
+	const int grid_width = settings.grid_.info.width;
+	const int8_t* data = &settings.grid_.data[0];
+	const int occupancy_threshold = settings.occupancy_threshold_;
+	
+	const int width = max_x - min_x + 1;
+	const int height = max_y - min_y + 1;
+	const int view_x = view_cell.x - min_x;
+	const int view_y = view_cell.y - min_y;
+	
+	// Without any obstacles in the rectangle every line of sight is unobstructed.
+	if (settings.tiled_grid_.isAreaFree(min_x, min_y, max_x, max_y)) {
+		transparency.assign(width * height, 1.0f);
+		return;
+	}
+	
+	// The fraction of the line of sight between each cell and the view cell that is unobstructed.
+	transparency.assign(width * height, 0.0f);
+	transparency[view_x + view_y * width] = 1.0f;
+	
+	// Sweep outwards from the view cell one ring (cells at the same Chebyshev distance) at a time. The line of 
+	// sight of a cell crosses the previous ring between two neighbouring cells, its transparency is interpolated 
+	// between theirs. Occupied cells are opaque.
+	int nr_rings = std::max(std::max(view_x, width - 1 - view_x), std::max(view_y, height - 1 - view_y));
+	for (int ring = 1; ring <= nr_rings; ++ring) {
+		int ring_min_y = std::max(0, view_y - ring);
+		int ring_max_y = std::min(height - 1, view_y + ring);
+		for (int y = ring_min_y; y <= ring_max_y; ++y) {
 			
-			if (last_received_occupancy_grid_msgs_.data[cell.x + cell.y * last_received_occupancy_grid_msgs_.info.width] > 0)
-			{
-				return true;
+			// On the top and bottom row of the ring all cells are visited, otherwise only the two ends.
+			bool full_row = y == view_y - ring || y == view_y + ring;
+			int ring_min_x = std::max(0, view_x - ring);
+			int ring_max_x = std::min(width - 1, view_x + ring);
+			int x_step = full_row ? 1 : 2 * ring;
+			for (int x = view_x - ring; x <= view_x + ring; x += x_step) {
+				if (x < ring_min_x || x > ring_max_x) {
+					continue;
+				}
+				
+				if (data[(x + min_x) + (y + min_y) * grid_width] > occupancy_threshold) {
+					continue;
+				}
+				
+				int dx = x - view_x;
+				int dy = y - view_y;
+				
+				// Find the two cells on the previous ring where the line of sight crosses it.
+				int a, b;
+				float weight;
+				if (std::abs(dx) >= std::abs(dy)) {
+					int previous_x = dx > 0 ? x - 1 : x + 1;
+					float crossing = view_y + (float)((previous_x - view_x) * dy) / dx;
+					int previous_y = (int)floor(crossing);
+					weight = crossing - previous_y;
+					a = previous_x + previous_y * width;
+					b = weight > 0 ? a + width : a;
+				} else {
+					int previous_y = dy > 0 ? y - 1 : y + 1;
+					float crossing = view_x + (float)((previous_y - view_y) * dx) / dy;
+					int previous_x = (int)floor(crossing);
+					weight = crossing - previous_x;
+					a = previous_x + previous_y * width;
+					b = weight > 0 ? a + 1 : a;
+				}
+				
+				transparency[x + y * width] = (1.0f - weight) * transparency[a] + weight * transparency[b];
 			}
 		}
 	}
-	return false;
 }
 
 };
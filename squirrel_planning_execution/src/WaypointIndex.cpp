@@ -0,0 +1,148 @@
+#include <squirrel_planning_execution/WaypointIndex.h>
+
+#include <algorithm>
+#include <math.h>
+
+namespace KCL_rosplan {
+
+WaypointIndex::WaypointIndex(double cell_size)
+{
+	reset(cell_size);
+}
+
+void WaypointIndex::reset(double cell_size)
+{
+	cell_size_ = cell_size > 0 ? cell_size : 1.0;
+	clear();
+}
+
+void WaypointIndex::clear()
+{
+	buckets_.clear();
+	cell_of_waypoint_.clear();
+	min_cell_x_ = min_cell_y_ = 0;
+	max_cell_x_ = max_cell_y_ = -1;
+}
+
+int WaypointIndex::getCell(double v) const
+{
+	return (int)floor(v / cell_size_);
+}
+
+void WaypointIndex::insert(const std::string& name, double x, double y)
+{
+	remove(name);
+
+	int cell_x = getCell(x);
+	int cell_y = getCell(y);
+	uint64_t key = getKey(cell_x, cell_y);
+	buckets_[key].push_back(Entry(name, x, y));
+	cell_of_waypoint_[name] = key;
+
+	if (max_cell_x_ < min_cell_x_) {
+		min_cell_x_ = max_cell_x_ = cell_x;
+		min_cell_y_ = max_cell_y_ = cell_y;
+	} else {
+		min_cell_x_ = std::min(min_cell_x_, cell_x);
+		min_cell_y_ = std::min(min_cell_y_, cell_y);
+		max_cell_x_ = std::max(max_cell_x_, cell_x);
+		max_cell_y_ = std::max(max_cell_y_, cell_y);
+	}
+}
+
+bool WaypointIndex::remove(const std::string& name)
+{
+	std::map<std::string, uint64_t>::iterator wi = cell_of_waypoint_.find(name);
+	if (wi == cell_of_waypoint_.end()) {
+		return false;
+	}
+
+	std::map<uint64_t, std::vector<Entry> >::iterator bi = buckets_.find(wi->second);
+	std::vector<Entry>& bucket = bi->second;
+	for (std::vector<Entry>::iterator ei = bucket.begin(); ei != bucket.end(); ++ei) {
+		if (ei->name_ == name) {
+			bucket.erase(ei);
+			break;
+		}
+	}
+	if (bucket.empty()) {
+		buckets_.erase(bi);
+	}
+	cell_of_waypoint_.erase(wi);
+	if (cell_of_waypoint_.empty()) {
+		clear();
+	}
+	return true;
+}
+
+void WaypointIndex::addCandidates(int cell_x, int cell_y, double x, double y, double radius, std::vector<Neighbour>& neighbours) const
+{
+	std::map<uint64_t, std::vector<Entry> >::const_iterator bi = buckets_.find(getKey(cell_x, cell_y));
+	if (bi == buckets_.end()) {
+		return;
+	}
+	for (std::vector<Entry>::const_iterator ci = bi->second.begin(); ci != bi->second.end(); ++ci) {
+		double distance = sqrt((ci->x_ - x) * (ci->x_ - x) + (ci->y_ - y) * (ci->y_ - y));
+		if (radius <= 0 || distance <= radius) {
+			neighbours.push_back(Neighbour(ci->name_, ci->x_, ci->y_, distance));
+		}
+	}
+}
+
+void WaypointIndex::findNearest(double x, double y, unsigned int k, double radius, std::vector<Neighbour>& neighbours) const
+{
+	neighbours.clear();
+	if (cell_of_waypoint_.empty()) {
+		return;
+	}
+
+	int cell_x = getCell(x);
+	int cell_y = getCell(y);
+
+	// The rings closer to the query point than the bounds of the waypoints are empty.
+	int first_ring = std::max(std::max(min_cell_x_ - cell_x, cell_x - max_cell_x_), std::max(min_cell_y_ - cell_y, cell_y - max_cell_y_));
+	int last_ring = std::max(std::max(max_cell_x_ - cell_x, cell_x - min_cell_x_), std::max(max_cell_y_ - cell_y, cell_y - min_cell_y_));
+	first_ring = std::max(first_ring, 0);
+
+	for (int ring = first_ring; ring <= last_ring; ++ring) {
+
+		// The query point lies inside its own cell, so every waypoint in this ring or beyond is at least this far away.
+		double min_distance = std::max(ring - 1, 0) * cell_size_;
+		if (radius > 0 && min_distance > radius) {
+			break;
+		}
+		if (k > 0 && neighbours.size() >= k) {
+			std::nth_element(neighbours.begin(), neighbours.begin() + k - 1, neighbours.end());
+			if (neighbours[k - 1].distance_ <= min_distance) {
+				break;
+			}
+		}
+
+		// Only the cells of the ring that lie within the bounds of the waypoints are looked up.
+		int min_y = std::max(cell_y - ring, min_cell_y_);
+		int max_y = std::min(cell_y + ring, max_cell_y_);
+		for (int row = min_y; row <= max_y; ++row) {
+			if (row == cell_y - ring || row == cell_y + ring) {
+				int min_x = std::max(cell_x - ring, min_cell_x_);
+				int max_x = std::min(cell_x + ring, max_cell_x_);
+				for (int column = min_x; column <= max_x; ++column) {
+					addCandidates(column, row, x, y, radius, neighbours);
+				}
+			} else {
+				if (cell_x - ring >= min_cell_x_) {
+					addCandidates(cell_x - ring, row, x, y, radius, neighbours);
+				}
+				if (ring > 0 && cell_x + ring <= max_cell_x_) {
+					addCandidates(cell_x + ring, row, x, y, radius, neighbours);
+				}
+			}
+		}
+	}
+
+	std::sort(neighbours.begin(), neighbours.end());
+	if (k > 0 && neighbours.size() > k) {
+		neighbours.resize(k, neighbours.front());
+	}
+}
+
+};
@@ -0,0 +1,575 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <malloc.h>
+#include <math.h>
+
+#include <ros/ros.h>
+#include <ros/console.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <geometry_msgs/Pose.h>
+#include <squirrel_planning_execution/ViewConeGenerator.h>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+/**
+ * Offline benchmark of the ViewConeGenerator. Occupancy grids are loaded from map_server YAML files or
+ * generated as synthetic rooms, view cones are created for every combination of the given parameters and the
+ * timings, coverage and memory use are written as CSV or JSON. No ROS master is needed.
+ */
+
+/**
+ * An occupancy grid to run the benchmark on.
+ */
+struct BenchmarkMap
+{
+	std::string name_;
+	nav_msgs::OccupancyGrid::Ptr grid_;
+	double load_time_;
+};
+
+/**
+ * One run of createViewCones.
+ */
+struct BenchmarkResult
+{
+	std::string map_;
+	unsigned int width_, height_;
+	float resolution_;
+	unsigned int sample_size_;
+	float fov_, view_distance_, safe_distance_;
+	unsigned int repetition_;
+	double load_time_, distance_field_time_;
+	KCL_rosplan::ViewConeGenerator::ViewConeProgress progress_;
+	KCL_rosplan::ViewConeGenerator::PhaseTimings timings_;
+	KCL_rosplan::ViewConeGenerator::SamplingStatistics statistics_;
+	long rss_before_kb_;       // The resident set size at the start of the run.
+	long peak_rss_kb_;         // The peak resident set size during the run, -1 if it cannot be measured.
+	long process_peak_rss_kb_; // The peak resident set size since the benchmark started.
+};
+
+std::string trim(const std::string& s)
+{
+	size_t begin = s.find_first_not_of(" \t\r\n\"'");
+	if (begin == std::string::npos) {
+		return "";
+	}
+	size_t end = s.find_last_not_of(" \t\r\n\"'");
+	return s.substr(begin, end - begin + 1);
+}
+
+/**
+ * Parse a comma separated list of numbers.
+ */
+std::vector<float> parseList(const std::string& s)
+{
+	std::vector<float> values;
+	std::stringstream ss(s);
+	std::string value;
+	while (std::getline(ss, value, ',')) {
+		if (!trim(value).empty()) {
+			values.push_back(::atof(value.c_str()));
+		}
+	}
+	return values;
+}
+
+/**
+ * Read the next token of a PGM header, skipping comments.
+ */
+bool readPGMToken(std::istream& in, std::string& token)
+{
+	token.clear();
+	char c;
+	while (in.get(c)) {
+		if (c == '#') {
+			std::string comment;
+			std::getline(in, comment);
+		} else if (isspace(c)) {
+			if (!token.empty()) {
+				return true;
+			}
+		} else {
+			token += c;
+		}
+	}
+	return !token.empty();
+}
+
+/**
+ * Load a map in the format of the map_server: a YAML file that refers to a PGM image. Only the trinary mode is
+ * supported, which is the default of the map_server.
+ * @param yaml_file The YAML file.
+ * @param map The loaded map.
+ * @return True if the map was loaded, false otherwise.
+ */
+bool loadMap(const std::string& yaml_file, BenchmarkMap& map)
+{
+	std::ifstream yaml(yaml_file.c_str());
+	if (!yaml.good()) {
+		ROS_ERROR("(ViewConeBenchmark) Could not open %s.", yaml_file.c_str());
+		return false;
+	}
+
+	std::string image;
+	double resolution = 0.05;
+	double origin[3] = {0, 0, 0};
+	bool negate = false;
+	double occupied_thresh = 0.65;
+	double free_thresh = 0.196;
+
+	std::string line;
+	while (std::getline(yaml, line)) {
+		size_t colon = line.find(':');
+		if (colon == std::string::npos || trim(line)[0] == '#') {
+			continue;
+		}
+		std::string key = trim(line.substr(0, colon));
+		std::string value = trim(line.substr(colon + 1));
+
+		if (key == "image") {
+			image = value;
+		} else if (key == "resolution") {
+			resolution = ::atof(value.c_str());
+		} else if (key == "negate") {
+			negate = ::atoi(value.c_str()) != 0 || value == "true";
+		} else if (key == "occupied_thresh") {
+			occupied_thresh = ::atof(value.c_str());
+		} else if (key == "free_thresh") {
+			free_thresh = ::atof(value.c_str());
+		} else if (key == "origin") {
+			std::vector<float> values = parseList(value.substr(value.find('[') + 1, value.find(']') - value.find('[') - 1));
+			for (unsigned int i = 0; i < values.size() && i < 3; ++i) {
+				origin[i] = values[i];
+			}
+		} else if (key == "mode" && value != "trinary") {
+			ROS_WARN("(ViewConeBenchmark) The %s mode of %s is not supported, the map is loaded in the trinary mode.", value.c_str(), yaml_file.c_str());
+		}
+	}
+
+	// The image is relative to the YAML file.
+	if (!image.empty() && image[0] != '/' && yaml_file.find('/') != std::string::npos) {
+		image = yaml_file.substr(0, yaml_file.rfind('/') + 1) + image;
+	}
+
+	std::ifstream pgm(image.c_str(), std::ios::binary);
+	std::string magic, width_token, height_token, max_value_token;
+	if (!pgm.good() || !readPGMToken(pgm, magic) || !readPGMToken(pgm, width_token) || !readPGMToken(pgm, height_token) || !readPGMToken(pgm, max_value_token)) {
+		ROS_ERROR("(ViewConeBenchmark) Could not read the image %s of %s.", image.c_str(), yaml_file.c_str());
+		return false;
+	}
+
+	int width = ::atoi(width_token.c_str());
+	int height = ::atoi(height_token.c_str());
+	int max_value = ::atoi(max_value_token.c_str());
+	if ((magic != "P5" && magic != "P2") || width <= 0 || height <= 0 || max_value <= 0 || max_value > 255) {
+		ROS_ERROR("(ViewConeBenchmark) %s is not an 8-bit PGM image.", image.c_str());
+		return false;
+	}
+
+	nav_msgs::OccupancyGrid::Ptr grid(new nav_msgs::OccupancyGrid());
+	grid->header.frame_id = "map";
+	grid->info.resolution = resolution;
+	grid->info.width = width;
+	grid->info.height = height;
+	grid->info.origin.position.x = origin[0];
+	grid->info.origin.position.y = origin[1];
+	grid->info.origin.orientation.z = sin(origin[2] / 2.0);
+	grid->info.origin.orientation.w = cos(origin[2] / 2.0);
+	grid->data.resize(width * height);
+
+	for (int row = 0; row < height; ++row) {
+		for (int x = 0; x < width; ++x) {
+			int pixel;
+			if (magic == "P5") {
+				char c;
+				if (!pgm.get(c)) {
+					ROS_ERROR("(ViewConeBenchmark) The image %s is truncated.", image.c_str());
+					return false;
+				}
+				pixel = (unsigned char)c;
+			} else {
+				std::string token;
+				if (!readPGMToken(pgm, token)) {
+					ROS_ERROR("(ViewConeBenchmark) The image %s is truncated.", image.c_str());
+					return false;
+				}
+				pixel = ::atoi(token.c_str());
+			}
+
+			// Same conversion as the map_server, the first row of the image is the top of the map.
+			double occupancy = negate ? (double)pixel / max_value : (double)(max_value - pixel) / max_value;
+			int8_t value = -1;
+			if (occupancy > occupied_thresh) {
+				value = 100;
+			} else if (occupancy < free_thresh) {
+				value = 0;
+			}
+			grid->data[x + (height - row - 1) * width] = value;
+		}
+	}
+
+	map.name_ = yaml_file;
+	map.grid_ = grid;
+	return true;
+}
+
+/**
+ * Fill a rectangle of cells with a value, clipped to the grid.
+ */
+void fillRectangle(nav_msgs::OccupancyGrid& grid, int min_x, int min_y, int max_x, int max_y, int8_t value)
+{
+	for (int y = std::max(0, min_y); y <= std::min((int)grid.info.height - 1, max_y); ++y) {
+		for (int x = std::max(0, min_x); x <= std::min((int)grid.info.width - 1, max_x); ++x) {
+			grid.data[x + y * grid.info.width] = value;
+		}
+	}
+}
+
+/**
+ * Generate a square map of rooms of about 5x5 metres. The walls between the rooms have a door at a random
+ * position and every room contains a few pieces of furniture.
+ * @param size The length of the sides of the map in metres.
+ * @param resolution The size of a cell in metres.
+ * @param seed The seed of the random generator, the same seed gives the same map.
+ * @param map The generated map.
+ */
+void generateRooms(float size, float resolution, unsigned int seed, BenchmarkMap& map)
+{
+	boost::random::mt19937 generator(seed);
+
+	int nr_cells = (int)(size / resolution);
+	int wall = std::max(1, (int)(0.1f / resolution));
+	int door = (int)(1.0f / resolution);
+	int nr_rooms = std::max(1, (int)(size / 5.0f + 0.5f));
+	int room = nr_cells / nr_rooms;
+
+	nav_msgs::OccupancyGrid::Ptr grid(new nav_msgs::OccupancyGrid());
+	grid->header.frame_id = "map";
+	grid->info.resolution = resolution;
+	grid->info.width = nr_cells;
+	grid->info.height = nr_cells;
+	grid->info.origin.orientation.w = 1;
+	grid->data.resize(nr_cells * nr_cells, 0);
+
+	// The outer walls.
+	fillRectangle(*grid, 0, 0, nr_cells - 1, wall - 1, 100);
+	fillRectangle(*grid, 0, nr_cells - wall, nr_cells - 1, nr_cells - 1, 100);
+	fillRectangle(*grid, 0, 0, wall - 1, nr_cells - 1, 100);
+	fillRectangle(*grid, nr_cells - wall, 0, nr_cells - 1, nr_cells - 1, 100);
+
+	for (int i = 0; i < nr_rooms; ++i) {
+		for (int j = 0; j < nr_rooms; ++j) {
+			int min_x = i * room;
+			int min_y = j * room;
+
+			// The walls to the left and bottom of this room, each with a door.
+			boost::random::uniform_int_distribution<> door_position(wall + 1, std::max(wall + 1, room - door - wall - 1));
+			if (i > 0) {
+				fillRectangle(*grid, min_x, min_y, min_x + wall - 1, min_y + room - 1, 100);
+				int d = min_y + door_position(generator);
+				fillRectangle(*grid, min_x, d, min_x + wall - 1, d + door - 1, 0);
+			}
+			if (j > 0) {
+				fillRectangle(*grid, min_x, min_y, min_x + room - 1, min_y + wall - 1, 100);
+				int d = min_x + door_position(generator);
+				fillRectangle(*grid, d, min_y, d + door - 1, min_y + wall - 1, 0);
+			}
+
+			// Furniture of 0.4 to 1 metres, kept away from the walls so the doors stay reachable.
+			boost::random::uniform_int_distribution<> nr_furniture(1, 3);
+			boost::random::uniform_int_distribution<> furniture_size((int)(0.4f / resolution), (int)(1.0f / resolution));
+			for (int k = nr_furniture(generator); k > 0; --k) {
+				int width = furniture_size(generator);
+				int height = furniture_size(generator);
+				boost::random::uniform_int_distribution<> position(door + wall, std::max(door + wall, room - door - wall - std::max(width, height)));
+				int x = min_x + position(generator);
+				int y = min_y + position(generator);
+				fillRectangle(*grid, x, y, x + width - 1, y + height - 1, 100);
+			}
+		}
+	}
+
+	std::stringstream ss;
+	ss << "synthetic_" << size << "m";
+	map.name_ = ss.str();
+	map.grid_ = grid;
+}
+
+/**
+ * Read a memory statistic of this process from /proc/self/status.
+ * @param key The name of the statistic, e.g. VmRSS.
+ * @return The value in kilobytes, -1 if it is not available.
+ */
+long readMemoryStatus(const std::string& key)
+{
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, key.size() + 1, key + ":") == 0) {
+			return ::atol(line.c_str() + key.size() + 1);
+		}
+	}
+	return -1;
+}
+
+/**
+ * Reset the peak resident set size of this process (VmHWM) to its current resident set size, so the peak of a
+ * single run can be read afterwards. The memory freed by earlier runs is returned to the system first, otherwise
+ * a run that fits in it would not raise the resident set size at all. Supported by Linux 4.0 and later.
+ * @return True if the peak was reset, false otherwise.
+ */
+bool resetPeakMemory()
+{
+	malloc_trim(0);
+	std::ofstream clear_refs("/proc/self/clear_refs");
+	clear_refs << "5";
+	clear_refs.close();
+	return clear_refs.good();
+}
+
+void writeCSV(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+	out << "map,width,height,resolution,sample_size,fov,view_distance,safe_distance,repetition,view_cones,covered_cells,free_cells,coverage,deadline_reached,load_time,distance_field_time,initialisation_time,stencils_time,admissible_cells_time,selection_time,visualisation_time,total_time,admissible_cells,samples,accepted_samples,rss_before_kb,peak_rss_kb,process_peak_rss_kb" << std::endl;
+	for (std::vector<BenchmarkResult>::const_iterator ci = results.begin(); ci != results.end(); ++ci) {
+		const BenchmarkResult& r = *ci;
+		out << r.map_ << "," << r.width_ << "," << r.height_ << "," << r.resolution_ << ","
+		    << r.sample_size_ << "," << r.fov_ << "," << r.view_distance_ << "," << r.safe_distance_ << "," << r.repetition_ << ","
+		    << r.progress_.nr_view_cones_ << "," << r.progress_.nr_covered_cells_ << "," << r.progress_.nr_free_cells_ << "," << r.progress_.getCoverage() << "," << r.progress_.deadline_reached_ << ","
+		    << r.load_time_ << "," << r.distance_field_time_ << "," << r.timings_.initialisation_.toSec() << "," << r.timings_.stencils_.toSec() << ","
+		    << r.timings_.admissible_cells_.toSec() << "," << r.timings_.selection_.toSec() << "," << r.timings_.visualisation_.toSec() << "," << r.timings_.total_.toSec() << ","
+		    << r.statistics_.nr_admissible_cells_ << "," << r.statistics_.nr_samples_ << "," << r.statistics_.nr_accepted_samples_ << "," << r.rss_before_kb_ << "," << r.peak_rss_kb_ << "," << r.process_peak_rss_kb_ << std::endl;
+	}
+}
+
+void writeJSON(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+	out << "[" << std::endl;
+	for (std::vector<BenchmarkResult>::const_iterator ci = results.begin(); ci != results.end(); ++ci) {
+		const BenchmarkResult& r = *ci;
+		out << "  {\"map\": \"" << r.map_ << "\", \"width\": " << r.width_ << ", \"height\": " << r.height_ << ", \"resolution\": " << r.resolution_
+		    << ", \"sample_size\": " << r.sample_size_ << ", \"fov\": " << r.fov_ << ", \"view_distance\": " << r.view_distance_ << ", \"safe_distance\": " << r.safe_distance_ << ", \"repetition\": " << r.repetition_
+		    << ", \"view_cones\": " << r.progress_.nr_view_cones_ << ", \"covered_cells\": " << r.progress_.nr_covered_cells_ << ", \"free_cells\": " << r.progress_.nr_free_cells_ << ", \"coverage\": " << r.progress_.getCoverage() << ", \"deadline_reached\": " << (r.progress_.deadline_reached_ ? "true" : "false")
+		    << ", \"timings\": {\"load\": " << r.load_time_ << ", \"distance_field\": " << r.distance_field_time_ << ", \"initialisation\": " << r.timings_.initialisation_.toSec() << ", \"stencils\": " << r.timings_.stencils_.toSec()
+		    << ", \"admissible_cells\": " << r.timings_.admissible_cells_.toSec() << ", \"selection\": " << r.timings_.selection_.toSec() << ", \"visualisation\": " << r.timings_.visualisation_.toSec() << ", \"total\": " << r.timings_.total_.toSec() << "}"
+		    << ", \"admissible_cells\": " << r.statistics_.nr_admissible_cells_ << ", \"samples\": " << r.statistics_.nr_samples_ << ", \"accepted_samples\": " << r.statistics_.nr_accepted_samples_ << ", \"rss_before_kb\": " << r.rss_before_kb_ << ", \"peak_rss_kb\": " << r.peak_rss_kb_ << ", \"process_peak_rss_kb\": " << r.process_peak_rss_kb_ << "}"
+		    << (ci + 1 == results.end() ? "" : ",") << std::endl;
+	}
+	out << "]" << std::endl;
+}
+
+void printUsage()
+{
+	std::cout << "Usage: ./viewConeBenchmark [options]" << std::endl
+	          << "  --map {file.yaml}            A map in the map_server format, can be given multiple times." << std::endl
+	          << "  --synthetic {sizes}          Sizes in metres of synthetic room maps (default 10,20,40 if no map is given)." << std::endl
+	          << "  --resolution {metres}        Resolution of the synthetic maps (default 0.05)." << std::endl
+	          << "  --sample_sizes {list}        Default 100,1000." << std::endl
+	          << "  --fovs {list}                Fields of view in degrees (default 70)." << std::endl
+	          << "  --view_distances {list}      Default 2." << std::endl
+	          << "  --safe_distances {list}      Default 0.35." << std::endl
+	          << "  --view_cones {number}        Maximum number of view cones (default 20)." << std::endl
+	          << "  --occupancy_threshold {0-100} Default 50." << std::endl
+	          << "  --time_budget {seconds}      Default 0 (no limit)." << std::endl
+	          << "  --repetitions {number}       Default 1, every repetition uses a different seed." << std::endl
+	          << "  --seed {number}              Default 0." << std::endl
+	          << "  --threads {number}           Default 1, 0 uses all cores." << std::endl
+	          << "  --strategy {random_restart|lazy_greedy}" << std::endl
+	          << "  --sampling {rejection|uniform|stratified}" << std::endl
+	          << "  --yaw_bins {number}          Default 0 (continuous yaw)." << std::endl
+	          << "  --try_all_yaw_bins" << std::endl
+	          << "  --incremental                Reuse the view cones of the previous run on the same map." << std::endl
+	          << "  --format {csv|json}          Default csv." << std::endl
+	          << "  --output {file}              Default standard output." << std::endl
+	          << "  --verbose                    Show the log of the view cone generator." << std::endl;
+}
+
+int main(int argc, char **argv) {
+
+	// Only used for logging and the clock, no connection to a ROS master is made.
+	ros::init(argc, argv, "view_cone_benchmark", ros::init_options::AnonymousName | ros::init_options::NoRosout);
+
+	std::vector<std::string> map_files;
+	std::vector<float> synthetic_sizes;
+	float resolution = 0.05f;
+	std::vector<float> sample_sizes = parseList("100,1000");
+	std::vector<float> fovs = parseList("70");
+	std::vector<float> view_distances = parseList("2");
+	std::vector<float> safe_distances = parseList("0.35");
+	unsigned int nr_view_cones = 20;
+	int occupancy_threshold = 50;
+	double time_budget = 0;
+	unsigned int nr_repetitions = 1;
+	unsigned int seed = 0;
+	unsigned int nr_threads = 1;
+	std::string strategy("random_restart");
+	std::string sampling("stratified");
+	unsigned int yaw_bins = 0;
+	bool try_all_yaw_bins = false;
+	bool incremental = false;
+	std::string format("csv");
+	std::string output_file;
+	bool verbose = false;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string option(argv[i]);
+		if (option == "--help" || option == "-h") {
+			printUsage();
+			return 0;
+		} else if (option == "--try_all_yaw_bins") {
+			try_all_yaw_bins = true;
+			continue;
+		} else if (option == "--incremental") {
+			incremental = true;
+			continue;
+		} else if (option == "--verbose") {
+			verbose = true;
+			continue;
+		} else if (i + 1 == argc) {
+			std::cerr << "Missing value for " << option << "." << std::endl;
+			printUsage();
+			return 1;
+		}
+
+		std::string value(argv[++i]);
+		if (option == "--map") map_files.push_back(value);
+		else if (option == "--synthetic") synthetic_sizes = parseList(value);
+		else if (option == "--resolution") resolution = ::atof(value.c_str());
+		else if (option == "--sample_sizes") sample_sizes = parseList(value);
+		else if (option == "--fovs") fovs = parseList(value);
+		else if (option == "--view_distances") view_distances = parseList(value);
+		else if (option == "--safe_distances") safe_distances = parseList(value);
+		else if (option == "--view_cones") nr_view_cones = ::atoi(value.c_str());
+		else if (option == "--occupancy_threshold") occupancy_threshold = ::atoi(value.c_str());
+		else if (option == "--time_budget") time_budget = ::atof(value.c_str());
+		else if (option == "--repetitions") nr_repetitions = ::atoi(value.c_str());
+		else if (option == "--seed") seed = ::atoi(value.c_str());
+		else if (option == "--threads") nr_threads = ::atoi(value.c_str());
+		else if (option == "--strategy") strategy = value;
+		else if (option == "--sampling") sampling = value;
+		else if (option == "--yaw_bins") yaw_bins = ::atoi(value.c_str());
+		else if (option == "--format") format = value;
+		else if (option == "--output") output_file = value;
+		else {
+			std::cerr << "Unknown option " << option << "." << std::endl;
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (!verbose && ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Warn)) {
+		ros::console::notifyLoggerLevelsChanged();
+	}
+
+	if (map_files.empty() && synthetic_sizes.empty()) {
+		synthetic_sizes = parseList("10,20,40");
+	}
+
+	std::vector<BenchmarkMap> maps;
+	for (std::vector<std::string>::const_iterator ci = map_files.begin(); ci != map_files.end(); ++ci) {
+		ros::WallTime start = ros::WallTime::now();
+		BenchmarkMap map;
+		if (!loadMap(*ci, map)) {
+			return 1;
+		}
+		map.load_time_ = (ros::WallTime::now() - start).toSec();
+		maps.push_back(map);
+	}
+	for (std::vector<float>::const_iterator ci = synthetic_sizes.begin(); ci != synthetic_sizes.end(); ++ci) {
+		ros::WallTime start = ros::WallTime::now();
+		BenchmarkMap map;
+		generateRooms(*ci, resolution, seed, map);
+		map.load_time_ = (ros::WallTime::now() - start).toSec();
+		maps.push_back(map);
+	}
+
+	// Resetting the peak of every run also resets the peak of the process, so it is tracked here.
+	std::vector<BenchmarkResult> results;
+	long process_peak_rss_kb = -1;
+	for (std::vector<BenchmarkMap>::const_iterator map_ci = maps.begin(); map_ci != maps.end(); ++map_ci) {
+		const BenchmarkMap& map = *map_ci;
+
+		KCL_rosplan::ViewConeGenerator vg;
+		vg.setNumberOfThreads(nr_threads);
+		vg.setSelectionStrategy(strategy == "lazy_greedy" ? KCL_rosplan::ViewConeGenerator::LAZY_GREEDY : KCL_rosplan::ViewConeGenerator::RANDOM_RESTART);
+		if (sampling == "rejection") {
+			vg.setSamplingStrategy(KCL_rosplan::ViewConeGenerator::REJECTION_SAMPLING);
+		} else if (sampling == "uniform") {
+			vg.setSamplingStrategy(KCL_rosplan::ViewConeGenerator::ADMISSIBLE_UNIFORM);
+		} else {
+			vg.setSamplingStrategy(KCL_rosplan::ViewConeGenerator::ADMISSIBLE_STRATIFIED);
+		}
+		vg.setYawBins(yaw_bins, try_all_yaw_bins);
+		vg.setIncrementalReplanning(incremental);
+
+		// Storing the grid computes its distance transform.
+		ros::WallTime start = ros::WallTime::now();
+		vg.storeNavigationGrid(map.grid_);
+		double distance_field_time = (ros::WallTime::now() - start).toSec();
+
+		std::cerr << "Benchmarking " << map.name_ << " (" << map.grid_->info.width << "x" << map.grid_->info.height << ")..." << std::endl;
+
+		for (std::vector<float>::const_iterator sample_size = sample_sizes.begin(); sample_size != sample_sizes.end(); ++sample_size) {
+			for (std::vector<float>::const_iterator fov = fovs.begin(); fov != fovs.end(); ++fov) {
+				for (std::vector<float>::const_iterator view_distance = view_distances.begin(); view_distance != view_distances.end(); ++view_distance) {
+					for (std::vector<float>::const_iterator safe_distance = safe_distances.begin(); safe_distance != safe_distances.end(); ++safe_distance) {
+						for (unsigned int repetition = 0; repetition < nr_repetitions; ++repetition) {
+							vg.setSeed(seed + repetition);
+
+							// An empty bounding box does not restrict the view cones.
+							std::vector<tf::Vector3> bounding_box;
+							std::vector<geometry_msgs::Pose> poses;
+
+							BenchmarkResult result;
+							process_peak_rss_kb = std::max(process_peak_rss_kb, readMemoryStatus("VmHWM"));
+							bool peak_is_reset = resetPeakMemory();
+							result.rss_before_kb_ = readMemoryStatus("VmRSS");
+							result.progress_ = vg.createViewCones(poses, bounding_box, nr_view_cones, occupancy_threshold, *fov * M_PI / 180.0f, *view_distance, (unsigned int)*sample_size, *safe_distance, ros::WallDuration(time_budget));
+							result.map_ = map.name_;
+							result.width_ = map.grid_->info.width;
+							result.height_ = map.grid_->info.height;
+							result.resolution_ = map.grid_->info.resolution;
+							result.sample_size_ = (unsigned int)*sample_size;
+							result.fov_ = *fov;
+							result.view_distance_ = *view_distance;
+							result.safe_distance_ = *safe_distance;
+							result.repetition_ = repetition;
+							result.load_time_ = map.load_time_;
+							result.distance_field_time_ = distance_field_time;
+							result.timings_ = vg.getPhaseTimings();
+							result.statistics_ = vg.getSamplingStatistics();
+							result.peak_rss_kb_ = peak_is_reset ? readMemoryStatus("VmHWM") : -1;
+							process_peak_rss_kb = std::max(process_peak_rss_kb, readMemoryStatus("VmHWM"));
+							result.process_peak_rss_kb_ = process_peak_rss_kb;
+							results.push_back(result);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::ofstream file;
+	if (!output_file.empty()) {
+		file.open(output_file.c_str());
+		if (!file.good()) {
+			std::cerr << "Could not open " << output_file << "." << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = output_file.empty() ? std::cout : file;
+
+	if (format == "json") {
+		writeJSON(out, results);
+	} else {
+		writeCSV(out, results);
+	}
+	return 0;
+}
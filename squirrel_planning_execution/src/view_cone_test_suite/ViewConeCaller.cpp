@@ -29,6 +29,47 @@ int main(int argc, char **argv) {
 
 	// create PDDL action subscriber
 	KCL_rosplan::ViewConeGenerator vg(nh, "/map");
+	
+	ros::NodeHandle private_nh("~");
+	int nr_threads = 0;
+	private_nh.param("threads", nr_threads, nr_threads);
+	vg.setNumberOfThreads(nr_threads);
+	
+	int seed = 0;
+	if (private_nh.getParam("seed", seed)) {
+		vg.setSeed(seed);
+	}
+	
+	std::string strategy("random_restart");
+	private_nh.param("strategy", strategy, strategy);
+	vg.setSelectionStrategy(strategy == "lazy_greedy" ? KCL_rosplan::ViewConeGenerator::LAZY_GREEDY : KCL_rosplan::ViewConeGenerator::RANDOM_RESTART);
+	
+	int pool_size = 0;
+	private_nh.param("pool_size", pool_size, pool_size);
+	vg.setCandidatePoolSize(pool_size);
+	
+	std::string sampling("stratified");
+	private_nh.param("sampling", sampling, sampling);
+	if (sampling == "rejection") {
+		vg.setSamplingStrategy(KCL_rosplan::ViewConeGenerator::REJECTION_SAMPLING);
+	} else if (sampling == "uniform") {
+		vg.setSamplingStrategy(KCL_rosplan::ViewConeGenerator::ADMISSIBLE_UNIFORM);
+	} else {
+		vg.setSamplingStrategy(KCL_rosplan::ViewConeGenerator::ADMISSIBLE_STRATIFIED);
+	}
+	
+	int yaw_bins = 0;
+	bool try_all_yaw_bins = false;
+	private_nh.param("yaw_bins", yaw_bins, yaw_bins);
+	private_nh.param("try_all_yaw_bins", try_all_yaw_bins, try_all_yaw_bins);
+	vg.setYawBins(yaw_bins, try_all_yaw_bins);
+	
+	double time_budget = 0;
+	private_nh.param("time_budget", time_budget, time_budget);
+	
+	bool incremental = true;
+	private_nh.param("incremental", incremental, incremental);
+	vg.setIncrementalReplanning(incremental);
 	ROS_INFO("Waiting for the occupancy grid to be published...");
 	while (!vg.hasReceivedOccupancyGrid() && ros::ok()) {
 		ros::spinOnce();
@@ -44,9 +85,13 @@ int main(int argc, char **argv) {
 	unsigned int sample_size = 1000;
 	float safe_distance = 0.5f;
 	*/
-	vg.createViewCones(poses, bounding_box, nr_view_cones, occupancy_threshold, fov, view_distance, sample_size, safe_distance);
+	KCL_rosplan::ViewConeGenerator::ViewConeProgress progress = vg.createViewCones(poses, bounding_box, nr_view_cones, occupancy_threshold, fov, view_distance, sample_size, safe_distance, ros::WallDuration(time_budget));
 
 	ROS_INFO("Got the view cones, there are %d!", poses.size());
+	ROS_INFO("Coverage: %u of the %u free cells (%.1f%%) in %f seconds%s.", progress.nr_covered_cells_, progress.nr_free_cells_, 100.0f * progress.getCoverage(), progress.elapsed_time_.toSec(), progress.deadline_reached_ ? ", the time budget ran out" : "");
+	
+	const KCL_rosplan::ViewConeGenerator::SamplingStatistics& statistics = vg.getSamplingStatistics();
+	ROS_INFO("Sampling: %u admissible cells, %u of the %u samples were accepted.", statistics.nr_admissible_cells_, statistics.nr_accepted_samples_, statistics.nr_samples_);
 
 	// Create a broadcast of TF.
 	tf::TransformBroadcaster br;
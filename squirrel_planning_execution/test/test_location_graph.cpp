@@ -0,0 +1,160 @@
+#include <vector>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <squirrel_planning_execution/LocationGraph.h>
+
+/**
+ * Checks how the LocationGraph connects the locations of a problem along a roadmap like the one of the
+ * RPSquirrelRoadmap: the manipulation waypoints of the objects, sampled waypoints in between and the waypoints
+ * of a problem that are attached to it.
+ */
+
+namespace {
+
+using KCL_rosplan::LocationGraph;
+
+typedef std::vector<std::pair<std::string, std::string> > Connections;
+
+void connect(Connections& connections, const std::string& from, const std::string& to)
+{
+	connections.push_back(std::make_pair(from, to));
+	connections.push_back(std::make_pair(to, from));
+}
+
+class LocationGraphTest : public ::testing::Test
+{
+protected:
+	/**
+	 * The robot waypoint and the waypoints of two objects, joined by sampled waypoints:
+	 *
+	 *   kenny_waypoint - wp_prm_0 - wp_prm_1 - wp_ball_0 - wp_prm_2 - wp_car_0
+	 *                                  |
+	 *                               wp_prm_3 - wp_prm_4
+	 *
+	 * and a part of the roadmap that cannot be reached: wp_prm_5 - wp_cup_0.
+	 */
+	virtual void SetUp()
+	{
+		connect(roadmap_, "kenny_waypoint", "wp_prm_0");
+		connect(roadmap_, "wp_prm_0", "wp_prm_1");
+		connect(roadmap_, "wp_prm_1", "wp_ball_0");
+		connect(roadmap_, "wp_ball_0", "wp_prm_2");
+		connect(roadmap_, "wp_prm_2", "wp_car_0");
+		connect(roadmap_, "wp_prm_1", "wp_prm_3");
+		connect(roadmap_, "wp_prm_3", "wp_prm_4");
+		connect(roadmap_, "wp_prm_5", "wp_cup_0");
+	}
+
+	unsigned int getNrEdges(const LocationGraph& graph) const
+	{
+		unsigned int nr_edges = 0;
+		for (unsigned int from = 0; from < graph.getNrLocations(); ++from) {
+			nr_edges += graph.end(from) - graph.begin(from);
+		}
+		return nr_edges;
+	}
+
+	Connections roadmap_;
+};
+
+TEST_F(LocationGraphTest, ConnectsLocationsThroughSampledWaypoints)
+{
+	std::vector<std::string> names;
+	names.push_back("kenny_waypoint");
+	names.push_back("wp_ball_0");
+	names.push_back("wp_car_0");
+
+	LocationGraph graph;
+	graph.setEdges(names, roadmap_);
+	EXPECT_FALSE(graph.isComplete());
+	EXPECT_TRUE(graph.isConnected(0, 1));
+	EXPECT_TRUE(graph.isConnected(1, 0));
+	EXPECT_TRUE(graph.isConnected(1, 2));
+	EXPECT_TRUE(graph.isConnected(2, 1));
+
+	// The only path from the robot to the car passes the ball.
+	EXPECT_FALSE(graph.isConnected(0, 2));
+	EXPECT_FALSE(graph.isConnected(2, 0));
+	EXPECT_EQ(4u, getNrEdges(graph));
+}
+
+TEST_F(LocationGraphTest, ConnectsLocationsThatAreNotNeighbours)
+{
+	// Without the ball the robot reaches the car through the waypoints of the ball.
+	std::vector<std::string> names;
+	names.push_back("kenny_waypoint");
+	names.push_back("wp_car_0");
+
+	LocationGraph graph;
+	graph.setEdges(names, roadmap_);
+	EXPECT_TRUE(graph.isConnected(0, 1));
+	EXPECT_TRUE(graph.isConnected(1, 0));
+	EXPECT_EQ(2u, getNrEdges(graph));
+}
+
+TEST_F(LocationGraphTest, DoesNotConnectOtherPartsOfTheRoadmap)
+{
+	std::vector<std::string> names;
+	names.push_back("kenny_waypoint");
+	names.push_back("wp_cup_0");
+
+	LocationGraph graph;
+	graph.setEdges(names, roadmap_);
+	EXPECT_FALSE(graph.isConnected(0, 1));
+	EXPECT_FALSE(graph.isConnected(1, 0));
+	EXPECT_EQ(0u, getNrEdges(graph));
+}
+
+TEST_F(LocationGraphTest, ConnectsAttachedWaypointsOnlyToTheirRoadmapWaypoint)
+{
+	// The near waypoint of the ball and an observation waypoint attached to the sampled waypoint closest to it.
+	connect(roadmap_, "near_wp_ball_0_0", "wp_ball_0");
+	connect(roadmap_, "ball_observation_wp0", "wp_prm_4");
+
+	std::vector<std::string> names;
+	names.push_back("kenny_waypoint");
+	names.push_back("wp_ball_0");
+	names.push_back("near_wp_ball_0_0");
+	names.push_back("ball_observation_wp0");
+	names.push_back("nowhere");
+
+	LocationGraph graph;
+	graph.setEdges(names, roadmap_);
+	EXPECT_TRUE(graph.isConnected(2, 1));
+	EXPECT_TRUE(graph.isConnected(1, 2));
+	EXPECT_FALSE(graph.isConnected(2, 0));
+	EXPECT_FALSE(graph.isConnected(2, 3));
+	EXPECT_TRUE(graph.isConnected(3, 0));
+	EXPECT_TRUE(graph.isConnected(3, 1));
+
+	// A location that is on none of the edges is not connected.
+	EXPECT_EQ(graph.begin(4), graph.end(4));
+	for (unsigned int from = 0; from < 4; ++from) {
+		EXPECT_FALSE(graph.isConnected(from, 4));
+	}
+}
+
+TEST_F(LocationGraphTest, IsCompleteWithoutRoadmap)
+{
+	std::vector<std::string> names;
+	names.push_back("kenny_waypoint");
+	names.push_back("wp_ball_0");
+	names.push_back("nowhere");
+
+	LocationGraph graph;
+	graph.setEdges(names, Connections());
+	EXPECT_TRUE(graph.isComplete());
+	EXPECT_TRUE(graph.isConnected(0, 2));
+	EXPECT_TRUE(graph.isConnected(2, 1));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
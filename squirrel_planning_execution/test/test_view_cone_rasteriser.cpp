@@ -0,0 +1,263 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <cstdlib>
+#include <math.h>
+
+#include <gtest/gtest.h>
+
+#include <nav_msgs/OccupancyGrid.h>
+#include <squirrel_planning_execution/ViewConeGenerator.h>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+/**
+ * Checks the cells the rasteriser of the ViewConeGenerator finds inside a view cone against the flood fill it
+ * replaced. The flood fill only reaches cells through other cells inside the cone, so it misses cells behind a
+ * corner that is sharper than 45 degrees, and it never entered the last row and column of the grid. The
+ * rasteriser therefore finds more cells, but it must find every cell the flood fill finds.
+ */
+
+namespace {
+
+typedef occupancy_grid_utils::Cell Cell;
+
+/**
+ * Load a map in the format of the map_server whose image is an ASCII (P2) PGM file. Only the trinary mode with
+ * the default thresholds is supported.
+ * @param yaml_file The YAML file.
+ * @param grid The loaded occupancy grid.
+ * @return True if the map was loaded, false otherwise.
+ */
+bool loadMap(const std::string& yaml_file, nav_msgs::OccupancyGrid& grid)
+{
+	std::ifstream yaml(yaml_file.c_str());
+	std::string image;
+	double resolution = 0.05;
+	std::string line;
+	while (std::getline(yaml, line)) {
+		std::stringstream ss(line);
+		std::string key, value;
+		ss >> key >> value;
+		if (key == "image:") {
+			image = yaml_file.substr(0, yaml_file.rfind('/') + 1) + value;
+		} else if (key == "resolution:") {
+			resolution = ::atof(value.c_str());
+		}
+	}
+
+	std::ifstream pgm(image.c_str());
+	std::string magic, comment;
+	int width = 0, height = 0, max_value = 0;
+	pgm >> magic;
+	pgm >> std::ws;
+	while (pgm.peek() == '#') {
+		std::getline(pgm, comment);
+	}
+	pgm >> width >> height >> max_value;
+	if (magic != "P2" || width <= 0 || height <= 0 || max_value <= 0) {
+		return false;
+	}
+
+	grid.info.resolution = resolution;
+	grid.info.width = width;
+	grid.info.height = height;
+	grid.info.origin.orientation.w = 1;
+	grid.data.resize(width * height);
+	for (int row = 0; row < height; ++row) {
+		for (int x = 0; x < width; ++x) {
+			int pixel;
+			if (!(pgm >> pixel)) {
+				return false;
+			}
+
+			// Same conversion as the map_server, the first row of the image is the top of the map.
+			double occupancy = (double)(max_value - pixel) / max_value;
+			int8_t value = -1;
+			if (occupancy > 0.65) {
+				value = 100;
+			} else if (occupancy < 0.196) {
+				value = 0;
+			}
+			grid.data[x + (height - row - 1) * width] = value;
+		}
+	}
+	return true;
+}
+
+/**
+ * The flood fill of ViewConeGenerator::createViewCones before the rasteriser replaced it, unchanged apart from
+ * taking the view cell and the meta data of the grid as arguments and comparing the grid size as signed.
+ */
+void floodFillViewCone(const nav_msgs::MapMetaData& info, const Cell& c, float yaw, float fov, float view_distance, std::vector<Cell>& complete_list)
+{
+	geometry_msgs::Point p = occupancy_grid_utils::cellCenter(info, c);
+
+	// Calculate the triangle points encompasses the area that is viewed.
+	tf::Vector3 view_point(p.x, p.y, p.z);
+
+	tf::Vector3 v0(view_distance, 0.0f, 0.0f);
+	v0 = v0.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), yaw);
+	tf::Vector3 v0_normalised = v0.normalized();
+
+	tf::Vector3 v1 = v0;
+	v1 = v1.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), fov / 2.0f);
+	v1 = v1.normalize();
+	float length = v0.length() / v0_normalised.dot(v1);
+	v1 *= length;
+	v1 += view_point;
+
+	tf::Vector3 v2 = v0;
+	v2 = v2.rotate(tf::Vector3(0.0f, 0.0f, 1.0f), -fov / 2.0f);
+	v2 = v2.normalize();
+	length = v0.length() / v0_normalised.dot(v2);
+	v2 *= length;
+	v2 += view_point;
+
+	std::vector<Cell> open_list;
+	open_list.push_back(c);
+
+	while (open_list.size() > 0) {
+
+		Cell cell = open_list[0];
+		open_list.erase(open_list.begin());
+
+		// Check if the cell is inside the triangle.
+		geometry_msgs::Point cell_centre_point = occupancy_grid_utils::cellCenter(info, cell);
+		tf::Vector3 cell_point(cell_centre_point.x, cell_centre_point.y, cell_centre_point.z);
+
+		tf::Vector3 cross_v1 = (cell_point - v1).cross(v2 - v1);
+		tf::Vector3 cross_v2 = (cell_point - v2).cross(view_point - v2);
+		tf::Vector3 cross_v3 = (cell_point - view_point).cross(v1 - view_point);
+
+		// If both cross produces have the same sign we are good.
+		bool is_in_triangle = false;
+		if ((cross_v1.z() > 0 && cross_v2.z() > 0 && cross_v3.z() > 0) ||
+		    (cross_v1.z() < 0 && cross_v2.z() < 0 && cross_v3.z() < 0) ||
+		    (cell.x == c.x && cell.y == c.y)) {
+			is_in_triangle = true;
+		}
+
+		if (!is_in_triangle) {
+			continue;
+		}
+
+		// Make sure this cell was not already added.
+		bool has_been_processed = false;
+		for (std::vector<Cell>::const_iterator ci = complete_list.begin(); ci != complete_list.end(); ++ci) {
+			const Cell& completed_cell = *ci;
+			if (completed_cell.x == cell.x && completed_cell.y == cell.y) {
+				has_been_processed = true;
+				break;
+			}
+		}
+
+		if (has_been_processed) {
+			continue;
+		}
+
+		complete_list.push_back(cell);
+
+		// Add its children to the list.
+		Cell new_cell;
+		for (int x = cell.x - 1; x < cell.x + 2; ++x) {
+			for (int y = cell.y - 1; y < cell.y + 2; ++y) {
+				if (x > -1 && x + 1 < (int)info.width &&
+				    y > -1 && y + 1 < (int)info.height)
+				{
+					new_cell.x = x;
+					new_cell.y = y;
+					open_list.push_back(new_cell);
+				}
+			}
+		}
+	}
+}
+
+bool isBefore(const Cell& lhs, const Cell& rhs)
+{
+	return lhs.y < rhs.y || (lhs.y == rhs.y && lhs.x < rhs.x);
+}
+
+class ViewConeRasteriserTest : public ::testing::TestWithParam<float>
+{
+protected:
+	virtual void SetUp()
+	{
+		ASSERT_TRUE(loadMap(TEST_DATA_DIR "/maps/small_room.yaml", grid_));
+		for (unsigned int y = 0; y < grid_.info.height; ++y) {
+			for (unsigned int x = 0; x < grid_.info.width; ++x) {
+				if (grid_.data[x + y * grid_.info.width] == 0) {
+					free_cells_.push_back(Cell(x, y));
+				}
+			}
+		}
+		ASSERT_FALSE(free_cells_.empty());
+	}
+
+	nav_msgs::OccupancyGrid grid_;
+	std::vector<Cell> free_cells_;
+};
+
+/**
+ * Place view cones at random free cells with a random yaw, for the field of view (in degrees) of the test.
+ */
+TEST_P(ViewConeRasteriserTest, FindsEveryFloodFilledCell)
+{
+	const float fov = GetParam() * M_PI / 180.0f;
+	const float view_distances[] = { 0.5f, 1.0f, 2.0f };
+	const unsigned int nr_view_cones = 100;
+
+	KCL_rosplan::ViewConeGenerator vg;
+	boost::random::mt19937 generator(0);
+	boost::random::uniform_int_distribution<std::size_t> cell_distribution(0, free_cells_.size() - 1);
+	boost::random::uniform_real_distribution<float> yaw_distribution(0.0f, 2 * M_PI);
+
+	unsigned int nr_differences = 0;
+	unsigned long nr_cells = 0, nr_extra_cells = 0;
+	for (unsigned int i = 0; i < sizeof(view_distances) / sizeof(view_distances[0]); ++i) {
+		for (unsigned int j = 0; j < nr_view_cones; ++j) {
+			const Cell& view_cell = free_cells_[cell_distribution(generator)];
+			float yaw = yaw_distribution(generator);
+
+			std::vector<Cell> rasterised, flood_filled;
+			vg.getViewConeCells(grid_.info, view_cell, yaw, fov, view_distances[i], rasterised);
+			floodFillViewCone(grid_.info, view_cell, yaw, fov, view_distances[i], flood_filled);
+			std::sort(rasterised.begin(), rasterised.end(), isBefore);
+			std::sort(flood_filled.begin(), flood_filled.end(), isBefore);
+
+			std::vector<Cell> missed, extra;
+			std::set_difference(flood_filled.begin(), flood_filled.end(), rasterised.begin(), rasterised.end(), std::back_inserter(missed), isBefore);
+			std::set_difference(rasterised.begin(), rasterised.end(), flood_filled.begin(), flood_filled.end(), std::back_inserter(extra), isBefore);
+			EXPECT_TRUE(missed.empty()) << "The rasteriser misses " << missed.size() << " of the " << flood_filled.size() << " cells of the view cone at ("
+			                            << view_cell.x << ", " << view_cell.y << ") with yaw " << yaw << " and view distance " << view_distances[i] << ".";
+
+			nr_cells += flood_filled.size();
+			nr_extra_cells += extra.size();
+			if (!extra.empty()) {
+				++nr_differences;
+			}
+		}
+	}
+
+	// Cells that only the rasteriser finds are expected, they are reported but do not fail the test.
+	std::stringstream ss;
+	ss << nr_differences << " view cones with " << nr_extra_cells << " cells that only the rasteriser finds (" << nr_cells << " flood filled cells)";
+	RecordProperty("extra_cells", ss.str());
+	std::cout << "fov " << GetParam() << ": " << ss.str() << "." << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(FieldsOfView, ViewConeRasteriserTest, ::testing::Values(30.0f, 45.0f, 70.0f, 90.0f, 120.0f));
+
+}
+
+int main(int argc, char** argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}